@@ -0,0 +1,1227 @@
+// anm2_bench; times reading, writing and sampling anm2 documents and prints the results as JSON
+
+#include "anm2_generate.h"
+#include "anm2_writer.h"
+#include "save.h"
+#include "snapshots.h"
+
+#define ANM2_BENCH_ITERATIONS_DEFAULT 10
+#define ANM2_BENCH_SAMPLES 64 // anm2_frame_from_time calls per item, spread over the animation
+#define ANM2_BENCH_TRACK_FRAMES_DEFAULT 16384
+#define ANM2_BENCH_TRACK_SAMPLES 1024
+#define ANM2_BENCH_ID_LAYERS_DEFAULT 1024
+#define ANM2_BENCH_ID_ANIMATIONS 8
+#define ANM2_BENCH_ID_CHANGES 64 // layers added then removed again per iteration
+#define ANM2_BENCH_JOURNAL_EDITS 10000 // in the journal replayed
+#define ANM2_BENCH_FILE "anm2_bench.anm2"
+#define ANM2_BENCH_USAGE "usage: anm2_bench [--animations N] [--layers N] [--nulls N] [--frames N] [--triggers N] [--events N] [--track-frames N] [--id-layers N] [--seed N] [--iterations N] [--file <anm2>] [--generate <anm2>] [--output <json>] [--verify]"
+#define ANM2_BENCH_ARGUMENT_ERROR "anm2_bench: unknown or incomplete argument: {}"
+#define ANM2_BENCH_READ_ERROR "anm2_bench: unable to read {}"
+#define ANM2_BENCH_WRITE_ERROR "anm2_bench: unable to write {}"
+#define ANM2_BENCH_EIGHT_DIGITS_STEPS 4096 // floats tried past a value for one that takes exactly 8 digits
+#define ANM2_BENCH_MISMATCH_CONTEXT 48 // bytes shown from where two outputs part
+#define ANM2_BENCH_VERIFY_ERROR "anm2_bench: the {} read of {} differs from the stream read: {}"
+#define ANM2_BENCH_ROUND_TRIP_ERROR "anm2_bench: {} read back differs from the document written: {}"
+#define ANM2_BENCH_DOCUMENT_WRITE_ERROR "anm2_bench: the writer and tinyxml2 part at byte {}: \"{}\" against \"{}\""
+#define ANM2_BENCH_NULL_SWAP_ACTION "Null Swap"
+#define ANM2_BENCH_NULL_SWAP_COMMIT_ERROR "anm2_bench: a null swap was dropped instead of committed as an undo step"
+#define ANM2_BENCH_NULL_SWAP_UNDO_ERROR "anm2_bench: undoing a null swap left the document differing from before it: {}"
+#define ANM2_BENCH_NULL_SWAP_JOURNAL_ERROR "anm2_bench: the journal replayed after {} differs from the document: {}"
+#define ANM2_BENCH_VERIFY_INFO "anm2_bench: every read of {} agrees"
+#define ANM2_BENCH_POSE_CACHE_ERROR "anm2_bench: editing one layer left {} of {} cached track frames baked; expected {}"
+
+struct Anm2BenchResult
+{
+    std::string name{};
+    s32 iterations{};
+    f64 minMs = std::numeric_limits<f64>::max();
+    f64 maxMs{};
+    f64 totalMs{};
+    s64 operations{}; // per iteration
+    s64 bytes{}; // per iteration
+};
+
+template <typename Function>
+static Anm2BenchResult _anm2_bench_run(const std::string& name, s32 iterations, s64 operations, s64 bytes, Function&& function)
+{
+	Anm2BenchResult result{name, iterations};
+	result.operations = operations;
+	result.bytes = bytes;
+
+	for (s32 i = 0; i < iterations; i++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		function();
+		f64 ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		result.minMs = std::min(result.minMs, ms);
+		result.maxMs = std::max(result.maxMs, ms);
+		result.totalMs += ms;
+	}
+
+	return result;
+}
+
+static s64 _anm2_bench_frame_count(Anm2* anm2)
+{
+	s64 count = 0;
+
+	for (auto& [_, animation] : anm2->animations)
+	{
+		count += animation.rootAnimation.frames.size() + animation.triggers.frames.size();
+
+		for (auto& [_, item] : animation.layerAnimations)
+			count += item.frames.size();
+		for (auto& [_, item] : animation.nullAnimations)
+			count += item.frames.size();
+	}
+
+	return count;
+}
+
+// Root, every layer in layer map order and every null, as the preview draws them
+static s64 _anm2_bench_frames_sample(Anm2* anm2)
+{
+	s64 count = 0;
+	Anm2Frame frame;
+
+	for (auto& [animationID, animation] : anm2->animations)
+	{
+		auto item_sample = [&](Anm2Type type, s32 itemID)
+		{
+			for (s32 i = 0; i < ANM2_BENCH_SAMPLES; i++)
+			{
+				f32 time = (f32)i * animation.frameNum / ANM2_BENCH_SAMPLES;
+				anm2_frame_from_time(anm2, &frame, Anm2Reference{animationID, type, itemID}, time);
+				count++;
+			}
+		};
+
+		item_sample(ANM2_ROOT, ID_NONE);
+
+		for (auto& [_, layerID] : anm2->layerMap)
+			item_sample(ANM2_LAYER, layerID);
+
+		for (auto& [nullID, _] : animation.nullAnimations)
+			item_sample(ANM2_NULL, nullID);
+	}
+
+	return count;
+}
+
+// The same samples, every track of an animation at once; also builds the models the preview would from them
+static s64 _anm2_bench_poses_sample(Anm2* anm2)
+{
+	s64 count = 0;
+	Anm2Pose pose;
+
+	for (auto& [animationID, animation] : anm2->animations)
+	{
+		for (s32 i = 0; i < ANM2_BENCH_SAMPLES; i++)
+		{
+			f32 time = (f32)i * animation.frameNum / ANM2_BENCH_SAMPLES;
+			anm2_pose_get(anm2, &pose, animationID, time, true);
+			count += pose.count;
+		}
+	}
+
+	return count;
+}
+
+// The same samples again, through a pose cache per animation, as looping playback draws them; once a first pass
+// has baked the frames they fall between, the rest only lerp between baked ones
+static s64 _anm2_bench_pose_caches_sample(Anm2* anm2, std::vector<Anm2PoseCache>* caches)
+{
+	s64 count = 0;
+	Anm2Pose pose;
+
+	caches->resize(anm2->animations.size());
+
+	for (s32 index = 0; index < (s32)anm2->animations.size(); index++)
+	{
+		auto& [animationID, animation] = anm2->animations.values[index];
+
+		for (s32 i = 0; i < ANM2_BENCH_SAMPLES; i++)
+		{
+			f32 time = (f32)i * animation.frameNum / ANM2_BENCH_SAMPLES;
+			anm2_pose_cache_get(anm2, &(*caches)[index], &pose, animationID, time, true);
+			count += pose.count;
+		}
+	}
+
+	return count;
+}
+
+// Edits a frame in place and dirties just its item, as the frame properties do
+static void _anm2_bench_frame_edit(Anm2* anm2, Anm2Reference* reference)
+{
+	Anm2Frame* frame = anm2_frame_from_reference(anm2, reference);
+
+	if (!frame) return;
+
+	frame->position.x += 1.0f;
+	anm2_animation_item_dirty_set(anm2_animation_from_reference(anm2, reference), anm2_item_from_reference(anm2, reference));
+}
+
+// Baked track frames in all, or of one track
+static s64 _anm2_bench_pose_cache_baked_count(const Anm2PoseCache* cache, s32 track = INDEX_NONE)
+{
+	s64 count = 0;
+	s32 trackCount = (s32)cache->types.size();
+
+	for (s32 i = 0; i < (s32)cache->isBakeds.size(); i++)
+		if (cache->isBakeds[i] && (track == INDEX_NONE || i % trackCount == track)) count++;
+
+	return count;
+}
+
+// The array-of-structures walk anm2_frame_from_time did before tracks; copies every frame it passes
+static void _anm2_bench_frame_from_time_aos(Anm2Item* item, Anm2Frame* frame, f32 time)
+{
+	Anm2Frame* frameNext = nullptr;
+	s32 delayCurrent = 0;
+	s32 delayNext = 0;
+
+	for (auto [i, iFrame] : std::views::enumerate(item->frames))
+	{
+		*frame = iFrame;
+
+		delayNext += frame->delay;
+
+		if (time >= delayCurrent && time < delayNext)
+		{
+			frameNext = i + 1 < (s32)item->frames.size() ? &item->frames[i + 1] : nullptr;
+			break;
+		}
+
+		delayCurrent += frame->delay;
+	}
+
+	if (frame->isInterpolated && frameNext && frame->delay > 1)
+	{
+		f32 interpolation = (time - delayCurrent) / (delayNext - delayCurrent);
+
+		frame->rotation = glm::mix(frame->rotation, frameNext->rotation, interpolation);
+		frame->position = glm::mix(frame->position, frameNext->position, interpolation);
+		frame->scale = glm::mix(frame->scale, frameNext->scale, interpolation);
+		frame->offsetRGB = glm::mix(frame->offsetRGB, frameNext->offsetRGB, interpolation);
+		frame->tintRGBA = glm::mix(frame->tintRGBA, frameNext->tintRGBA, interpolation);
+	}
+}
+
+// One animation with a single long layer track
+static void _anm2_bench_track_run(std::vector<Anm2BenchResult>* results, const Anm2GenerateSettings& settings, s32 trackFrames, s32 iterations)
+{
+	Anm2 anm2;
+	Anm2GenerateSettings trackSettings = {1, 1, 0, trackFrames, 0, 0, 1, settings.seed};
+
+	anm2_generate(&anm2, trackSettings);
+
+	Anm2Animation* animation = &anm2.animations[0];
+	Anm2Item* item = &animation->layerAnimations[0];
+	Anm2Reference reference = {0, ANM2_LAYER, 0, 0};
+	Anm2Frame frame;
+	volatile f32 rotationSum = 0.0f; // keeps the samples from being optimized away
+
+	auto time_get = [&](s32 i) { return (f32)i * animation->frameNum / ANM2_BENCH_TRACK_SAMPLES; };
+
+	results->push_back(_anm2_bench_run("track_frame_from_time_aos", iterations, ANM2_BENCH_TRACK_SAMPLES, 0, [&]
+	{
+		for (s32 i = 0; i < ANM2_BENCH_TRACK_SAMPLES; i++)
+		{
+			_anm2_bench_frame_from_time_aos(item, &frame, time_get(i));
+			rotationSum = rotationSum + frame.rotation;
+		}
+	}));
+
+	anm2_item_track_get(item);
+
+	results->push_back(_anm2_bench_run("track_frame_from_time", iterations, ANM2_BENCH_TRACK_SAMPLES, 0, [&]
+	{
+		for (s32 i = 0; i < ANM2_BENCH_TRACK_SAMPLES; i++)
+		{
+			anm2_frame_from_time(&anm2, &frame, reference, time_get(i));
+			rotationSum = rotationSum + frame.rotation;
+		}
+	}));
+
+	results->push_back(_anm2_bench_run("track_build", iterations, trackFrames, 0, [&]
+	{
+		anm2_item_dirty_set(item);
+		anm2_item_track_get(item);
+	}));
+
+	Anm2FrameChange change;
+	change.rotation = 1.0f;
+
+	results->push_back(_anm2_bench_run("track_item_frame_set", iterations, trackFrames, 0, [&]
+	{
+		anm2_item_frame_set(&anm2, &reference, change, ANM2_CHANGE_ADD, 0, trackFrames);
+	}));
+}
+
+// One animation with --track-frames triggers; the scan is how triggers were found before the sorted trigger track
+static void _anm2_bench_trigger_run(std::vector<Anm2BenchResult>* results, const Anm2GenerateSettings& settings, s32 triggerCount, s32 iterations)
+{
+	Anm2 anm2;
+	Anm2GenerateSettings triggerSettings = {1, 0, 0, 1, triggerCount, 4, 0, settings.seed};
+
+	anm2_generate(&anm2, triggerSettings);
+
+	Anm2Animation* animation = &anm2.animations[0];
+	Anm2Item* item = &animation->triggers;
+	Anm2Reference reference = {0, ANM2_TRIGGERS};
+	Anm2Frame frame;
+	volatile s32 eventSum = 0; // keeps the lookups from being optimized away
+
+	auto time_get = [&](s32 i) { return (f32)i * animation->frameNum / ANM2_BENCH_TRACK_SAMPLES; };
+
+	results->push_back(_anm2_bench_run("trigger_frame_from_time_scan", iterations, ANM2_BENCH_TRACK_SAMPLES, 0, [&]
+	{
+		for (s32 i = 0; i < ANM2_BENCH_TRACK_SAMPLES; i++)
+		{
+			for (auto& trigger : item->frames)
+			{
+				if (trigger.atFrame == (s32)time_get(i))
+				{
+					eventSum = eventSum + trigger.eventID;
+					break;
+				}
+			}
+		}
+	}));
+
+	results->push_back(_anm2_bench_run("trigger_frame_from_time", iterations, ANM2_BENCH_TRACK_SAMPLES, 0, [&]
+	{
+		for (s32 i = 0; i < ANM2_BENCH_TRACK_SAMPLES; i++)
+		{
+			anm2_frame_from_time(&anm2, &frame, reference, time_get(i));
+			eventSum = eventSum + frame.eventID;
+		}
+	}));
+
+	// Consecutive windows covering the animation, as playback ticks would query them
+	results->push_back(_anm2_bench_run("trigger_range_get", iterations, ANM2_BENCH_TRACK_SAMPLES, 0, [&]
+	{
+		for (s32 i = 0; i < ANM2_BENCH_TRACK_SAMPLES; i++)
+		{
+			Anm2TriggerRange range = anm2_trigger_range_get(item, time_get(i), time_get(i + 1));
+
+			for (s32 j = range.begin; j < range.end; j++)
+				eventSum = eventSum + range.track->eventIDs[j];
+		}
+	}));
+}
+
+// Layer lookups as the preview does them, per layer per animation; the std::map copies are the baseline
+static void _anm2_bench_id_map_run(std::vector<Anm2BenchResult>* results, const Anm2GenerateSettings& settings, s32 idLayers, s32 iterations)
+{
+	Anm2 anm2;
+	Anm2GenerateSettings idSettings = {ANM2_BENCH_ID_ANIMATIONS, idLayers, 4, 1, 0, 0, 2, settings.seed};
+
+	anm2_generate(&anm2, idSettings);
+
+	s64 lookups = (s64)anm2.animations.size() * anm2.layerMap.size();
+	volatile s32 lookupSum = 0; // keeps the lookups from being optimized away
+
+	results->push_back(_anm2_bench_run("id_map_lookup", iterations, lookups, 0, [&]
+	{
+		for (auto& [_, animation] : anm2.animations)
+			for (auto& [_, id] : anm2.layerMap)
+				lookupSum = lookupSum + map_find(anm2.layers, id)->spritesheetID + map_find(animation.layerAnimations, id)->isVisible;
+	}));
+
+	std::map<s32, Anm2Layer> layers(anm2.layers.begin(), anm2.layers.end());
+	std::vector<std::map<s32, Anm2Item>> layerAnimations;
+
+	for (auto& [_, animation] : anm2.animations)
+		layerAnimations.emplace_back(animation.layerAnimations.begin(), animation.layerAnimations.end());
+
+	results->push_back(_anm2_bench_run("id_map_lookup_std_map", iterations, lookups, 0, [&]
+	{
+		for (auto& items : layerAnimations)
+			for (auto& [_, id] : anm2.layerMap)
+				lookupSum = lookupSum + map_find(layers, id)->spritesheetID + map_find(items, id)->isVisible;
+	}));
+
+	results->push_back(_anm2_bench_run("id_map_layer_add_remove", iterations, ANM2_BENCH_ID_CHANGES * 2, 0, [&]
+	{
+		for (s32 i = 0; i < ANM2_BENCH_ID_CHANGES; i++)
+			anm2_layer_add(&anm2);
+
+		for (s32 i = 0; i < ANM2_BENCH_ID_CHANGES; i++)
+			anm2_layer_remove(&anm2, idLayers + ANM2_BENCH_ID_CHANGES - 1 - i);
+	}));
+}
+
+static bool _anm2_bench_item_is_equal(const Anm2Item& item, const Anm2Item& other)
+{
+	return item.isVisible == other.isVisible && item.frames.read() == other.frames.read();
+}
+
+template <typename Map>
+static bool _anm2_bench_items_is_equal(const Map& items, const Map& others)
+{
+	if (items.size() != others.size()) return false;
+
+	for (auto& [id, item] : items)
+	{
+		auto it = others.find(id);
+		if (it == others.end() || !_anm2_bench_item_is_equal(item, it->second)) return false;
+	}
+
+	return true;
+}
+
+// What first differs between two documents' contents, or nothing; lazy and packed animations are decoded first
+static std::string _anm2_bench_difference_get(Anm2 anm2, Anm2 other)
+{
+	anm2_animations_materialize(&anm2);
+	anm2_animations_materialize(&other);
+
+	if (anm2.fps != other.fps) return "fps";
+	if (anm2.defaultAnimationID != other.defaultAnimationID) return "default animation";
+	if (anm2.spritesheets != other.spritesheets) return "spritesheets";
+	if (anm2.layers != other.layers) return "layers";
+	if (anm2.nulls != other.nulls) return "nulls";
+	if (anm2.events != other.events) return "events";
+	if (anm2.layerMap != other.layerMap) return "layer order";
+	if (anm2.animations.size() != other.animations.size()) return "animation count";
+
+	for (auto& [id, animation] : anm2.animations)
+	{
+		auto it = other.animations.find(id);
+		if (it == other.animations.end()) return std::format("animation {}", id);
+
+		const Anm2Animation& otherAnimation = it->second;
+
+		if (animation.name != otherAnimation.name || animation.frameNum != otherAnimation.frameNum || animation.isLoop != otherAnimation.isLoop)
+			return std::format("animation {}", id);
+		// The root and triggers have no Visible attribute to keep theirs in, so only their frames are compared
+		if (animation.rootAnimation.frames.read() != otherAnimation.rootAnimation.frames.read()) return std::format("animation {} root", id);
+		if (!_anm2_bench_items_is_equal(animation.layerAnimations, otherAnimation.layerAnimations)) return std::format("animation {} layers", id);
+		if (!_anm2_bench_items_is_equal(animation.nullAnimations, otherAnimation.nullAnimations)) return std::format("animation {} nulls", id);
+		if (animation.triggers.frames.read() != otherAnimation.triggers.frames.read()) return std::format("animation {} triggers", id);
+	}
+
+	return {};
+}
+
+static void _anm2_bench_document_frame_write(tinyxml2::XMLDocument* document, tinyxml2::XMLElement* parent, const Anm2Frame& frame, Anm2Type type)
+{
+	tinyxml2::XMLElement* element = document->NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_FRAME]);
+
+	element->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_X_POSITION], frame.position.x);
+	element->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_Y_POSITION], frame.position.y);
+	element->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_X_PIVOT], frame.pivot.x);
+	element->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_Y_PIVOT], frame.pivot.y);
+
+	if (type == ANM2_LAYER)
+	{
+		element->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_X_CROP], frame.crop.x);
+		element->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_Y_CROP], frame.crop.y);
+		element->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_WIDTH], frame.size.x);
+		element->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_HEIGHT], frame.size.y);
+	}
+
+	element->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_X_SCALE], frame.scale.x);
+	element->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_Y_SCALE], frame.scale.y);
+	element->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_DELAY], frame.delay);
+	element->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_VISIBLE], frame.isVisible);
+	element->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_RED_TINT], FLOAT_TO_U8(frame.tintRGBA.r));
+	element->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_GREEN_TINT], FLOAT_TO_U8(frame.tintRGBA.g));
+	element->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_BLUE_TINT], FLOAT_TO_U8(frame.tintRGBA.b));
+	element->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_ALPHA_TINT], FLOAT_TO_U8(frame.tintRGBA.a));
+	element->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_RED_OFFSET], FLOAT_TO_U8(frame.offsetRGB.r));
+	element->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_GREEN_OFFSET], FLOAT_TO_U8(frame.offsetRGB.g));
+	element->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_BLUE_OFFSET], FLOAT_TO_U8(frame.offsetRGB.b));
+	element->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_ROTATION], frame.rotation);
+	element->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_INTERPOLATED], frame.isInterpolated);
+
+	parent->InsertEndChild(element);
+}
+
+static void _anm2_bench_document_item_write(tinyxml2::XMLDocument* document, tinyxml2::XMLElement* parent, Anm2Element elementType,
+	Anm2Attribute idAttribute, s32 id, const Anm2Item& item, Anm2Type type)
+{
+	tinyxml2::XMLElement* element = document->NewElement(ANM2_ELEMENT_STRINGS[elementType]);
+
+	element->SetAttribute(ANM2_ATTRIBUTE_STRINGS[idAttribute], id);
+	element->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_VISIBLE], item.isVisible);
+
+	for (auto& frame : item.frames)
+		_anm2_bench_document_frame_write(document, element, frame, type);
+
+	parent->InsertEndChild(element);
+}
+
+// The document as tinyxml2 printed it before the direct writer, element for element: what the writer's output is
+// held to byte for byte
+static std::string _anm2_bench_document_write(Anm2 anm2)
+{
+	tinyxml2::XMLDocument document;
+	tinyxml2::XMLPrinter printer;
+
+	anm2_animations_materialize(&anm2);
+
+	// AnimatedActor
+	tinyxml2::XMLElement* animatedActorElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_ANIMATED_ACTOR]);
+	document.InsertFirstChild(animatedActorElement);
+
+	// Info
+	tinyxml2::XMLElement* infoElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_INFO]);
+	infoElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_CREATED_BY], anm2.createdBy.c_str());
+	infoElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_CREATED_ON], anm2.createdOn.c_str());
+	infoElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_VERSION], anm2.version);
+	infoElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_FPS], anm2.fps);
+	animatedActorElement->InsertEndChild(infoElement);
+
+	// Content
+	tinyxml2::XMLElement* contentElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_CONTENT]);
+	tinyxml2::XMLElement* spritesheetsElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_SPRITESHEETS]);
+
+	for (auto& [id, spritesheet] : anm2.spritesheets)
+	{
+		tinyxml2::XMLElement* element = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_SPRITESHEET]);
+		element->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_PATH], spritesheet.path.c_str());
+		element->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_ID], id);
+		spritesheetsElement->InsertEndChild(element);
+	}
+
+	contentElement->InsertEndChild(spritesheetsElement);
+
+	tinyxml2::XMLElement* layersElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_LAYERS]);
+
+	for (auto& [id, layer] : anm2.layers)
+	{
+		if (id == ID_NONE) continue;
+
+		tinyxml2::XMLElement* element = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_LAYER]);
+		element->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_NAME], layer.name.c_str());
+		element->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_ID], id);
+		element->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_SPRITESHEET_ID], layer.spritesheetID);
+		layersElement->InsertEndChild(element);
+	}
+
+	contentElement->InsertEndChild(layersElement);
+
+	tinyxml2::XMLElement* nullsElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_NULLS]);
+
+	for (auto& [id, null] : anm2.nulls)
+	{
+		tinyxml2::XMLElement* element = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_NULL]);
+		element->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_NAME], null.name.c_str());
+		element->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_ID], id);
+		if (null.isShowRect) element->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_SHOW_RECT], null.isShowRect);
+		nullsElement->InsertEndChild(element);
+	}
+
+	contentElement->InsertEndChild(nullsElement);
+
+	tinyxml2::XMLElement* eventsElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_EVENTS]);
+
+	for (auto& [id, event] : anm2.events)
+	{
+		tinyxml2::XMLElement* element = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_EVENT]);
+		element->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_NAME], event.name.c_str());
+		element->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_ID], id);
+		eventsElement->InsertEndChild(element);
+	}
+
+	contentElement->InsertEndChild(eventsElement);
+	animatedActorElement->InsertEndChild(contentElement);
+
+	// Animations
+	tinyxml2::XMLElement* animationsElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_ANIMATIONS]);
+	animationsElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_DEFAULT_ANIMATION], anm2.animations[anm2.defaultAnimationID].name.c_str());
+
+	for (auto& [id, animation] : anm2.animations)
+	{
+		tinyxml2::XMLElement* animationElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_ANIMATION]);
+		animationElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_NAME], animation.name.c_str());
+		animationElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_FRAME_NUM], animation.frameNum);
+		animationElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_LOOP], animation.isLoop);
+
+		tinyxml2::XMLElement* rootAnimationElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_ROOT_ANIMATION]);
+
+		for (auto& frame : animation.rootAnimation.frames)
+			_anm2_bench_document_frame_write(&document, rootAnimationElement, frame, ANM2_ROOT);
+
+		animationElement->InsertEndChild(rootAnimationElement);
+
+		tinyxml2::XMLElement* layerAnimationsElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_LAYER_ANIMATIONS]);
+
+		for (auto& [layerIndex, layerID] : anm2.layerMap)
+			_anm2_bench_document_item_write(&document, layerAnimationsElement, ANM2_ELEMENT_LAYER_ANIMATION, ANM2_ATTRIBUTE_LAYER_ID, layerID,
+				animation.layerAnimations[layerID], ANM2_LAYER);
+
+		animationElement->InsertEndChild(layerAnimationsElement);
+
+		tinyxml2::XMLElement* nullAnimationsElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_NULL_ANIMATIONS]);
+
+		for (auto& [nullID, nullAnimation] : animation.nullAnimations)
+			_anm2_bench_document_item_write(&document, nullAnimationsElement, ANM2_ELEMENT_NULL_ANIMATION, ANM2_ATTRIBUTE_NULL_ID, nullID,
+				nullAnimation, ANM2_NULL);
+
+		animationElement->InsertEndChild(nullAnimationsElement);
+
+		tinyxml2::XMLElement* triggersElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_TRIGGERS]);
+
+		for (auto& frame : animation.triggers.frames)
+		{
+			tinyxml2::XMLElement* element = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_TRIGGER]);
+			element->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_EVENT_ID], frame.eventID);
+			element->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_AT_FRAME], frame.atFrame);
+			triggersElement->InsertEndChild(element);
+		}
+
+		animationElement->InsertEndChild(triggersElement);
+		animationsElement->InsertEndChild(animationElement);
+	}
+
+	animatedActorElement->InsertEndChild(animationsElement);
+
+	document.Print(&printer);
+
+	return std::string(printer.CStr(), std::max(0, printer.CStrSize() - 1));
+}
+
+// The float nearest value, from it upward, whose shortest form takes exactly ANM2_WRITER_FLOAT_PRECISION digits;
+// tinyxml2's %.8g prints those the same as the writer. Whole numbers already print the same and are kept
+static f32 _anm2_bench_float_eight_digits(f32 value)
+{
+	if (value == std::trunc(value)) return value;
+
+	for (s32 i = 0; i < ANM2_BENCH_EIGHT_DIGITS_STEPS; i++)
+	{
+		char string[32];
+		auto [end, error] = std::to_chars(string, string + sizeof(string), value, std::chars_format::scientific);
+		std::string_view mantissa(string, end - string);
+
+		mantissa = mantissa.substr(0, mantissa.find('e'));
+
+		if (std::ranges::count_if(mantissa, [](char character) { return character >= '0' && character <= '9'; }) == ANM2_WRITER_FLOAT_PRECISION)
+			return value;
+
+		value = std::nextafter(value, std::numeric_limits<f32>::infinity());
+	}
+
+	return std::trunc(value);
+}
+
+static void _anm2_bench_eight_digits_set(Anm2* anm2)
+{
+	auto item_eight_digits_set = [](Anm2Item* item)
+	{
+		for (auto& frame : item->frames)
+			for (f32* value : {&frame.position.x, &frame.position.y, &frame.pivot.x, &frame.pivot.y, &frame.crop.x, &frame.crop.y,
+				&frame.size.x, &frame.size.y, &frame.scale.x, &frame.scale.y, &frame.rotation})
+				*value = _anm2_bench_float_eight_digits(*value);
+	};
+
+	anm2_animations_materialize(anm2);
+
+	for (auto& [_, animation] : anm2->animations)
+	{
+		item_eight_digits_set(&animation.rootAnimation);
+
+		for (auto& [_, item] : animation.layerAnimations)
+			item_eight_digits_set(&item);
+
+		for (auto& [_, item] : animation.nullAnimations)
+			item_eight_digits_set(&item);
+
+		anm2_animation_dirty_set(&animation);
+	}
+}
+
+// The writer's output against tinyxml2's, for a copy of the document whose floats all take 8 digits or are whole;
+// other values are printed shorter, or with a ninth digit where %.8g loses one, so they're left out
+static bool _anm2_bench_document_write_verify(const Anm2& anm2)
+{
+	Anm2 eightDigits = anm2;
+	std::string written;
+
+	_anm2_bench_eight_digits_set(&eightDigits);
+	anm2_writer_write(&eightDigits, &written);
+
+	std::string document = _anm2_bench_document_write(eightDigits);
+	auto [writtenIt, documentIt] = std::ranges::mismatch(written, document);
+
+	if (writtenIt == written.end() && documentIt == document.end()) return true;
+
+	size_t offset = writtenIt - written.begin();
+
+	std::println(stderr, ANM2_BENCH_DOCUMENT_WRITE_ERROR, offset, written.substr(offset, ANM2_BENCH_MISMATCH_CONTEXT),
+		document.substr(offset, ANM2_BENCH_MISMATCH_CONTEXT));
+	return false;
+}
+
+// What a crash now would recover, against the document; empty if they agree
+static std::string _anm2_bench_journal_difference_get(const Anm2& anm2, const Journal& journal)
+{
+	Anm2 replayed;
+
+	if (!journal_replay(&replayed, journal.path)) return std::format(ANM2_BENCH_READ_ERROR, journal.path);
+
+	return _anm2_bench_difference_get(anm2, replayed);
+}
+
+// Two nulls swapped as the timeline does, given the same name and rect flag first so the header shows no change;
+// only the items moving tells the history and the journal anything happened. The swap must be kept as a step,
+// undoing it must give back the document from before, and the journal must replay to the document after each
+static bool _anm2_bench_null_swap_verify(const Anm2& anm2)
+{
+	if (anm2.nulls.size() < 2 || anm2.animations.empty()) return true;
+
+	Anm2 edited = anm2;
+	Anm2Reference reference = {edited.animations.begin()->first, ANM2_NULL, edited.nulls.values[0].first, 0};
+	Anm2Reference rootReference = {reference.animationID, ANM2_ROOT, ID_NONE, 0};
+	s32 otherID = edited.nulls.values[1].first;
+	Snapshots snapshots;
+	f32 time{};
+	bool isValid = true;
+
+	edited.nulls[otherID] = edited.nulls[reference.itemID];
+
+	snapshots_init(&snapshots, &edited, &reference, &time);
+	snapshots_reset(&snapshots);
+	snapshots.isJournal = true;
+
+	// An edit first, so the journal's checkpoint is behind it and the swap is appended as an edit
+	snapshots_undo_push(&snapshots);
+	_anm2_bench_frame_edit(&edited, &rootReference);
+	snapshots_undo_commit(&snapshots);
+
+	Anm2 before = edited;
+	size_t stepCount = snapshots.undoStack.snapshots.size();
+
+	snapshots_undo_push(&snapshots, ANM2_BENCH_NULL_SWAP_ACTION);
+	anm2_null_swap(&edited, reference.animationID, reference.itemID, otherID);
+	snapshots_undo_commit(&snapshots);
+
+	if (snapshots.undoStack.snapshots.size() == stepCount)
+	{
+		std::println(stderr, ANM2_BENCH_NULL_SWAP_COMMIT_ERROR);
+		isValid = false;
+	}
+
+	if (std::string difference = _anm2_bench_journal_difference_get(edited, snapshots.journal); !difference.empty())
+	{
+		std::println(stderr, ANM2_BENCH_NULL_SWAP_JOURNAL_ERROR, "a null swap", difference);
+		isValid = false;
+	}
+
+	snapshots_undo(&snapshots);
+
+	if (std::string difference = _anm2_bench_difference_get(before, edited); !difference.empty())
+	{
+		std::println(stderr, ANM2_BENCH_NULL_SWAP_UNDO_ERROR, difference);
+		isValid = false;
+	}
+
+	if (std::string difference = _anm2_bench_journal_difference_get(edited, snapshots.journal); !difference.empty())
+	{
+		std::println(stderr, ANM2_BENCH_NULL_SWAP_JOURNAL_ERROR, "undoing a null swap", difference);
+		isValid = false;
+	}
+
+	snapshots_free(&snapshots);
+
+	return isValid;
+}
+
+// Reads path every way there is and checks each against the stream read, and the stream read against the document
+// written to path; the cache is read twice, once to write the sidecar and once from it. Undoing a null swap is
+// checked on a copy
+static bool _anm2_bench_verify(const Anm2& anm2, const std::string& path)
+{
+	static const std::pair<Anm2ReadType, const char*> readTypes[] =
+	{
+		{ANM2_READ_DOCUMENT, "document"},
+		{ANM2_READ_LAZY, "lazy"},
+		{ANM2_READ_CACHE, "cache"},
+		{ANM2_READ_CACHE, "cache hit"}
+	};
+
+	Anm2 streamed;
+	bool isValid = true;
+
+	if (!anm2_deserialize(&streamed, nullptr, path, ANM2_READ_STREAM))
+	{
+		std::println(stderr, ANM2_BENCH_READ_ERROR, path);
+		return false;
+	}
+
+	std::string roundTripDifference = _anm2_bench_difference_get(anm2, streamed);
+
+	if (!roundTripDifference.empty())
+	{
+		std::println(stderr, ANM2_BENCH_ROUND_TRIP_ERROR, path, roundTripDifference);
+		isValid = false;
+	}
+
+	if (!_anm2_bench_document_write_verify(anm2)) isValid = false;
+	if (!_anm2_bench_null_swap_verify(anm2)) isValid = false;
+
+	for (auto& [type, name] : readTypes)
+	{
+		Anm2 read;
+
+		if (!anm2_deserialize(&read, nullptr, path, type))
+		{
+			std::println(stderr, ANM2_BENCH_READ_ERROR, path);
+			isValid = false;
+			continue;
+		}
+
+		std::string difference = _anm2_bench_difference_get(streamed, read);
+
+		if (!difference.empty())
+		{
+			std::println(stderr, ANM2_BENCH_VERIFY_ERROR, name, path, difference);
+			isValid = false;
+		}
+	}
+
+	return isValid;
+}
+
+static std::string _anm2_bench_json_string(const std::string& string)
+{
+	std::string json = "\"";
+
+	for (char character : string)
+	{
+		switch (character)
+		{
+			case '"': json += "\\\""; break;
+			case '\\': json += "\\\\"; break;
+			case '\n': json += "\\n"; break;
+			default: json += character; break;
+		}
+	}
+
+	return json + "\"";
+}
+
+static std::string _anm2_bench_json(const Anm2GenerateSettings& settings, const std::string& file, s64 bytes, s64 frames, s32 animations, const std::vector<Anm2BenchResult>& results)
+{
+	std::string json = "{\n";
+
+	json += std::format("  \"settings\": {{\"animations\": {}, \"layers\": {}, \"nulls\": {}, \"frames\": {}, \"triggers\": {}, \"events\": {}, \"seed\": {}}},\n",
+		settings.animationCount, settings.layerCount, settings.nullCount, settings.frameCount, settings.triggerCount, settings.eventCount, settings.seed);
+	json += std::format("  \"document\": {{\"file\": {}, \"bytes\": {}, \"frames\": {}, \"animations\": {}}},\n", _anm2_bench_json_string(file), bytes, frames, animations);
+	json += "  \"results\": [\n";
+
+	for (auto [i, result] : std::views::enumerate(results))
+	{
+		f64 meanMs = result.totalMs / result.iterations;
+		f64 seconds = meanMs / SECOND;
+
+		json += std::format("    {{\"name\": {}, \"iterations\": {}, \"mean_ms\": {:.4f}, \"min_ms\": {:.4f}, \"max_ms\": {:.4f}, \"operations\": {}, \"operations_per_s\": {:.1f}, \"mb_per_s\": {:.2f}}}{}\n",
+			_anm2_bench_json_string(result.name), result.iterations, meanMs, result.minMs, result.maxMs, result.operations,
+			result.operations / seconds, result.bytes / (1024.0 * 1024.0) / seconds, i + 1 < (s64)results.size() ? "," : "");
+	}
+
+	json += "  ]\n}\n";
+
+	return json;
+}
+
+s32 main(s32 argc, char* argv[])
+{
+	Anm2GenerateSettings settings;
+	Anm2 anm2;
+	s32 iterations = ANM2_BENCH_ITERATIONS_DEFAULT;
+	s32 trackFrames = ANM2_BENCH_TRACK_FRAMES_DEFAULT;
+	s32 idLayers = ANM2_BENCH_ID_LAYERS_DEFAULT;
+	std::string file{};
+	std::string generatePath{};
+	std::string outputPath{};
+	bool isVerify = false;
+	std::vector<Anm2BenchResult> results;
+
+	for (s32 i = 1; i < argc; i++)
+	{
+		std::string argument = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+		if (argument == "--verify")
+		{
+			isVerify = true;
+			continue;
+		}
+
+		if (!value)
+		{
+			std::println(stderr, ANM2_BENCH_ARGUMENT_ERROR, argument);
+			std::println(stderr, ANM2_BENCH_USAGE);
+			return EXIT_FAILURE;
+		}
+
+		if (argument == "--animations") settings.animationCount = std::max(1, atoi(value));
+		else if (argument == "--layers") settings.layerCount = std::max(0, atoi(value));
+		else if (argument == "--nulls") settings.nullCount = std::max(0, atoi(value));
+		else if (argument == "--frames") settings.frameCount = std::max(1, atoi(value));
+		else if (argument == "--triggers") settings.triggerCount = std::max(0, atoi(value));
+		else if (argument == "--events") settings.eventCount = std::max(0, atoi(value));
+		else if (argument == "--track-frames") trackFrames = std::max(1, atoi(value));
+		else if (argument == "--id-layers") idLayers = std::max(1, atoi(value));
+		else if (argument == "--seed") settings.seed = std::strtoull(value, nullptr, 0);
+		else if (argument == "--iterations") iterations = std::max(1, atoi(value));
+		else if (argument == "--file") file = value;
+		else if (argument == "--generate") generatePath = value;
+		else if (argument == "--output") outputPath = value;
+		else
+		{
+			std::println(stderr, ANM2_BENCH_ARGUMENT_ERROR, argument);
+			std::println(stderr, ANM2_BENCH_USAGE);
+			return EXIT_FAILURE;
+		}
+
+		i++;
+	}
+
+	// Read/write info lines would otherwise interleave with the JSON
+	log_console_set(false);
+
+	if (!file.empty())
+	{
+		if (!anm2_deserialize(&anm2, nullptr, file))
+		{
+			std::println(stderr, ANM2_BENCH_READ_ERROR, file);
+			return EXIT_FAILURE;
+		}
+	}
+	else
+		anm2_generate(&anm2, settings);
+
+	if (!generatePath.empty())
+	{
+		if (!anm2_serialize(&anm2, generatePath))
+		{
+			std::println(stderr, ANM2_BENCH_WRITE_ERROR, generatePath);
+			return EXIT_FAILURE;
+		}
+
+		return EXIT_SUCCESS;
+	}
+
+	// Writes go to a scratch file, so a benchmarked --file is never overwritten
+	std::string writePath = (std::filesystem::temp_directory_path() / ANM2_BENCH_FILE).string();
+	std::string buffer;
+
+	anm2_writer_write(&anm2, &buffer);
+
+	// Checks the writer and the readers against each other on the document as written, instead of timing anything
+	if (isVerify)
+	{
+		if (!anm2_writer_file_write(writePath, buffer))
+		{
+			std::println(stderr, ANM2_BENCH_WRITE_ERROR, writePath);
+			return EXIT_FAILURE;
+		}
+
+		bool isValid = _anm2_bench_verify(anm2, writePath);
+
+		std::error_code errorCode;
+		std::filesystem::remove(writePath, errorCode);
+
+		if (!isValid) return EXIT_FAILURE;
+
+		std::println(ANM2_BENCH_VERIFY_INFO, writePath);
+		return EXIT_SUCCESS;
+	}
+
+	s64 bytes = buffer.size();
+	s64 frames = _anm2_bench_frame_count(&anm2);
+	s32 animations = (s32)anm2.animations.size();
+
+	// Every animation is dirtied first, so these format the whole document rather than splice cached fragments
+	results.push_back(_anm2_bench_run("write_buffer", iterations, frames, bytes, [&]
+	{
+		anm2_animations_dirty_set(&anm2);
+		anm2_writer_write(&anm2, &buffer);
+	}));
+
+	results.push_back(_anm2_bench_run("serialize", iterations, frames, bytes, [&]
+	{
+		anm2_animations_dirty_set(&anm2);
+		anm2_serialize(&anm2, writePath);
+	}));
+
+	// One frame changed; only its animation is formatted again
+	Anm2Reference dirtyReference = {anm2.animations.begin()->first, ANM2_ROOT, ID_NONE, 0};
+	Anm2FrameChange dirtyChange;
+	dirtyChange.rotation = 1.0f;
+
+	results.push_back(_anm2_bench_run("serialize_incremental", iterations, 1, bytes, [&]
+	{
+		anm2_item_frame_set(&anm2, &dirtyReference, dirtyChange, ANM2_CHANGE_ADD, 0, 1);
+		anm2_serialize(&anm2, writePath);
+	}));
+
+	Saves saves;
+	saves_init(&saves);
+
+	// What a background save costs the thread making it: preparing the document and copying it. Those made while
+	// one's still waiting to be written join it
+	results.push_back(_anm2_bench_run("save_submit", iterations, 1, 0, [&]
+	{
+		anm2_item_frame_set(&anm2, &dirtyReference, dirtyChange, ANM2_CHANGE_ADD, 0, 1);
+		saves_submit(&saves, &anm2, &dirtyReference, ID_NONE, writePath);
+	}));
+
+	saves_free(&saves);
+
+	std::string readPath = file.empty() ? writePath : file;
+	s64 readBytes = (s64)std::filesystem::file_size(readPath);
+
+	static const std::pair<Anm2ReadType, const char*> readTypes[] =
+	{
+		{ANM2_READ_STREAM, "deserialize_stream"},
+		{ANM2_READ_DOCUMENT, "deserialize_document"},
+		{ANM2_READ_LAZY, "deserialize_lazy"},
+		{ANM2_READ_CACHE, "deserialize_cache"}
+	};
+
+	for (auto& [type, name] : readTypes)
+	{
+		Anm2 read;
+
+		// Primes the sidecar, so the timed reads measure hits
+		if (type == ANM2_READ_CACHE) anm2_deserialize(&read, nullptr, readPath, type);
+
+		results.push_back(_anm2_bench_run(name, iterations, frames, readBytes, [&]
+		{
+			if (!anm2_deserialize(&read, nullptr, readPath, type))
+				std::println(stderr, ANM2_BENCH_READ_ERROR, readPath);
+		}));
+	}
+
+	s64 samples = 0;
+
+	results.push_back(_anm2_bench_run("frame_from_time", iterations, 0, 0, [&] { samples = _anm2_bench_frames_sample(&anm2); }));
+	results.back().operations = samples;
+
+	results.push_back(_anm2_bench_run("pose_get", iterations, 0, 0, [&] { samples = _anm2_bench_poses_sample(&anm2); }));
+	results.back().operations = samples;
+
+	std::vector<Anm2PoseCache> poseCaches;
+
+	_anm2_bench_pose_caches_sample(&anm2, &poseCaches);
+
+	results.push_back(_anm2_bench_run("pose_cache_get", iterations, 0, 0, [&] { samples = _anm2_bench_pose_caches_sample(&anm2, &poseCaches); }));
+	results.back().operations = samples;
+
+	Anm2Reference poseReference = {anm2.animations.begin()->first, ANM2_LAYER, anm2.layerMap.empty() ? ID_NONE : anm2.layerMap.begin()->second, 0};
+
+	// One layer's frame edited, then every sample again; only that layer's track is rebaked
+	if (anm2_frame_from_reference(&anm2, &poseReference))
+	{
+		Anm2PoseCache* poseCache = &poseCaches[0];
+		Anm2Pose pose;
+
+		results.push_back(_anm2_bench_run("pose_cache_edit", iterations, 0, 0, [&]
+		{
+			_anm2_bench_frame_edit(&anm2, &poseReference);
+			samples = _anm2_bench_pose_caches_sample(&anm2, &poseCaches);
+		}));
+		results.back().operations = samples;
+
+		// Once more, checked: every other track keeps what it had baked, and the edited one is baked again only for
+		// the one frame sampled after
+		s32 track = INDEX_NONE;
+
+		for (s32 i = 0; i < (s32)poseCache->types.size(); i++)
+			if (poseCache->types[i] == ANM2_LAYER && poseCache->ids[i] == poseReference.itemID) track = i;
+
+		s64 bakedCount = _anm2_bench_pose_cache_baked_count(poseCache);
+		s64 expectedCount = bakedCount - _anm2_bench_pose_cache_baked_count(poseCache, track) + 1;
+
+		_anm2_bench_frame_edit(&anm2, &poseReference);
+		anm2_pose_cache_get(&anm2, poseCache, &pose, poseReference.animationID, 0.0f, true);
+
+		s64 keptCount = _anm2_bench_pose_cache_baked_count(poseCache);
+
+		if (!poseCache->isBakeds.empty() && keptCount != expectedCount)
+		{
+			std::println(stderr, ANM2_BENCH_POSE_CACHE_ERROR, keptCount, bakedCount, expectedCount);
+			return EXIT_FAILURE;
+		}
+	}
+
+	volatile s64 lengthSum = 0; // keeps the calls from being optimized away
+
+	// Dirtied first, so every frame is counted again; then the cached lengths
+	results.push_back(_anm2_bench_run("animation_length_count", iterations, animations, 0, [&]
+	{
+		for (auto& [_, animation] : anm2.animations)
+		{
+			anm2_animation_dirty_set(&animation);
+			lengthSum = lengthSum + anm2_animation_length_get(&animation);
+		}
+	}));
+
+	results.push_back(_anm2_bench_run("animation_length_get", iterations, animations, 0, [&]
+	{
+		for (auto& [_, animation] : anm2.animations)
+			lengthSum = lengthSum + anm2_animation_length_get(&animation);
+	}));
+
+	Anm2 compacted = anm2;
+	s64 packedBytes = 0;
+
+	anm2_animations_compact(&compacted);
+
+	for (auto& [_, animation] : compacted.animations)
+		packedBytes += animation.packed->size();
+
+	// Bytes are the frames' unpacked size going in and their packed size coming out, so the two give the ratio
+	results.push_back(_anm2_bench_run("animations_compact", iterations, frames, frames * (s64)sizeof(Anm2Frame), [&]
+	{
+		compacted = anm2;
+		anm2_animations_compact(&compacted);
+	}));
+
+	results.push_back(_anm2_bench_run("animations_unpack", iterations, frames, packedBytes, [&]
+	{
+		Anm2 unpacked = compacted;
+		anm2_animations_materialize(&unpacked);
+	}));
+
+	Anm2 edited = anm2;
+	Anm2Reference editedReference = dirtyReference;
+	Snapshots snapshots;
+	f32 time{};
+
+	snapshots_init(&snapshots, &edited, &editedReference, &time);
+	snapshots_reset(&snapshots);
+	snapshots.isJournal = false; // timed on its own below
+
+	s32 pushCount = 0;
+
+	// One frame changed per push; only its animation is copied into the history. Each push is its own
+	// action, so none of them join the one before
+	results.push_back(_anm2_bench_run("undo_push", iterations, 1, 0, [&]
+	{
+		anm2_item_frame_set(&edited, &dirtyReference, dirtyChange, ANM2_CHANGE_ADD, 0, 1);
+		snapshots_undo_push(&snapshots, std::to_string(pushCount++));
+	}));
+
+	// The same action again straight away, as a drag does every frame: it joins the open step
+	results.push_back(_anm2_bench_run("undo_push_coalesced", iterations, 1, 0, [&]
+	{
+		snapshots_undo_push(&snapshots, SNAPSHOT_ACTION);
+		anm2_item_frame_set(&edited, &dirtyReference, dirtyChange, ANM2_CHANGE_ADD, 0, 1);
+	}));
+
+	// A step that changes nothing, e.g. a click that doesn't edit; the commit finds so and drops it
+	results.push_back(_anm2_bench_run("undo_push_noop", iterations, 1, 0, [&]
+	{
+		snapshots_undo_push(&snapshots, std::to_string(pushCount++));
+		snapshots_undo_commit(&snapshots);
+	}));
+
+	results.push_back(_anm2_bench_run("undo_discard", iterations, 1, 0, [&]
+	{
+		snapshots_undo_push(&snapshots, std::to_string(pushCount++));
+		anm2_item_frame_set(&edited, &dirtyReference, dirtyChange, ANM2_CHANGE_ADD, 0, 1);
+		snapshots_undo_discard(&snapshots);
+	}));
+
+	results.push_back(_anm2_bench_run("undo_redo", iterations, 2, 0, [&]
+	{
+		snapshots_undo(&snapshots);
+		snapshots_redo(&snapshots);
+	}));
+
+	SnapshotsMemory memory = snapshots_memory_get(&snapshots);
+
+	// Bytes are what the document and its history hold, shared buffers counted once
+	results.push_back(_anm2_bench_run("undo_memory_get", iterations, (s64)snapshots.undoStack.snapshots.size(), memory.sharedBytes + memory.uniqueBytes, [&]
+	{
+		memory = snapshots_memory_get(&snapshots);
+	}));
+
+	Anm2 spilled = anm2;
+	Anm2Reference spilledReference = dirtyReference;
+	Snapshots spilledSnapshots;
+
+	snapshots_init(&spilledSnapshots, &spilled, &spilledReference, &time);
+	snapshots_reset(&spilledSnapshots);
+	spilledSnapshots.isJournal = false;
+	spilledSnapshots.memoryBudget = 0;
+	spilledSnapshots.compressedBudget = 0;
+
+	// No budget, so each push compresses and spills the entry under it: the dearest a push gets
+	results.push_back(_anm2_bench_run("undo_push_spilled", iterations, 1, 0, [&]
+	{
+		anm2_item_frame_set(&spilled, &dirtyReference, dirtyChange, ANM2_CHANGE_ADD, 0, 1);
+		snapshots_undo_push(&spilledSnapshots, std::to_string(pushCount++));
+	}));
+
+	s64 spilledCount = (s64)spilledSnapshots.undoStack.snapshots.size();
+
+	// Undoing the whole history reads every entry back from the file; redoing it spills them again.
+	// Bytes are the spill file's size with the whole history in it
+	results.push_back(_anm2_bench_run("undo_redo_spilled", iterations, spilledCount * 2, spilledSnapshots.undoStack.spillSize, [&]
+	{
+		while (!spilledSnapshots.undoStack.is_empty())
+			snapshots_undo(&spilledSnapshots);
+		while (!spilledSnapshots.redoStack.is_empty())
+			snapshots_redo(&spilledSnapshots);
+	}));
+
+	snapshots_free(&spilledSnapshots);
+	snapshots_free(&snapshots);
+
+	Journal journal;
+	std::vector<std::pair<s32, std::optional<Anm2Animation>>> journalPrevious(1);
+
+	journal_reset(&journal, anm2);
+	journal.checkpointEdits = ANM2_BENCH_JOURNAL_EDITS;
+
+	// One frame changed per edit, as a commit hands it over; only the item it's in is written
+	auto journal_edit = [&]
+	{
+		journalPrevious[0] = {dirtyReference.animationID, journal.state.animations[dirtyReference.animationID]};
+		anm2_item_frame_set(&journal.state, &dirtyReference, dirtyChange, ANM2_CHANGE_ADD, 0, 1);
+		journal_edit_append(&journal, false, journalPrevious);
+	};
+
+	journal_edit(); // the checkpoint
+
+	results.push_back(_anm2_bench_run("journal_append", iterations, 1, 0, journal_edit));
+
+	while (journal.editCount < ANM2_BENCH_JOURNAL_EDITS)
+		journal_edit();
+
+	// Bytes are the journal's size: the checkpoint, then every edit after it
+	results.push_back(_anm2_bench_run("journal_replay", iterations, journal.editCount, journal.size, [&]
+	{
+		Anm2 replayed;
+
+		if (!journal_replay(&replayed, journal.path))
+			std::println(stderr, ANM2_BENCH_READ_ERROR, journal.path);
+	}));
+
+	journal_free(&journal);
+
+	_anm2_bench_track_run(&results, settings, trackFrames, iterations);
+	_anm2_bench_trigger_run(&results, settings, trackFrames, iterations);
+	_anm2_bench_id_map_run(&results, settings, idLayers, iterations);
+
+	std::string json = _anm2_bench_json(settings, file, bytes, frames, animations, results);
+
+	if (outputPath.empty())
+		std::print("{}", json);
+	else if (!anm2_writer_file_write(outputPath, json))
+		return EXIT_FAILURE;
+
+	std::error_code errorCode;
+	std::filesystem::remove(writePath, errorCode);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,111 @@
+#include "anm2_generate.h"
+
+// splitmix64; standard library distributions aren't specified bit-for-bit, so they'd differ across platforms
+static u64 _anm2_generate_next(u64* state)
+{
+	u64 value = (*state += 0x9E3779B97F4A7C15ULL);
+	value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+	return value ^ (value >> 31);
+}
+
+static s32 _anm2_generate_int(u64* state, s32 min, s32 max)
+{
+	return min + (s32)(_anm2_generate_next(state) % (u64)(max - min + 1));
+}
+
+// Two decimal places, like hand-authored files
+static f32 _anm2_generate_float(u64* state, f32 min, f32 max)
+{
+	f32 unit = (f32)(_anm2_generate_next(state) >> 40) / (f32)(1 << 24);
+	return roundf((min + unit * (max - min)) * 100.0f) / 100.0f;
+}
+
+static Anm2Frame _anm2_generate_frame(u64* state, Anm2Type type)
+{
+	Anm2Frame frame;
+
+	frame.delay = _anm2_generate_int(state, ANM2_FRAME_DELAY_MIN, ANM2_GENERATE_DELAY_MAX);
+	frame.isInterpolated = _anm2_generate_int(state, 0, 1);
+	frame.isVisible = _anm2_generate_int(state, 0, 7) != 0;
+	frame.position = {_anm2_generate_float(state, -ANM2_GENERATE_POSITION_MAX, ANM2_GENERATE_POSITION_MAX), _anm2_generate_float(state, -ANM2_GENERATE_POSITION_MAX, ANM2_GENERATE_POSITION_MAX)};
+	frame.scale = {(f32)_anm2_generate_int(state, 50, 150), (f32)_anm2_generate_int(state, 50, 150)};
+	frame.rotation = _anm2_generate_float(state, -180.0f, 180.0f);
+	frame.tintRGBA = {U8_TO_FLOAT(_anm2_generate_int(state, 0, 255)), 1.0f, 1.0f, U8_TO_FLOAT(_anm2_generate_int(state, 128, 255))};
+	frame.offsetRGB = {U8_TO_FLOAT(_anm2_generate_int(state, 0, 32)), 0.0f, 0.0f};
+
+	if (type == ANM2_LAYER)
+	{
+		frame.crop = {(f32)_anm2_generate_int(state, 0, ANM2_GENERATE_CROP_MAX), (f32)_anm2_generate_int(state, 0, ANM2_GENERATE_CROP_MAX)};
+		frame.size = {(f32)_anm2_generate_int(state, 1, ANM2_GENERATE_SIZE_MAX), (f32)_anm2_generate_int(state, 1, ANM2_GENERATE_SIZE_MAX)};
+		frame.pivot = frame.size * 0.5f;
+	}
+
+	return frame;
+}
+
+static void _anm2_generate_item(u64* state, Anm2Item* item, Anm2Type type, s32 frameCount)
+{
+	item->isVisible = _anm2_generate_int(state, 0, 15) != 0;
+
+	for (s32 i = 0; i < frameCount; i++)
+		item->frames.push_back(_anm2_generate_frame(state, type));
+}
+
+void anm2_generate(Anm2* self, const Anm2GenerateSettings& settings)
+{
+	u64 state = settings.seed;
+
+	anm2_new(self);
+
+	self->createdBy = ANM2_GENERATE_CREATED_BY;
+	self->createdOn = ANM2_GENERATE_CREATED_ON;
+	self->fps = ANM2_FPS_DEFAULT;
+	self->version = 1;
+
+	for (s32 i = 0; i < settings.spritesheetCount; i++)
+		self->spritesheets[i].path = std::format(ANM2_GENERATE_SPRITESHEET_FORMAT, i);
+
+	for (s32 i = 0; i < settings.layerCount; i++)
+	{
+		self->layers[i] = {std::format(ANM2_GENERATE_LAYER_FORMAT, i), settings.spritesheetCount > 0 ? i % settings.spritesheetCount : ID_NONE};
+		self->layerMap[i] = i;
+	}
+
+	for (s32 i = 0; i < settings.nullCount; i++)
+		self->nulls[i] = {std::format(ANM2_GENERATE_NULL_FORMAT, i), i % 2 == 0};
+
+	for (s32 i = 0; i < settings.eventCount; i++)
+		self->events[i].name = std::format(ANM2_GENERATE_EVENT_FORMAT, i);
+
+	for (s32 i = 0; i < settings.animationCount; i++)
+	{
+		Anm2Animation& animation = self->animations[i];
+
+		animation.name = std::format(ANM2_GENERATE_ANIMATION_FORMAT, i);
+		animation.isLoop = i % 2 == 0;
+
+		_anm2_generate_item(&state, &animation.rootAnimation, ANM2_ROOT, settings.frameCount);
+
+		for (s32 id = 0; id < settings.layerCount; id++)
+			_anm2_generate_item(&state, &animation.layerAnimations[id], ANM2_LAYER, settings.frameCount);
+
+		for (s32 id = 0; id < settings.nullCount; id++)
+			_anm2_generate_item(&state, &animation.nullAnimations[id], ANM2_NULL, settings.frameCount);
+
+		s32 atFrame = 0;
+
+		for (s32 j = 0; j < settings.triggerCount && settings.eventCount > 0; j++)
+		{
+			Anm2Frame trigger;
+			trigger.eventID = _anm2_generate_int(&state, 0, settings.eventCount - 1);
+			trigger.atFrame = atFrame;
+			atFrame += _anm2_generate_int(&state, 1, ANM2_GENERATE_DELAY_MAX);
+			animation.triggers.frames.push_back(trigger);
+		}
+
+		anm2_animation_length_set(&animation);
+	}
+
+	self->defaultAnimationID = 0;
+}
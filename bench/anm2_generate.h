@@ -0,0 +1,32 @@
+// Deterministic synthetic anm2 documents; the same settings and seed always give the same file
+
+#pragma once
+
+#include "anm2.h"
+
+#define ANM2_GENERATE_SEED_DEFAULT 0x616E6D32ULL
+#define ANM2_GENERATE_CREATED_BY "anm2_bench"
+#define ANM2_GENERATE_CREATED_ON "01-January-2000 12:00:00 AM"
+#define ANM2_GENERATE_SPRITESHEET_FORMAT "gfx/sheet{}.png"
+#define ANM2_GENERATE_LAYER_FORMAT "layer{}"
+#define ANM2_GENERATE_NULL_FORMAT "null{}"
+#define ANM2_GENERATE_EVENT_FORMAT "event{}"
+#define ANM2_GENERATE_ANIMATION_FORMAT "animation{}"
+#define ANM2_GENERATE_POSITION_MAX 256.0f
+#define ANM2_GENERATE_CROP_MAX 512
+#define ANM2_GENERATE_SIZE_MAX 128
+#define ANM2_GENERATE_DELAY_MAX 8
+
+struct Anm2GenerateSettings
+{
+    s32 animationCount = 64;
+    s32 layerCount = 16;
+    s32 nullCount = 4;
+    s32 frameCount = 32; // per layer, null and root item
+    s32 triggerCount = 8; // per animation
+    s32 eventCount = 4;
+    s32 spritesheetCount = 2;
+    u64 seed = ANM2_GENERATE_SEED_DEFAULT;
+};
+
+void anm2_generate(Anm2* self, const Anm2GenerateSettings& settings);
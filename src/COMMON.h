@@ -1,27 +1,44 @@
 #pragma once
 
+// Headless tools (anm2_bench) build the anm2 modules without SDL or GL
+#ifndef ANM2ED_HEADLESS
 #include <SDL3/SDL.h>
 #include <GL/glew.h>
 #include <GL/gl.h>
+#else
+typedef unsigned int GLuint;
+#endif
 #include <glm/glm/glm.hpp>
 #include <glm/glm/gtc/type_ptr.hpp>
 #include <glm/glm/gtc/matrix_transform.hpp>
 #include <tinyxml2.h>
 
 #include <algorithm>                   
+#include <atomic>
+#include <bit>
+#include <charconv>
 #include <chrono>                      
 #include <cmath>                          
+#include <condition_variable>
 #include <cstring>
+#include <deque>
 #include <filesystem>                  
 #include <format>           
 #include <fstream>
 #include <functional>            
 #include <iostream>
 #include <map>                          
+#include <memory>
+#include <mutex>
+#include <numeric>
 #include <optional>
 #include <print>                          
 #include <ranges>                      
+#include <span>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
 #include <unordered_set>                      
 #include <variant>                  
 #include <vector>                  
@@ -53,6 +70,8 @@ using namespace glm;
 #define SECOND 1000.0f
 #define TICK_DELAY (SECOND / 30.0)
 #define UPDATE_DELAY (SECOND / 120.0)
+#define FNV1A_OFFSET 0xcbf29ce484222325ULL
+#define FNV1A_PRIME 0x100000001b3ULL
 #define ID_NONE -1
 #define INDEX_NONE -1
 #define TIME_NONE -1.0f
@@ -104,10 +123,17 @@ static const vec3 COLOR_OFFSET_NONE = {0.0f, 0.0f, 0.0f};
 
 static inline std::string preferences_path_get(void)
 {
+#ifndef ANM2ED_HEADLESS
     char* preferencesPath = SDL_GetPrefPath("", PREFERENCES_DIRECTORY);
     std::string preferencesPathString = preferencesPath;
     SDL_free(preferencesPath);
     return preferencesPathString;
+#else
+    std::error_code errorCode;
+    std::filesystem::path preferencesPath = std::filesystem::temp_directory_path(errorCode) / PREFERENCES_DIRECTORY;
+    std::filesystem::create_directories(preferencesPath, errorCode);
+    return (preferencesPath / "").string();
+#endif
 }
 
 static inline bool string_to_bool(const std::string& string) 
@@ -120,6 +146,16 @@ static inline bool string_to_bool(const std::string& string)
     return lower == "true";
 }
 
+static constexpr u64 hash_fnv1a(std::string_view string, u64 hash = FNV1A_OFFSET)
+{
+    for (char character : string)
+    {
+        hash ^= (u8)character;
+        hash *= FNV1A_PRIME;
+    }
+    return hash;
+}
+
 static inline std::string string_quote(const std::string& string) 
 {
     return "\"" + string + "\"";
@@ -224,12 +260,20 @@ static inline std::string path_canonical_resolve
     return (canonicalError ? resolvedPath : canonicalPath).generic_string();
 };
 
-static inline std::string working_directory_from_file_set(const std::string& path)
+// Directory a file's relative paths resolve against; used in place of switching the process working directory,
+// so documents can load and export on any thread
+static inline std::string path_directory_get(const std::string& path)
+{
+    std::error_code errorCode;
+    std::filesystem::path directory = std::filesystem::absolute(path, errorCode);
+    return errorCode ? std::filesystem::path(path).parent_path().string() : directory.parent_path().string();
+};
+
+static inline std::string path_resolve(const std::string& path, const std::string& directory)
 {
     std::filesystem::path filePath = path;
-    std::filesystem::path parentPath = filePath.parent_path();
-	std::filesystem::current_path(parentPath);
-    return parentPath.string();
+    if (filePath.is_relative() && !directory.empty()) return (std::filesystem::path(directory) / filePath).string();
+    return path;
 };
 
 static inline std::string path_extension_change(const std::string& path, const std::string& extension)
@@ -294,6 +338,165 @@ T& dummy_value()
     return value;
 }
 
+#define ID_MAP_SLOTS_SLACK 256
+
+// Dense id-keyed map; values sit contiguously in ascending id order (so iteration matches std::map's) and ids
+// index a slot table for O(1) lookups. Ids too large or negative to be worth a slot are binary searched instead.
+// Inserting or erasing moves the values after it, so pointers and iterators into it don't survive changes
+template <typename T>
+struct IdMap
+{
+    using key_type = s32;
+    using mapped_type = T;
+    using value_type = std::pair<s32, T>; // ids are not to be changed through iterators; see map_ids_compact
+    using iterator = typename std::vector<value_type>::iterator;
+    using const_iterator = typename std::vector<value_type>::const_iterator;
+    using reverse_iterator = typename std::vector<value_type>::reverse_iterator;
+    using const_reverse_iterator = typename std::vector<value_type>::const_reverse_iterator;
+
+    std::vector<value_type> values; // ascending id order
+    std::vector<s32> slots; // id -> index into values, INDEX_NONE if absent; always exact for the ids it covers
+
+    iterator begin() { return values.begin(); }
+    iterator end() { return values.end(); }
+    const_iterator begin() const { return values.begin(); }
+    const_iterator end() const { return values.end(); }
+    reverse_iterator rbegin() { return values.rbegin(); }
+    reverse_iterator rend() { return values.rend(); }
+    const_reverse_iterator rbegin() const { return values.rbegin(); }
+    const_reverse_iterator rend() const { return values.rend(); }
+    size_t size() const { return values.size(); }
+    bool empty() const { return values.empty(); }
+    void reserve(size_t count) { values.reserve(count); }
+    void clear() { values.clear(); slots.clear(); }
+    bool operator==(const IdMap& other) const { return values == other.values; }
+
+    s32 index_get(s32 id) const
+    {
+        if (id >= 0 && id < (s32)slots.size()) return slots[id];
+
+        auto it = std::lower_bound(values.begin(), values.end(), id, [](const value_type& entry, s32 key) { return entry.first < key; });
+        return it != values.end() && it->first == id ? (s32)(it - values.begin()) : INDEX_NONE;
+    }
+
+    // Points every covered id from index on at its value
+    void slots_update(size_t index)
+    {
+        for (size_t i = index; i < values.size(); i++)
+            if (values[i].first >= 0 && values[i].first < (s32)slots.size())
+                slots[values[i].first] = (s32)i;
+    }
+
+    iterator find(s32 id) { s32 index = index_get(id); return index == INDEX_NONE ? end() : begin() + index; }
+    const_iterator find(s32 id) const { s32 index = index_get(id); return index == INDEX_NONE ? end() : begin() + index; }
+    bool contains(s32 id) const { return index_get(id) != INDEX_NONE; }
+    size_t count(s32 id) const { return contains(id) ? 1 : 0; }
+
+    // Places a value whose id isn't present yet; ids past the last one (the usual case) just append
+    iterator emplace_new(s32 id, T&& value)
+    {
+        auto it = values.empty() || id > values.back().first ? values.end() :
+            std::lower_bound(values.begin(), values.end(), id, [](const value_type& entry, s32 key) { return entry.first < key; });
+        size_t index = it - values.begin();
+
+        values.emplace(it, id, std::move(value));
+
+        // The slot table grows geometrically, but only while it stays proportional to the value count
+        if (id >= (s32)slots.size() && id < (s32)(values.size() * 2 + ID_MAP_SLOTS_SLACK))
+        {
+            slots.resize(std::max((size_t)id + 1, slots.size() * 2), INDEX_NONE);
+            slots_update(0);
+        }
+        else
+            slots_update(index);
+
+        return begin() + index;
+    }
+
+    T& operator[](s32 id)
+    {
+        s32 index = index_get(id);
+        return index == INDEX_NONE ? emplace_new(id, T{})->second : values[index].second;
+    }
+
+    std::pair<iterator, bool> insert(value_type value)
+    {
+        if (auto it = find(value.first); it != end()) return {it, false};
+        return {emplace_new(value.first, std::move(value.second)), true};
+    }
+
+    iterator erase(const_iterator it)
+    {
+        size_t index = it - values.cbegin();
+        s32 id = it->first;
+
+        values.erase(it);
+
+        if (id >= 0 && id < (s32)slots.size()) slots[id] = INDEX_NONE;
+        slots_update(index);
+
+        return begin() + index;
+    }
+
+    size_t erase(s32 id)
+    {
+        auto it = find(id);
+        if (it == end()) return 0;
+        erase(it);
+        return 1;
+    }
+};
+
+// Copy-on-write vector; copies share one buffer until one of them is written. Const access only reads; any
+// non-const access first takes a private copy if the buffer is shared, so pointers and iterators from it are only
+// good until the vector is next copied (e.g. by an undo push)
+template <typename T>
+struct CowVector
+{
+    using value_type = T;
+    using iterator = typename std::vector<T>::iterator;
+    using const_iterator = typename std::vector<T>::const_iterator;
+
+    std::shared_ptr<std::vector<T>> buffer{}; // null while empty
+
+    const std::vector<T>& read() const { return buffer ? *buffer : dummy_value<const std::vector<T>>(); }
+
+    std::vector<T>& write()
+    {
+        if (!buffer)
+            buffer = std::make_shared<std::vector<T>>();
+        else if (buffer.use_count() > 1)
+            buffer = std::make_shared<std::vector<T>>(*buffer);
+
+        return *buffer;
+    }
+
+    bool is_shared() const { return buffer.use_count() > 1; }
+    const void* id_get() const { return buffer.get(); }
+
+    const_iterator begin() const { return read().begin(); }
+    const_iterator end() const { return read().end(); }
+    iterator begin() { return write().begin(); }
+    iterator end() { return write().end(); }
+    size_t size() const { return buffer ? buffer->size() : 0; }
+    bool empty() const { return size() == 0; }
+    const T& operator[](size_t index) const { return read()[index]; }
+    T& operator[](size_t index) { return write()[index]; }
+    const T& back() const { return read().back(); }
+    T& back() { return write().back(); }
+    const T* data() const { return read().data(); }
+    T* data() { return write().data(); }
+    void clear() { buffer.reset(); }
+    void reserve(size_t count) { write().reserve(count); }
+    void resize(size_t count) { write().resize(count); }
+    void push_back(const T& value) { write().push_back(value); }
+    template <typename... Args> T& emplace_back(Args&&... args) { return write().emplace_back(std::forward<Args>(args)...); }
+    template <typename It> void assign(It first, It last) { write().assign(first, last); }
+    iterator insert(iterator position, const T& value) { return write().insert(position, value); }
+    template <typename It> iterator insert(iterator position, It first, It last) { return write().insert(position, first, last); }
+    iterator erase(iterator position) { return write().erase(position); }
+};
+
 template<typename T>
 static inline s32 map_next_id_get(const std::map<s32, T>& map) 
 {
@@ -332,36 +535,61 @@ static inline void map_swap(Map& map, const Key& key1, const Key& key2)
     } 
     else if (it1 != map.end()) 
     {
-        map[key2] = std::move(it1->second);
+        // Moved out before the insert; an IdMap insert invalidates its iterators
+        auto value = std::move(it1->second);
         map.erase(it1);
+        map[key2] = std::move(value);
     } 
     else if (it2 != map.end()) 
     {
-        map[key1] = std::move(it2->second);
+        auto value = std::move(it2->second);
         map.erase(it2);
+        map[key1] = std::move(value);
     }
 };
 
+// First unused id counting up from 0; ids sit in order, so the run of ids matching their index is binary searched
+template<typename T>
+static inline s32 map_next_id_get(const IdMap<T>& map) 
+{
+    if (map.empty() || map.values.front().first != 0) return 0;
+
+    auto indices = std::views::iota(0, (s32)map.size());
+    return (s32)(std::ranges::partition_point(indices, [&](s32 i) { return map.values[i].first == i; }) - indices.begin());
+}
+
+template<typename T>
+static inline T* map_find(IdMap<T>& map, s32 id) 
+{
+    s32 index = map.index_get(id);
+    return index == INDEX_NONE ? nullptr : &map.values[index].second;
+}
+
 template <typename T>
-static inline void map_insert_shift(std::map<int, T>& map, s32 index, const T& value)
+static inline void map_insert_shift(IdMap<T>& map, s32 index, const T& value)
 {
     const s32 insertIndex = index + 1;
 
-    std::vector<std::pair<int, T>> toShift;
-    for (auto it = map.rbegin(); it != map.rend(); ++it)
-    {
-        if (it->first < insertIndex)
-            break;
-        toShift.emplace_back(it->first + 1, std::move(it->second));
-    }
+    auto it = std::lower_bound(map.values.begin(), map.values.end(), insertIndex, [](const auto& entry, s32 key) { return entry.first < key; });
+    
+    for (auto shift = it; shift != map.values.end(); ++shift)
+        shift->first++;
 
-    for (const auto& [newKey, _] : toShift)
-        map.erase(newKey - 1);
+    // The slot table is rebuilt whole, as the shifted ids all moved
+    map.values.emplace(it, insertIndex, value);
+    map.slots.assign(map.slots.size(), INDEX_NONE);
+    map.slots_update(0);
+}
 
-    for (auto& [newKey, val] : toShift)
-        map[newKey] = std::move(val);
+// Renumbers ids to 0..n-1, keeping their order
+template <typename T>
+static inline void map_ids_compact(IdMap<T>& map)
+{
+    for (size_t i = 0; i < map.values.size(); i++)
+        map.values[i].first = (s32)i;
 
-    map[insertIndex] = value;
+    map.slots.assign(std::max(map.slots.size(), map.values.size()), INDEX_NONE);
+    map.slots_update(0);
 }
 
 static inline mat4 quad_model_get(vec2 size, vec2 position, vec2 pivot, f32 rotation, vec2 scale)
@@ -1,4 +1,6 @@
-#include "anm2.h"
+#include "anm2_cache.h"
+#include "anm2_reader.h"
+#include "anm2_writer.h"
 
 using namespace tinyxml2;
 
@@ -6,306 +8,61 @@ static void _anm2_created_on_set(Anm2* self)
 {
 	auto now = std::chrono::system_clock::now();
     std::time_t time = std::chrono::system_clock::to_time_t(now);
-    std::tm localTime = *std::localtime(&time);
+    std::tm localTime{};
+
+	// std::localtime returns a buffer shared by every thread; the reentrant forms fill this one
+#if defined(_WIN32)
+	localtime_s(&localTime, &time);
+#else
+	localtime_r(&time, &localTime);
+#endif
 
 	std::ostringstream timeString;
 	timeString << std::put_time(&localTime, ANM2_CREATED_ON_FORMAT);
 	self->createdOn = timeString.str();
 }
 
-bool anm2_serialize(Anm2* self, const std::string& path)
+// The document's own part of a save: its path, version and creation date
+void anm2_serialize_prepare(Anm2* self, const std::string& path)
 {
-	XMLDocument document;
-	XMLError error;
-
-	XMLElement* animatedActorElement;
-	XMLElement* infoElement;
-	XMLElement* contentElement;
-	XMLElement* spritesheetsElement;
-	XMLElement* layersElement;
-	XMLElement* nullsElement;
-	XMLElement* eventsElement;
-	XMLElement* animationsElement;
-
-	if (!self || path.empty()) return false;
-
 	if (self->version == 0) _anm2_created_on_set(self);
 
 	self->path = path;
 	self->version++;
+}
 
-	// AnimatedActor
-	animatedActorElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_ANIMATED_ACTOR]);
-	document.InsertFirstChild(animatedActorElement);
-
-	// Info 
-	infoElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_INFO]);
-	infoElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_CREATED_BY], self->createdBy.c_str()); // CreatedBy 
-	infoElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_CREATED_ON], self->createdOn.c_str()); // CreatedOn 
-	infoElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_VERSION], self->version); // Version
-	infoElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_FPS], self->fps); // FPS 
-	animatedActorElement->InsertEndChild(infoElement);
-
-	// Content 
-	contentElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_CONTENT]);
-	
-	// Spritesheets 
-	spritesheetsElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_SPRITESHEETS]);
-
-	for (auto& [id, spritesheet] : self->spritesheets)
-	{
-		XMLElement* spritesheetElement;
-		
-		// Spritesheet 
-		spritesheetElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_SPRITESHEET]);
-		spritesheetElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_PATH], spritesheet.path.c_str()); // Path 
-		spritesheetElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_ID], id); // ID 
-		spritesheetsElement->InsertEndChild(spritesheetElement);
-	}
-	
-	contentElement->InsertEndChild(spritesheetsElement);
-	
-	// Layers 
-	layersElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_LAYERS]);
-
-	for (auto& [id, layer] : self->layers)
-	{
-		if (id == ID_NONE) continue; // add this line
-
-		XMLElement* layerElement;
-
-		// Layer 
-		layerElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_LAYER]);
-		layerElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_NAME], layer.name.c_str()); // Path 
-		layerElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_ID], id); // ID 
-		layerElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_SPRITESHEET_ID], layer.spritesheetID); // SpritesheetId 
-
-		layersElement->InsertEndChild(layerElement);
-	}
-	
-	contentElement->InsertEndChild(layersElement);
-	
-	// Nulls 
-	nullsElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_NULLS]);
-
-	for (auto& [id, null] : self->nulls)
-	{
-		XMLElement* nullElement;
-		
-		// Null 
-		nullElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_NULL]);
-		nullElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_NAME], null.name.c_str()); // Name 
-		nullElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_ID], id); // ID 
-
-		// special case; only serialize if this is true 
-		if (null.isShowRect)
-			nullElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_SHOW_RECT], null.isShowRect); // ShowRect 
-		nullsElement->InsertEndChild(nullElement);
-	}
-	
-	contentElement->InsertEndChild(nullsElement);
-
-	// Events 
-	eventsElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_EVENTS]);
-
-	for (auto& [id, event] : self->events)
-	{
-		XMLElement* eventElement;
-		
-		// Event 
-		eventElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_EVENT]);
-		eventElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_NAME], event.name.c_str()); // Name 
-		eventElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_ID], id); // ID 
-		eventsElement->InsertEndChild(eventElement);
-	}
-	
-	contentElement->InsertEndChild(eventsElement);
-
-	animatedActorElement->InsertEndChild(contentElement);
-		
-	// Animations
-	animationsElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_ANIMATIONS]);
-	animationsElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_DEFAULT_ANIMATION], self->animations[self->defaultAnimationID].name.c_str()); // DefaultAnimation
-
-	for (auto& [id, animation] : self->animations)
-	{
-		XMLElement* animationElement;
-		XMLElement* rootAnimationElement;
-		XMLElement* layerAnimationsElement;
-		XMLElement* nullAnimationsElement;
-		XMLElement* triggersElement;
-		
-		// Animation
-		animationElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_ANIMATION]);
-
-		animationElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_NAME], animation.name.c_str()); // Name
-		animationElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_FRAME_NUM], animation.frameNum); // FrameNum
-		animationElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_LOOP], animation.isLoop); // Loop
-
-		// RootAnimation
-		rootAnimationElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_ROOT_ANIMATION]);
-
-		for (auto& frame : animation.rootAnimation.frames)
-		{
-			XMLElement* frameElement;
-
-			// Frame
-			frameElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_FRAME]);
-			
-			frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_X_POSITION], frame.position.x); // XPosition
-			frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_Y_POSITION], frame.position.y); //  YPosition
-			frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_X_PIVOT], frame.pivot.x); // XPivot
-			frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_Y_PIVOT], frame.pivot.y); // YPivot
-			frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_X_SCALE], frame.scale.x); // XScale
-			frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_Y_SCALE], frame.scale.y); // YScale
-			frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_DELAY], frame.delay); // Delay
-			frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_VISIBLE], frame.isVisible); // Visible
-			frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_RED_TINT], FLOAT_TO_U8(frame.tintRGBA.r)); // RedTint
-			frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_GREEN_TINT], FLOAT_TO_U8(frame.tintRGBA.g)); // GreenTint
-			frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_BLUE_TINT], FLOAT_TO_U8(frame.tintRGBA.b)); // BlueTint
-			frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_ALPHA_TINT], FLOAT_TO_U8(frame.tintRGBA.a)); // AlphaTint
-			frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_RED_OFFSET], FLOAT_TO_U8(frame.offsetRGB.r)); // RedOffset
-			frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_GREEN_OFFSET], FLOAT_TO_U8(frame.offsetRGB.g)); // GreenOffset
-			frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_BLUE_OFFSET], FLOAT_TO_U8(frame.offsetRGB.b)); // BlueOffset
-			frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_ROTATION], frame.rotation); // Rotation
-			frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_INTERPOLATED], frame.isInterpolated); // Interpolated
-		
-			rootAnimationElement->InsertEndChild(frameElement);
-		}
-
-		animationElement->InsertEndChild(rootAnimationElement);
-
-		// LayerAnimations
-		layerAnimationsElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_LAYER_ANIMATIONS]);
-
-		for (auto& [layerIndex, layerID] : self->layerMap)
-		{
-			Anm2Item& layerAnimation = animation.layerAnimations[layerID];
-
-			XMLElement* layerAnimationElement;
-
-			// LayerAnimation
-			layerAnimationElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_LAYER_ANIMATION]);
-			layerAnimationElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_LAYER_ID], layerID); // LayerId
-			layerAnimationElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_VISIBLE], layerAnimation.isVisible); // Visible 
-	
-			for (auto& frame : layerAnimation.frames)
-			{
-				XMLElement* frameElement;
-
-				// Frame
-				frameElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_FRAME]);
-				
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_X_POSITION], frame.position.x); // XPosition
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_Y_POSITION], frame.position.y); // YPosition
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_X_PIVOT], frame.pivot.x); // XPivot
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_Y_PIVOT], frame.pivot.y); // YPivot
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_X_CROP], frame.crop.x); // XCrop
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_Y_CROP], frame.crop.y); // YCrop
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_WIDTH], frame.size.x); // Width
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_HEIGHT], frame.size.y); // Height
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_X_SCALE], frame.scale.x); // XScale
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_Y_SCALE], frame.scale.y); // YScale
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_DELAY], frame.delay); /* Delay */
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_VISIBLE], frame.isVisible); // Visible
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_RED_TINT], FLOAT_TO_U8(frame.tintRGBA.r)); // RedTint
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_GREEN_TINT], FLOAT_TO_U8(frame.tintRGBA.g)); // GreenTint
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_BLUE_TINT], FLOAT_TO_U8(frame.tintRGBA.b)); // BlueTint
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_ALPHA_TINT], FLOAT_TO_U8(frame.tintRGBA.a)); // AlphaTint
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_RED_OFFSET], FLOAT_TO_U8(frame.offsetRGB.r)); // RedOffset
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_GREEN_OFFSET], FLOAT_TO_U8(frame.offsetRGB.g)); // GreenOffset
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_BLUE_OFFSET], FLOAT_TO_U8(frame.offsetRGB.b)); // BlueOffset
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_ROTATION], frame.rotation); // Rotation
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_INTERPOLATED], frame.isInterpolated); // Interpolated
-			
-				layerAnimationElement->InsertEndChild(frameElement);
-			}
-
-			layerAnimationsElement->InsertEndChild(layerAnimationElement);
-		}
-
-		animationElement->InsertEndChild(layerAnimationsElement);
-
-		// NullAnimations
-		nullAnimationsElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_NULL_ANIMATIONS]);
-
-		for (const auto& [nullID, nullAnimation] : animation.nullAnimations)
-		{
-			XMLElement* nullAnimationElement;
-
-			// NullAnimation
-			nullAnimationElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_NULL_ANIMATION]);
-			nullAnimationElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_NULL_ID], nullID); // NullId
-			nullAnimationElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_VISIBLE], nullAnimation.isVisible); // Visible 
-			
-			for (const auto& frame : nullAnimation.frames)
-			{
-				XMLElement* frameElement;
-
-				// Frame
-				frameElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_FRAME]);
-				
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_X_POSITION], frame.position.x); // XPosition
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_Y_POSITION], frame.position.y); // YPosition
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_X_PIVOT], frame.pivot.x); // XPivot
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_Y_PIVOT], frame.pivot.y); // YPivot
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_X_SCALE], frame.scale.x); // XScale
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_Y_SCALE], frame.scale.y); // XScale
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_DELAY], frame.delay); // Delay 
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_VISIBLE], frame.isVisible); // Visible 
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_RED_TINT], FLOAT_TO_U8(frame.tintRGBA.r)); // RedTint 
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_GREEN_TINT], FLOAT_TO_U8(frame.tintRGBA.g)); // GreenTint 
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_BLUE_TINT], FLOAT_TO_U8(frame.tintRGBA.b)); // BlueTint 
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_ALPHA_TINT], FLOAT_TO_U8(frame.tintRGBA.a)); // AlphaTint 
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_RED_OFFSET], FLOAT_TO_U8(frame.offsetRGB.r)); // RedOffset 
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_GREEN_OFFSET], FLOAT_TO_U8(frame.offsetRGB.g)); // GreenOffset 
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_BLUE_OFFSET], FLOAT_TO_U8(frame.offsetRGB.b)); // BlueOffset 
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_ROTATION], frame.rotation); // Rotation 
-				frameElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_INTERPOLATED], frame.isInterpolated); // Interpolated 
-			
-				nullAnimationElement->InsertEndChild(frameElement);
-			}
-
-			nullAnimationsElement->InsertEndChild(nullAnimationElement);
-		}
-
-		animationElement->InsertEndChild(nullAnimationsElement);
-
-		// Triggers 
-		triggersElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_TRIGGERS]);
-
-		for (const auto& frame : animation.triggers.frames)
-		{
-			XMLElement* triggerElement;
-
-			// Trigger 
-			triggerElement = document.NewElement(ANM2_ELEMENT_STRINGS[ANM2_ELEMENT_TRIGGER]);
-			triggerElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_EVENT_ID], frame.eventID); // EventID 
-			triggerElement->SetAttribute(ANM2_ATTRIBUTE_STRINGS[ANM2_ATTRIBUTE_AT_FRAME], frame.atFrame); // AtFrame 
-			triggersElement->InsertEndChild(triggerElement);
-		}
-
-		animationElement->InsertEndChild(triggersElement);
-		
-		animationsElement->InsertEndChild(animationElement);
-	}
-
-	animatedActorElement->InsertEndChild(animationsElement);
+// Writes the document as it stands, without preparing it; a copy taken after anm2_serialize_prepare can be
+// written this way off the main thread
+bool anm2_serialize_write(Anm2* self, const std::string& path)
+{
+	std::string buffer;
 
-	error = document.SaveFile(path.c_str());
+	anm2_writer_write(self, &buffer);
 
-	if (error != XML_SUCCESS)
+	if (!anm2_writer_file_write(path, buffer))
 	{
 		log_error(std::format(ANM2_WRITE_ERROR, path));
 		return false;
 	}
 
+	// Only files opened through the cache keep a cache entry
+	if (anm2_cache_exists(path))
+		anm2_cache_write(self, path, buffer);
+
 	log_info(std::format(ANM2_WRITE_INFO, path));
 	
 	return true;
 }
 
-bool anm2_deserialize(Anm2* self, Resources* resources, const std::string& path)
+bool anm2_serialize(Anm2* self, const std::string& path)
+{
+	if (!self || path.empty()) return false;
+
+	anm2_serialize_prepare(self, path);
+	return anm2_serialize_write(self, path);
+}
+
+static bool _anm2_document_deserialize(Anm2* self, Resources* resources, const std::string& path)
 {
 	XMLDocument xmlDocument;
 	XMLError xmlError;
@@ -342,10 +99,8 @@ bool anm2_deserialize(Anm2* self, Resources* resources, const std::string& path)
 		return false;
 	}
 
-	// Save old working directory and then use anm2's path as directory
-	// (used for loading textures from anm2 correctly which are relative)
-    std::filesystem::path workingPath = std::filesystem::current_path();
-	working_directory_from_file_set(path);
+	// Spritesheet paths are relative to the anm2
+	std::string directory = path_directory_get(path);
 	
 	self->path = path;
 	
@@ -591,7 +346,7 @@ bool anm2_deserialize(Anm2* self, Resources* resources, const std::string& path)
 		}
 
 		if (anm2Element == ANM2_ELEMENT_SPRITESHEET && resources) 
-			resources_texture_init(resources, spritesheet->path, id);
+			resources_texture_init(resources, spritesheet->path, id, directory);
 
 		xmlChild = xmlElement->FirstChildElement();
 
@@ -623,19 +378,94 @@ bool anm2_deserialize(Anm2* self, Resources* resources, const std::string& path)
 			self->defaultAnimationID = id;
 
 	log_info(std::format(ANM2_READ_INFO, path));
-	
-	// Return to old working directory
-	std::filesystem::current_path(workingPath);
 
 	return true;
 }
 
+static bool _anm2_stream_deserialize(Anm2* self, Resources* resources, const std::string& path, Anm2ReadType type)
+{
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	std::shared_ptr<std::string> source = std::make_shared<std::string>(); // outlives the read when lazy
+	std::string& data = *source;
+	std::string error;
+	bool isCache = type == ANM2_READ_CACHE;
+	bool isLazy = type == ANM2_READ_LAZY;
+
+	anm2_new(self);
+
+	if (!file.is_open())
+	{
+		log_error(std::format(ANM2_READ_ERROR, path));
+		return false;
+	}
+
+	data.resize((size_t)file.tellg());
+	file.seekg(0);
+
+	if (!file.read(data.data(), data.size()))
+	{
+		log_error(std::format(ANM2_READ_ERROR, path));
+		return false;
+	}
+
+	// Spritesheet paths are relative to the anm2
+	std::string directory = path_directory_get(path);
+
+	self->path = path;
+
+	bool isSuccess = true;
+
+	if (isCache && anm2_cache_read(self, path, data))
+	{
+		if (resources)
+			for (auto& [id, spritesheet] : self->spritesheets)
+				resources_texture_init(resources, spritesheet.path, id, directory);
+	}
+	else
+	{
+		isSuccess = anm2_reader_read(self, resources, directory, data.data(), data.size(), &error, isLazy ? source : nullptr);
+
+		if (isSuccess && isCache)
+			anm2_cache_write(self, path, data);
+	}
+
+	if (!isSuccess)
+	{
+		anm2_new(self);
+		log_error(std::format(ANM2_READ_ERROR, error));
+		return false;
+	}
+
+	log_info(std::format(ANM2_READ_INFO, path));
+
+	return true;
+}
+
+bool anm2_deserialize(Anm2* self, Resources* resources, const std::string& path, Anm2ReadType type)
+{
+	if (!self || path.empty()) return false;
+
+	switch (type)
+	{
+		case ANM2_READ_DOCUMENT:
+			return _anm2_document_deserialize(self, resources, path);
+		case ANM2_READ_CACHE:
+		case ANM2_READ_LAZY:
+		case ANM2_READ_STREAM:
+		default:
+			return _anm2_stream_deserialize(self, resources, path, type);
+	}
+}
+
 void anm2_layer_add(Anm2* self)
 {
 	s32 id = map_next_id_get(self->layers);
 
 	self->layers[id] = Anm2Layer{};
 	self->layerMap[self->layers.size() - 1] = id;
+
+	anm2_animations_materialize(self);
+	anm2_animations_dirty_set(self);
 	
 	for (auto& [_, animation] : self->animations)
 		animation.layerAnimations[id] = Anm2Item{};
@@ -657,13 +487,10 @@ void anm2_layer_remove(Anm2* self, s32 id)
         }
     }
 
-    std::map<s32, s32> newLayerMap;
-    s32 newIndex = 0;
-
-    for (const auto& [_, layerID] : self->layerMap)
-        newLayerMap[newIndex++] = layerID;
+    map_ids_compact(self->layerMap);
 
-    self->layerMap = std::move(newLayerMap);
+	anm2_animations_materialize(self);
+	anm2_animations_dirty_set(self);
  
 	for (auto& [_, animation] : self->animations)
         animation.layerAnimations.erase(id);
@@ -675,6 +502,9 @@ void anm2_null_add(Anm2* self)
 
 	self->nulls[id] = Anm2Null{};
 
+	anm2_animations_materialize(self);
+	anm2_animations_dirty_set(self);
+
 	for (auto& [_, animation] : self->animations)
 		animation.nullAnimations[id] = Anm2Item{};
 }
@@ -685,27 +515,30 @@ void anm2_null_remove(Anm2* self, s32 id)
         return;
 
     self->nulls.erase(id);
+    map_ids_compact(self->nulls);
 
-    std::map<s32, Anm2Null> newNulls;
-    s32 newID = 0;
-	
-    for (const auto& [_, null] : self->nulls)
-        newNulls[newID++] = null;
-
-    self->nulls = std::move(newNulls);
+    anm2_animations_materialize(self);
+    anm2_animations_dirty_set(self);
 
     for (auto& [_, animation] : self->animations)
     {
-        if (animation.nullAnimations.contains(id))
-            animation.nullAnimations.erase(id);
+        animation.nullAnimations.erase(id);
+        map_ids_compact(animation.nullAnimations);
+    }
+}
 
-        std::map<s32, Anm2Item> newNullAnims;
-        s32 newAnimID = 0;
-        for (const auto& [_, nullAnim] : animation.nullAnimations)
-            newNullAnims[newAnimID++] = nullAnim;
+// Swaps two nulls, and their items in one animation. The items change ids in place, so the animation's written
+// fragment and revision no longer describe it and it's dirtied
+void anm2_null_swap(Anm2* self, s32 animationID, s32 id, s32 otherID)
+{
+	map_swap(self->nulls, id, otherID);
 
-        animation.nullAnimations = std::move(newNullAnims);
-    }
+	Anm2Animation* animation = map_find(self->animations, animationID);
+	if (!animation) return;
+
+	anm2_animation_materialize(animation);
+	map_swap(animation->nullAnimations, id, otherID);
+	anm2_animation_dirty_set(animation);
 }
 
 
@@ -737,6 +570,418 @@ void anm2_new(Anm2* self)
 	_anm2_created_on_set(self);
 }
 
+template <typename Frame>
+static auto _anm2_packed_floats_get(Frame& frame)
+{
+	return std::array{&frame.rotation, &frame.crop.x, &frame.crop.y, &frame.pivot.x, &frame.pivot.y, &frame.position.x,
+		&frame.position.y, &frame.size.x, &frame.size.y, &frame.scale.x, &frame.scale.y};
+}
+
+template <typename Frame>
+static auto _anm2_packed_ints_get(Frame& frame)
+{
+	return std::array{&frame.delay, &frame.atFrame, &frame.eventID};
+}
+
+template <typename Frame>
+static auto _anm2_packed_colors_get(Frame& frame)
+{
+	return std::array{&frame.offsetRGB.r, &frame.offsetRGB.g, &frame.offsetRGB.b, &frame.tintRGBA.r, &frame.tintRGBA.g,
+		&frame.tintRGBA.b, &frame.tintRGBA.a};
+}
+
+template <typename T>
+static void _anm2_packed_write(std::vector<u8>* packed, T value)
+{
+	size_t size = packed->size();
+	packed->resize(size + sizeof(T));
+	memcpy(packed->data() + size, &value, sizeof(T));
+}
+
+template <typename T>
+static T _anm2_packed_read(const u8** cursor)
+{
+	T value;
+	memcpy(&value, *cursor, sizeof(T));
+	*cursor += sizeof(T);
+	return value;
+}
+
+// Narrow only when the value comes back bit for bit
+static bool _anm2_packed_float_is_narrow(f32 value)
+{
+	return value >= INT16_MIN && value <= INT16_MAX && std::bit_cast<u32>((f32)(s16)value) == std::bit_cast<u32>(value);
+}
+
+static bool _anm2_packed_color_is_narrow(f32 value)
+{
+	return value >= 0.0f && value <= 1.0f &&
+		std::bit_cast<u32>(U8_TO_FLOAT((f32)(u8)std::round(value * 255.0f))) == std::bit_cast<u32>(value);
+}
+
+static void _anm2_packed_frame_write(std::vector<u8>* packed, const Anm2Frame& frame, const Anm2Frame& previous)
+{
+	auto floats = _anm2_packed_floats_get(frame);
+	auto ints = _anm2_packed_ints_get(frame);
+	auto colors = _anm2_packed_colors_get(frame);
+	auto previousFloats = _anm2_packed_floats_get(previous);
+	auto previousInts = _anm2_packed_ints_get(previous);
+	auto previousColors = _anm2_packed_colors_get(previous);
+	u32 header = 0;
+	u32 wide = 0;
+	u32 bit = 1;
+
+	for (s32 i = 0; i < ANM2_PACKED_FLOAT_COUNT; i++, bit <<= 1)
+	{
+		if (std::bit_cast<u32>(*floats[i]) == std::bit_cast<u32>(*previousFloats[i])) continue;
+		header |= bit;
+		if (!_anm2_packed_float_is_narrow(*floats[i])) wide |= bit;
+	}
+
+	for (s32 i = 0; i < ANM2_PACKED_INT_COUNT; i++, bit <<= 1)
+	{
+		if (*ints[i] == *previousInts[i]) continue;
+		header |= bit;
+		if (*ints[i] < INT16_MIN || *ints[i] > INT16_MAX) wide |= bit;
+	}
+
+	for (s32 i = 0; i < ANM2_PACKED_COLOR_COUNT; i++, bit <<= 1)
+	{
+		if (std::bit_cast<u32>(*colors[i]) == std::bit_cast<u32>(*previousColors[i])) continue;
+		header |= bit;
+		if (!_anm2_packed_color_is_narrow(*colors[i])) wide |= bit;
+	}
+
+	if (frame.isVisible) header |= ANM2_PACKED_VISIBLE;
+	if (frame.isInterpolated) header |= ANM2_PACKED_INTERPOLATED;
+	if (wide) header |= ANM2_PACKED_WIDE;
+
+	_anm2_packed_write(packed, header);
+	if (wide) _anm2_packed_write(packed, wide);
+
+	bit = 1;
+
+	for (s32 i = 0; i < ANM2_PACKED_FLOAT_COUNT; i++, bit <<= 1)
+	{
+		if (!(header & bit)) continue;
+		if (wide & bit) _anm2_packed_write(packed, *floats[i]);
+		else _anm2_packed_write(packed, (s16)*floats[i]);
+	}
+
+	for (s32 i = 0; i < ANM2_PACKED_INT_COUNT; i++, bit <<= 1)
+	{
+		if (!(header & bit)) continue;
+		if (wide & bit) _anm2_packed_write(packed, *ints[i]);
+		else _anm2_packed_write(packed, (s16)*ints[i]);
+	}
+
+	for (s32 i = 0; i < ANM2_PACKED_COLOR_COUNT; i++, bit <<= 1)
+	{
+		if (!(header & bit)) continue;
+		if (wide & bit) _anm2_packed_write(packed, *colors[i]);
+		else _anm2_packed_write(packed, (u8)std::round(*colors[i] * 255.0f));
+	}
+}
+
+static void _anm2_packed_frame_read(const u8** cursor, Anm2Frame* frame)
+{
+	auto floats = _anm2_packed_floats_get(*frame);
+	auto ints = _anm2_packed_ints_get(*frame);
+	auto colors = _anm2_packed_colors_get(*frame);
+	u32 header = _anm2_packed_read<u32>(cursor);
+	u32 wide = header & ANM2_PACKED_WIDE ? _anm2_packed_read<u32>(cursor) : 0;
+	u32 bit = 1;
+
+	// Fields left out carry over from the previous frame, which the caller passes in
+	for (s32 i = 0; i < ANM2_PACKED_FLOAT_COUNT; i++, bit <<= 1)
+		if (header & bit)
+			*floats[i] = wide & bit ? _anm2_packed_read<f32>(cursor) : (f32)_anm2_packed_read<s16>(cursor);
+
+	for (s32 i = 0; i < ANM2_PACKED_INT_COUNT; i++, bit <<= 1)
+		if (header & bit)
+			*ints[i] = wide & bit ? _anm2_packed_read<s32>(cursor) : (s32)_anm2_packed_read<s16>(cursor);
+
+	for (s32 i = 0; i < ANM2_PACKED_COLOR_COUNT; i++, bit <<= 1)
+		if (header & bit)
+			*colors[i] = wide & bit ? _anm2_packed_read<f32>(cursor) : U8_TO_FLOAT((f32)_anm2_packed_read<u8>(cursor));
+
+	frame->isVisible = header & ANM2_PACKED_VISIBLE;
+	frame->isInterpolated = header & ANM2_PACKED_INTERPOLATED;
+}
+
+static void _anm2_packed_item_write(std::vector<u8>* packed, const Anm2Item& item)
+{
+	Anm2Frame previous;
+
+	_anm2_packed_write(packed, (u8)item.isVisible);
+	_anm2_packed_write(packed, (u32)item.frames.size());
+
+	for (auto& frame : item.frames)
+	{
+		_anm2_packed_frame_write(packed, frame, previous);
+		previous = frame;
+	}
+}
+
+static void _anm2_packed_item_read(const u8** cursor, Anm2Item* item)
+{
+	Anm2Frame frame;
+
+	item->isVisible = _anm2_packed_read<u8>(cursor);
+	item->frames.resize(_anm2_packed_read<u32>(cursor));
+
+	for (auto& itemFrame : item->frames)
+	{
+		_anm2_packed_frame_read(cursor, &frame);
+		itemFrame = frame;
+	}
+}
+
+static void _anm2_packed_items_write(std::vector<u8>* packed, const IdMap<Anm2Item>& items)
+{
+	_anm2_packed_write(packed, (u32)items.size());
+
+	for (auto& [id, item] : items)
+	{
+		_anm2_packed_write(packed, id);
+		_anm2_packed_item_write(packed, item);
+	}
+}
+
+static void _anm2_packed_items_read(const u8** cursor, IdMap<Anm2Item>* items)
+{
+	u32 count = _anm2_packed_read<u32>(cursor);
+
+	items->reserve(count);
+
+	for (u32 i = 0; i < count; i++)
+	{
+		s32 id = _anm2_packed_read<s32>(cursor);
+		_anm2_packed_item_read(cursor, &(*items)[id]);
+	}
+}
+
+static void _anm2_animation_unpack(Anm2Animation* self)
+{
+	const u8* cursor = self->packed->data();
+
+	_anm2_packed_item_read(&cursor, &self->rootAnimation);
+	_anm2_packed_items_read(&cursor, &self->layerAnimations);
+	_anm2_packed_items_read(&cursor, &self->nullAnimations);
+	_anm2_packed_item_read(&cursor, &self->triggers);
+
+	self->packed.reset();
+}
+
+// Packs the children into a compact byte string and frees them; the fragment and length stay valid, since nothing changed
+void anm2_animation_compact(Anm2Animation* self)
+{
+	if (self->packed || self->source) return;
+
+	std::vector<u8> packed;
+
+	_anm2_packed_item_write(&packed, self->rootAnimation);
+	_anm2_packed_items_write(&packed, self->layerAnimations);
+	_anm2_packed_items_write(&packed, self->nullAnimations);
+	_anm2_packed_item_write(&packed, self->triggers);
+
+	packed.shrink_to_fit();
+	self->packed = std::make_shared<const std::vector<u8>>(std::move(packed));
+
+	self->rootAnimation = Anm2Item{};
+	self->layerAnimations = IdMap<Anm2Item>{};
+	self->nullAnimations = IdMap<Anm2Item>{};
+	self->triggers = Anm2Item{};
+}
+
+void anm2_animations_compact(Anm2* self)
+{
+	for (auto& [_, animation] : self->animations)
+		anm2_animation_compact(&animation);
+}
+
+void anm2_animation_materialize(Anm2Animation* self)
+{
+	std::string error;
+
+	if (self->packed)
+	{
+		_anm2_animation_unpack(self);
+		return;
+	}
+
+	if (!self->source) return;
+
+	if (!anm2_reader_animation_body_read(self, &error))
+		log_error(std::format(ANM2_MATERIALIZE_ERROR, self->name, error));
+}
+
+void anm2_animations_materialize(Anm2* self)
+{
+	for (auto& [_, animation] : self->animations)
+		anm2_animation_materialize(&animation);
+}
+
+// Shared by every document, so revisions never repeat across them
+u64 anm2_revision_next(void)
+{
+	static std::atomic<u64> revision{};
+	return ++revision;
+}
+
+// Drops the cached fragment and tracks, so the next save writes the animation's children out again
+void anm2_animation_dirty_set(Anm2Animation* self)
+{
+	self->fragment.reset();
+	self->length = ANM2_LENGTH_NONE;
+	self->revision = anm2_revision_next();
+
+	anm2_item_dirty_set(&self->rootAnimation);
+	anm2_item_dirty_set(&self->triggers);
+
+	for (auto& [_, item] : self->layerAnimations)
+		anm2_item_dirty_set(&item);
+	for (auto& [_, item] : self->nullAnimations)
+		anm2_item_dirty_set(&item);
+}
+
+void anm2_item_dirty_set(Anm2Item* self)
+{
+	self->track.reset();
+	self->triggerTrack.reset();
+	self->length = ANM2_LENGTH_NONE;
+}
+
+// An edit to one item's frames; the animation's saved form and length go as with any edit, but only that item's
+// tracks, so what's built from the others (cached poses) stays
+void anm2_animation_item_dirty_set(Anm2Animation* self, Anm2Item* item)
+{
+	self->fragment.reset();
+	self->length = ANM2_LENGTH_NONE;
+	self->revision = anm2_revision_next();
+
+	anm2_item_dirty_set(item);
+}
+
+const Anm2Track* anm2_item_track_get(Anm2Item* self)
+{
+	if (self->track) return self->track.get();
+
+	std::shared_ptr<Anm2Track> track = std::make_shared<Anm2Track>();
+	const std::vector<Anm2Frame>& frames = self->frames.read(); // read only, so a shared buffer stays shared
+	size_t count = frames.size();
+
+	track->delayEnds.reserve(count);
+	track->flags.reserve(count);
+	track->rotations.reserve(count);
+	track->positions.reserve(count);
+	track->scales.reserve(count);
+	track->pivots.reserve(count);
+	track->crops.reserve(count);
+	track->sizes.reserve(count);
+	track->offsetRGBs.reserve(count);
+	track->tintRGBAs.reserve(count);
+
+	s32 delayEnd = 0;
+
+	for (auto& frame : frames)
+	{
+		delayEnd += frame.delay;
+
+		track->delayEnds.push_back(delayEnd);
+		track->flags.push_back((frame.isVisible ? ANM2_TRACK_VISIBLE : 0) | (frame.isInterpolated ? ANM2_TRACK_INTERPOLATED : 0));
+		track->rotations.push_back(frame.rotation);
+		track->positions.push_back(frame.position);
+		track->scales.push_back(frame.scale);
+		track->pivots.push_back(frame.pivot);
+		track->crops.push_back(frame.crop);
+		track->sizes.push_back(frame.size);
+		track->offsetRGBs.push_back(frame.offsetRGB);
+		track->tintRGBAs.push_back(frame.tintRGBA);
+	}
+
+	self->track = track;
+
+	return track.get();
+}
+
+// Reassembles one frame from the track's columns; trigger fields are left at their defaults, as tracks only serve the rest
+Anm2Frame anm2_track_frame_get(const Anm2Track* self, s32 index)
+{
+	Anm2Frame frame;
+
+	frame.isVisible = self->flags[index] & ANM2_TRACK_VISIBLE;
+	frame.isInterpolated = self->flags[index] & ANM2_TRACK_INTERPOLATED;
+	frame.rotation = self->rotations[index];
+	frame.delay = anm2_track_delay_get(self, index);
+	frame.crop = self->crops[index];
+	frame.pivot = self->pivots[index];
+	frame.position = self->positions[index];
+	frame.size = self->sizes[index];
+	frame.scale = self->scales[index];
+	frame.offsetRGB = self->offsetRGBs[index];
+	frame.tintRGBA = self->tintRGBAs[index];
+
+	return frame;
+}
+
+const Anm2TriggerTrack* anm2_trigger_track_get(Anm2Item* self)
+{
+	if (self->triggerTrack) return self->triggerTrack.get();
+
+	std::shared_ptr<Anm2TriggerTrack> track = std::make_shared<Anm2TriggerTrack>();
+	const std::vector<Anm2Frame>& frames = self->frames.read();
+	std::vector<s32> order(frames.size());
+
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](s32 a, s32 b) { return frames[a].atFrame < frames[b].atFrame; });
+
+	track->atFrames.reserve(order.size());
+	track->eventIDs.reserve(order.size());
+
+	for (s32 index : order)
+	{
+		track->atFrames.push_back(frames[index].atFrame);
+		track->eventIDs.push_back(frames[index].eventID);
+	}
+
+	track->indices = std::move(order);
+	self->triggerTrack = track;
+
+	return track.get();
+}
+
+// Triggers fired in [start, end); a trigger fires once time reaches its atFrame. Looping playback queries the
+// two pieces of a window that wraps separately
+Anm2TriggerRange anm2_trigger_range_get(Anm2Item* self, f32 start, f32 end)
+{
+	const Anm2TriggerTrack* track = anm2_trigger_track_get(self);
+	auto compare = [](s32 atFrame, f32 time) { return atFrame < time; };
+
+	auto begin = std::lower_bound(track->atFrames.begin(), track->atFrames.end(), start, compare);
+	auto last = std::lower_bound(begin, track->atFrames.end(), std::max(start, end), compare);
+
+	return {track, (s32)(begin - track->atFrames.begin()), (s32)(last - track->atFrames.begin())};
+}
+
+// Whether a trigger other than ignoreIndex (an index into the item's frames) sits at atFrame
+bool anm2_trigger_is_at(Anm2Item* self, s32 atFrame, s32 ignoreIndex)
+{
+	Anm2TriggerRange range = anm2_trigger_range_get(self, atFrame, atFrame + 1);
+
+	for (s32 i = range.begin; i < range.end; i++)
+		if (range.track->indices[i] != ignoreIndex)
+			return true;
+
+	return false;
+}
+
+void anm2_animations_dirty_set(Anm2* self)
+{
+	for (auto& [_, animation] : self->animations)
+		anm2_animation_dirty_set(&animation);
+}
+
 Anm2Animation* anm2_animation_from_reference(Anm2* self, Anm2Reference* reference)
 {
 	if (reference->animationID == ID_NONE) return nullptr;
@@ -744,7 +989,11 @@ Anm2Animation* anm2_animation_from_reference(Anm2* self, Anm2Reference* referenc
 	if (!self->animations.contains(reference->animationID))
 		return nullptr;
 
-	return &self->animations[reference->animationID];
+	Anm2Animation* animation = &self->animations[reference->animationID];
+
+	anm2_animation_materialize(animation);
+
+	return animation;
 }
 
 Anm2Item* anm2_item_from_reference(Anm2* self, Anm2Reference* reference)
@@ -797,20 +1046,14 @@ s32 anm2_frame_index_from_time(Anm2* self, Anm2Reference reference, f32 time)
 
 	if (!item) return INDEX_NONE;
 
-	s32 delayCurrent = 0;
-	s32 delayNext = 0;
-
-	for (auto [i, frame] : std::views::enumerate(item->frames))
-	{
-		delayNext += frame.delay;
+	const Anm2Track* track = anm2_item_track_get(item);
 
-		if (time >= delayCurrent && time < delayNext)
-			return i;
+	// First frame ending after time
+	auto it = std::upper_bound(track->delayEnds.begin(), track->delayEnds.end(), time, [](f32 value, s32 delayEnd) { return value < delayEnd; });
 
-		delayCurrent += frame.delay;
-	}
+	if (it == track->delayEnds.end()) return INDEX_NONE;
 
-	return INDEX_NONE;
+	return (s32)(it - track->delayEnds.begin());
 }
 
 void anm2_frame_from_time(Anm2* self, Anm2Frame* frame, Anm2Reference reference, f32 time)
@@ -825,80 +1068,467 @@ void anm2_frame_from_time(Anm2* self, Anm2Frame* frame, Anm2Reference reference,
 
 	if (!item) return;
 
-	Anm2Frame* frameNext = nullptr;
-	s32 delayCurrent = 0;
-	s32 delayNext = 0;
+	// The first trigger at this frame, if any
+	if (reference.itemType == ANM2_TRIGGERS)
+	{
+		s32 atFrame = (s32)time;
+		Anm2TriggerRange range = anm2_trigger_range_get(item, atFrame, atFrame + 1);
 
-	for (auto [i, iFrame] : std::views::enumerate(item->frames))
+		if (range.begin < range.end)
+			*frame = item->frames.read()[range.track->indices[range.begin]];
+		return;
+	}
+
+	const Anm2Track* track = anm2_item_track_get(item);
+	s32 count = (s32)track->delayEnds.size();
+
+	if (count == 0) return;
+
+	// Binary search for the first frame ending after time, so lookups cost the same in long tracks as short ones;
+	// past the end, the last frame holds
+	auto it = std::upper_bound(track->delayEnds.begin(), track->delayEnds.end(), time, [](f32 value, s32 delayEnd) { return value < delayEnd; });
+	s32 index = std::min((s32)(it - track->delayEnds.begin()), count - 1);
+	s32 delayNext = track->delayEnds[index];
+	s32 delayCurrent = delayNext - anm2_track_delay_get(track, index);
+
+	*frame = anm2_track_frame_get(track, index);
+
+	bool isNext = time < delayNext && index + 1 < count;
+
+	if (frame->isInterpolated && isNext && frame->delay > 1)
+	{
+		s32 next = index + 1;
+		f32 interpolation = (time - delayCurrent) / (delayNext - delayCurrent);
+
+		frame->rotation    = glm::mix(frame->rotation,    track->rotations[next],  interpolation);
+		frame->position    = glm::mix(frame->position,    track->positions[next],  interpolation);
+		frame->scale       = glm::mix(frame->scale,       track->scales[next],     interpolation);
+		frame->offsetRGB   = glm::mix(frame->offsetRGB,   track->offsetRGBs[next], interpolation);
+		frame->tintRGBA    = glm::mix(frame->tintRGBA,    track->tintRGBAs[next],  interpolation);
+	}
+}
+
+static void _anm2_pose_track_add(Anm2Pose* self, Anm2Item* item, Anm2Type type, s32 id, s32 spritesheetID)
+{
+	const Anm2Track* track = anm2_item_track_get(item);
+
+	// Layers and nulls without frames aren't drawn; a root without them still parents at its default
+	if (type != ANM2_ROOT && track->delayEnds.empty()) return;
+
+	self->types.push_back(type);
+	self->ids.push_back(id);
+	self->isVisibles.push_back(item->isVisible);
+	self->spritesheetIDs.push_back(spritesheetID);
+	self->items.push_back(item);
+}
+
+// Sizes a pose's results for count tracks
+static void _anm2_pose_resize(Anm2Pose* self, s32 count)
+{
+	s32 stride = (count + ANM2_POSE_LANES - 1) / ANM2_POSE_LANES * ANM2_POSE_LANES;
+
+	self->count = count;
+	self->stride = stride;
+	self->isVisibles.resize(count);
+	self->isInterpolateds.resize(count);
+	self->crops.resize(count);
+	self->sizes.resize(count);
+	self->pivots.resize(count);
+	self->models.resize(count);
+	self->channels.resize(ANM2_POSE_CHANNEL_COUNT * stride);
+}
+
+// Sizes a pose's sampling scratch; every interpolation starts at 0, so padding lanes and tracks not sampled hold
+static void _anm2_pose_scratch_resize(Anm2Pose* self)
+{
+	self->channelsNext.resize(ANM2_POSE_CHANNEL_COUNT * self->stride);
+	self->interpolations.assign(self->stride, 0.0f);
+}
+
+// The animation's tracks, each with its item's visibility; none without an animation
+static void _anm2_pose_tracks_set(Anm2* self, Anm2Pose* pose, Anm2Animation* animation)
+{
+	pose->rootModel = mat4(1.0f);
+	pose->types.clear();
+	pose->ids.clear();
+	pose->isVisibles.clear();
+	pose->spritesheetIDs.clear();
+	pose->items.clear();
+
+	if (animation)
 	{
-		if (reference.itemType == ANM2_TRIGGERS)
+		_anm2_pose_track_add(pose, &animation->rootAnimation, ANM2_ROOT, ID_NONE, ID_NONE);
+
+		for (auto& [_, id] : self->layerMap)
 		{
-			if ((s32)time == iFrame.atFrame)
-			{
-				*frame = iFrame;
-				break;	
-			}
+			auto it = animation->layerAnimations.find(id);
+			auto layer = self->layers.find(id);
+
+			if (it != animation->layerAnimations.end())
+				_anm2_pose_track_add(pose, &it->second, ANM2_LAYER, id, layer != self->layers.end() ? layer->second.spritesheetID : ID_NONE);
 		}
-		else
-		{
-			*frame = iFrame;
-			
-			delayNext += frame->delay;
 
-			if (time >= delayCurrent && time < delayNext)
-			{
-				if (i + 1 < (s32)item->frames.size())
-					frameNext = &item->frames[i + 1];
-				else
-					frameNext = nullptr;
-				break;
-			}
+		for (auto& [id, item] : animation->nullAnimations)
+			_anm2_pose_track_add(pose, &item, ANM2_NULL, id, ID_NONE);
+	}
 
-			delayCurrent += frame->delay;
-		}
+	_anm2_pose_resize(pose, (s32)pose->items.size());
+}
+
+static void _anm2_pose_channels_set(f32* values, s32 stride, s32 index, f32 rotation, vec2 position, vec2 scale, vec3 offsetRGB, vec4 tintRGBA)
+{
+	values[ANM2_POSE_ROTATION * stride + index] = rotation;
+	values[ANM2_POSE_POSITION_X * stride + index] = position.x;
+	values[ANM2_POSE_POSITION_Y * stride + index] = position.y;
+	values[ANM2_POSE_SCALE_X * stride + index] = scale.x;
+	values[ANM2_POSE_SCALE_Y * stride + index] = scale.y;
+	values[ANM2_POSE_OFFSET_R * stride + index] = offsetRGB.r;
+	values[ANM2_POSE_OFFSET_G * stride + index] = offsetRGB.g;
+	values[ANM2_POSE_OFFSET_B * stride + index] = offsetRGB.b;
+	values[ANM2_POSE_TINT_R * stride + index] = tintRGBA.r;
+	values[ANM2_POSE_TINT_G * stride + index] = tintRGBA.g;
+	values[ANM2_POSE_TINT_B * stride + index] = tintRGBA.b;
+	values[ANM2_POSE_TINT_A * stride + index] = tintRGBA.a;
+}
+
+// Finds a track's keys at time and gathers both's channels; the lerp between them is left to _anm2_pose_lerp.
+// A track with no frames holds the default frame
+static void _anm2_pose_key_set(Anm2Pose* self, s32 index, const Anm2Track* track, f32 time)
+{
+	s32 frameCount = (s32)track->delayEnds.size();
+	s32 stride = self->stride;
+
+	if (frameCount == 0)
+	{
+		const Anm2Frame frame;
+
+		self->isVisibles[index] = self->isVisibles[index] && frame.isVisible;
+		self->isInterpolateds[index] = false;
+		self->crops[index] = frame.crop;
+		self->sizes[index] = frame.size;
+		self->pivots[index] = frame.pivot;
+		self->interpolations[index] = 0.0f;
+		_anm2_pose_channels_set(self->channels.data(), stride, index, frame.rotation, frame.position, frame.scale, frame.offsetRGB, frame.tintRGBA);
+		_anm2_pose_channels_set(self->channelsNext.data(), stride, index, frame.rotation, frame.position, frame.scale, frame.offsetRGB, frame.tintRGBA);
+		return;
 	}
 
-	if (reference.itemType == ANM2_TRIGGERS)
+	auto it = std::upper_bound(track->delayEnds.begin(), track->delayEnds.end(), time, [](f32 value, s32 delayEnd) { return value < delayEnd; });
+	s32 key = std::min((s32)(it - track->delayEnds.begin()), frameCount - 1);
+	s32 delayNext = track->delayEnds[key];
+	s32 delayCurrent = delayNext - anm2_track_delay_get(track, key);
+	s32 next = key;
+	f32 interpolation = 0.0f;
+	bool isInterpolated = (track->flags[key] & ANM2_TRACK_INTERPOLATED) && key + 1 < frameCount && delayNext - delayCurrent > 1;
+
+	if (isInterpolated && time < delayNext)
+	{
+		next = key + 1;
+		interpolation = (time - delayCurrent) / (delayNext - delayCurrent);
+	}
+
+	self->isVisibles[index] = self->isVisibles[index] && (track->flags[key] & ANM2_TRACK_VISIBLE);
+	self->isInterpolateds[index] = isInterpolated && time < delayNext;
+	self->crops[index] = track->crops[key];
+	self->sizes[index] = track->sizes[key];
+	self->pivots[index] = track->pivots[key];
+	self->interpolations[index] = interpolation;
+	_anm2_pose_channels_set(self->channels.data(), stride, index, track->rotations[key], track->positions[key], track->scales[key], track->offsetRGBs[key], track->tintRGBAs[key]);
+	_anm2_pose_channels_set(self->channelsNext.data(), stride, index, track->rotations[next], track->positions[next], track->scales[next], track->offsetRGBs[next], track->tintRGBAs[next]);
+}
+
+// A lane block at a time, with no aliasing, so this compiles to SIMD lerps even at -O2; written as glm::mix is, so
+// an interpolation of 0 gives the current value back exactly
+static void _anm2_pose_lerp(f32* __restrict values, const f32* __restrict valuesNext, const f32* __restrict interpolations, s32 count)
+{
+	for (s32 i = 0; i < count; i += ANM2_POSE_LANES)
+		for (s32 lane = 0; lane < ANM2_POSE_LANES; lane++)
+			values[i + lane] = values[i + lane] * (1.0f - interpolations[i + lane]) + valuesNext[i + lane] * interpolations[i + lane];
+}
+
+// Each channel's run against the same interpolations
+static void _anm2_pose_channels_lerp(Anm2Pose* self)
+{
+	s32 stride = self->stride;
+
+	for (s32 channel = 0; channel < ANM2_POSE_CHANNEL_COUNT; channel++)
+		_anm2_pose_lerp(self->channels.data() + channel * stride, self->channelsNext.data() + channel * stride, self->interpolations.data(), stride);
+}
+
+static void _anm2_pose_root_model_set(Anm2Pose* self, bool isRootTransform)
+{
+	self->rootModel = mat4(1.0f);
+
+	if (isRootTransform && self->count > 0)
+		self->rootModel = quad_parent_model_get(anm2_pose_position_get(self, 0), vec2(0.0f), anm2_pose_rotation_get(self, 0), PERCENT_TO_UNIT(anm2_pose_scale_get(self, 0)));
+}
+
+// The root's own is left unparented
+static void _anm2_pose_model_set(Anm2Pose* self, s32 index)
+{
+	mat4 model = quad_model_get(self->sizes[index], anm2_pose_position_get(self, index), self->pivots[index], anm2_pose_rotation_get(self, index), PERCENT_TO_UNIT(anm2_pose_scale_get(self, index)));
+	self->models[index] = index == 0 ? model : self->rootModel * model;
+}
+
+// Every track of a pose whose tracks are set, at time
+static void _anm2_pose_sample(Anm2Pose* self, f32 time, bool isRootTransform)
+{
+	_anm2_pose_scratch_resize(self);
+
+	for (s32 i = 0; i < self->count; i++)
+		_anm2_pose_key_set(self, i, self->items[i]->track.get(), time);
+
+	_anm2_pose_channels_lerp(self);
+	_anm2_pose_root_model_set(self, isRootTransform);
+
+	for (s32 i = 0; i < self->count; i++)
+		_anm2_pose_model_set(self, i);
+}
+
+// Samples every track of an animation at time in one pass: the keys are found and their channels gathered per track,
+// then every channel is lerped, then the models are built. Values match anm2_frame_from_time's
+void anm2_pose_get(Anm2* self, Anm2Pose* pose, s32 animationID, f32 time, bool isRootTransform)
+{
+	Anm2Reference reference = {animationID};
+	Anm2Animation* animation = anm2_animation_from_reference(self, &reference);
+
+	_anm2_pose_tracks_set(self, pose, animation);
+
+	if (!animation) return;
+
+	_anm2_pose_sample(pose, std::clamp(time, 0.0f, std::max(0.0f, animation->frameNum - 1.0f)), isRootTransform);
+}
+
+// Bakes whichever of a frame's tracks aren't yet; pose holds the animation's tracks as they are now
+static void _anm2_pose_cache_frame_bake(Anm2PoseCache* self, Anm2Pose* pose, s32 frame)
+{
+	s32 count = pose->count;
+	s32 bakedIndex = frame * count;
+	std::vector<s32> indices;
+
+	for (s32 i = 0; i < count; i++)
+		if (!self->isBakeds[bakedIndex + i])
+			indices.push_back(i);
+
+	if (indices.empty()) return;
+
+	Anm2Pose& bake = self->bake;
+	Anm2Pose& baked = self->frames[frame];
+
+	_anm2_pose_resize(&bake, count);
+	_anm2_pose_scratch_resize(&bake);
+
+	for (s32 i : indices)
+	{
+		bake.isVisibles[i] = true; // the item's visibility is applied when read, as it can change without an edit
+		_anm2_pose_key_set(&bake, i, pose->items[i]->track.get(), (f32)frame);
+	}
+
+	_anm2_pose_channels_lerp(&bake);
+
+	if (baked.count != count) _anm2_pose_resize(&baked, count);
+
+	for (s32 i : indices)
+	{
+		baked.isVisibles[i] = bake.isVisibles[i];
+		baked.isInterpolateds[i] = bake.isInterpolateds[i];
+		baked.crops[i] = bake.crops[i];
+		baked.sizes[i] = bake.sizes[i];
+		baked.pivots[i] = bake.pivots[i];
+
+		for (s32 channel = 0; channel < ANM2_POSE_CHANNEL_COUNT; channel++)
+			baked.channels[channel * baked.stride + i] = bake.channels[channel * bake.stride + i];
+
+		self->isBakeds[bakedIndex + i] = true;
+	}
+
+	// A root being baked has every track it parents baked with it
+	if (indices.front() == 0) _anm2_pose_root_model_set(&baked, self->isRootTransform);
+
+	for (s32 i : indices)
+		_anm2_pose_model_set(&baked, i);
+}
+
+// As anm2_pose_get, from the cache; the frames either side of time are baked first, if they aren't
+void anm2_pose_cache_get(Anm2* self, Anm2PoseCache* cache, Anm2Pose* pose, s32 animationID, f32 time, bool isRootTransform)
+{
+	Anm2Reference reference = {animationID};
+	Anm2Animation* animation = anm2_animation_from_reference(self, &reference);
+
+	_anm2_pose_tracks_set(self, pose, animation);
+
+	s32 count = pose->count;
+	s32 frameNum = animation ? animation->frameNum : 0;
+
+	if (!animation || frameNum <= 0 || (s64)frameNum * count > ANM2_POSE_CACHE_TRACK_FRAMES_MAX)
+	{
+		anm2_pose_cache_clear(cache);
+		if (animation) _anm2_pose_sample(pose, std::clamp(time, 0.0f, std::max(0.0f, frameNum - 1.0f)), isRootTransform);
 		return;
+	}
 
-	if (frame->isInterpolated && frameNext && frame->delay > 1)
+	if (cache->animationID != animationID || cache->frameNum != frameNum || cache->isRootTransform != isRootTransform ||
+		cache->types != pose->types || cache->ids != pose->ids)
 	{
-		f32 interpolation = (time - delayCurrent) / (delayNext - delayCurrent);
+		anm2_pose_cache_clear(cache);
+		cache->animationID = animationID;
+		cache->frameNum = frameNum;
+		cache->isRootTransform = isRootTransform;
+		cache->types = pose->types;
+		cache->ids = pose->ids;
+		cache->tracks.resize(count);
+		cache->frames.resize(frameNum);
+		cache->isBakeds.assign((size_t)frameNum * count, false);
+	}
+
+	// Edited tracks are rebaked; the root's parents the rest, so an edit to it rebakes them too
+	for (s32 i = 0; i < count; i++)
+	{
+		if (cache->tracks[i] == pose->items[i]->track) continue;
+
+		cache->tracks[i] = pose->items[i]->track;
 
-		frame->rotation    = glm::mix(frame->rotation,    frameNext->rotation,    interpolation);
-		frame->position    = glm::mix(frame->position,    frameNext->position,    interpolation);
-		frame->scale       = glm::mix(frame->scale,       frameNext->scale,       interpolation);
-		frame->offsetRGB   = glm::mix(frame->offsetRGB,   frameNext->offsetRGB,   interpolation);
-		frame->tintRGBA    = glm::mix(frame->tintRGBA,    frameNext->tintRGBA,    interpolation);
+		if (i == 0 && isRootTransform)
+			std::fill(cache->isBakeds.begin(), cache->isBakeds.end(), false);
+		else
+			for (s32 frame = 0; frame < frameNum; frame++)
+				cache->isBakeds[(size_t)frame * count + i] = false;
+	}
+
+	time = std::clamp(time, 0.0f, frameNum - 1.0f);
+
+	s32 frame = (s32)time;
+	f32 fraction = time - frame;
+
+	_anm2_pose_cache_frame_bake(cache, pose, frame);
+
+	const Anm2Pose& baked = cache->frames[frame];
+
+	for (s32 i = 0; i < count; i++)
+	{
+		pose->isVisibles[i] = pose->isVisibles[i] && baked.isVisibles[i];
+		pose->isInterpolateds[i] = baked.isInterpolateds[i];
+	}
+
+	pose->crops = baked.crops;
+	pose->sizes = baked.sizes;
+	pose->pivots = baked.pivots;
+	pose->channels = baked.channels;
+
+	if (fraction <= 0.0f)
+	{
+		pose->rootModel = baked.rootModel;
+		pose->models = baked.models;
+		return;
+	}
+
+	// Between frames, an interpolated track is lerped toward the next frame's (the same lerp, as keys fall on frames);
+	// the rest hold
+	_anm2_pose_cache_frame_bake(cache, pose, frame + 1);
+	_anm2_pose_scratch_resize(pose);
+
+	for (s32 i = 0; i < count; i++)
+		pose->interpolations[i] = baked.isInterpolateds[i] ? fraction : 0.0f;
+
+	std::copy(cache->frames[frame + 1].channels.begin(), cache->frames[frame + 1].channels.end(), pose->channelsNext.begin());
+
+	_anm2_pose_channels_lerp(pose);
+
+	// Only models that moved are rebuilt; a held root leaves every held track where it was baked
+	bool isRootHeld = pose->interpolations[0] == 0.0f;
+
+	if (isRootHeld)
+		pose->rootModel = baked.rootModel;
+	else
+		_anm2_pose_root_model_set(pose, isRootTransform);
+
+	for (s32 i = 0; i < count; i++)
+	{
+		if (pose->interpolations[i] == 0.0f && (isRootHeld || !isRootTransform || i == 0))
+			pose->models[i] = baked.models[i];
+		else
+			_anm2_pose_model_set(pose, i);
 	}
 }
 
-s32 anm2_animation_length_get(Anm2Animation* self)
+void anm2_pose_cache_clear(Anm2PoseCache* self)
+{
+	*self = Anm2PoseCache{};
+}
+
+static s32 _anm2_item_length_count(const Anm2Item* self, bool isTriggers)
 {
 	s32 length = 0;
+	s32 delaySum = 0;
 
-	auto accumulate_max_delay = [&](const std::vector<Anm2Frame>& frames)
+	for (const auto& frame : self->frames)
 	{
-		s32 delaySum = 0;
-		for (const auto& frame : frames)
+		if (isTriggers)
+			length = std::max(length, frame.atFrame + 1);
+		else
 		{
 			delaySum += frame.delay;
 			length = std::max(length, delaySum);
 		}
-	};
+	}
+
+	return length;
+}
+
+static s32 _anm2_item_length_get(Anm2Item* self, bool isTriggers)
+{
+	if (self->length == ANM2_LENGTH_NONE)
+		self->length = _anm2_item_length_count(self, isTriggers);
+
+	return self->length;
+}
 
-	accumulate_max_delay(self->rootAnimation.frames);
+#ifdef DEBUG
+static s32 _anm2_animation_length_count(const Anm2Animation* self)
+{
+	s32 count = std::max(_anm2_item_length_count(&self->rootAnimation, false), _anm2_item_length_count(&self->triggers, true));
 
 	for (const auto& [_, item] : self->layerAnimations)
-		accumulate_max_delay(item.frames);
+		count = std::max(count, _anm2_item_length_count(&item, false));
 
 	for (const auto& [_, item] : self->nullAnimations)
-		accumulate_max_delay(item.frames);
+		count = std::max(count, _anm2_item_length_count(&item, false));
 
-	for (const auto& frame : self->triggers.frames)
-		length = std::max(length, frame.atFrame + 1);
+	return count;
+}
+#endif
 
-	return length;
+// Cached per item and per animation; only items dirtied since the last call are counted again
+s32 anm2_animation_length_get(Anm2Animation* self)
+{
+	anm2_animation_materialize(self);
+
+	if (self->length == ANM2_LENGTH_NONE)
+	{
+		s32 length = std::max(_anm2_item_length_get(&self->rootAnimation, false), _anm2_item_length_get(&self->triggers, true));
+
+		for (auto& [_, item] : self->layerAnimations)
+			length = std::max(length, _anm2_item_length_get(&item, false));
+
+		for (auto& [_, item] : self->nullAnimations)
+			length = std::max(length, _anm2_item_length_get(&item, false));
+
+		self->length = length;
+	}
+
+#ifdef DEBUG
+	// Recounts from the frames, to catch an edit that didn't dirty the animation
+	s32 count = _anm2_animation_length_count(self);
+
+	if (count != self->length)
+	{
+		log_error(std::format(ANM2_LENGTH_ERROR, self->name, self->length, count));
+		anm2_animation_dirty_set(self);
+		self->length = count;
+	}
+#endif
+
+	return self->length;
 }
 
 void anm2_animation_length_set(Anm2Animation* self)
@@ -914,6 +1544,11 @@ Anm2Frame* anm2_frame_add(Anm2* self, Anm2Frame* frame, Anm2Reference* reference
 	if (!animation || !item) 
 		return nullptr;
 
+	// Checked against the trigger track before dirtying drops it
+	bool isTriggerAt = reference->itemType == ANM2_TRIGGERS && anm2_trigger_is_at(item, time);
+
+	anm2_animation_item_dirty_set(animation, item);
+
 	if (item)
 	{
 		Anm2Frame frameAdd = frame ? *frame : Anm2Frame{};
@@ -921,16 +1556,7 @@ Anm2Frame* anm2_frame_add(Anm2* self, Anm2Frame* frame, Anm2Reference* reference
 
 		if (reference->itemType == ANM2_TRIGGERS)
 		{
-			s32 index = time;
-			
-			for (auto& frameCheck : item->frames) 
-			{
-				if (frameCheck.atFrame == time)
-				{
-					index++;
-					break;	
-				}
-			}
+			s32 index = isTriggerAt ? time + 1 : time;
 
 			frameAdd.atFrame = index;
 			index = item->frames.size();
@@ -950,6 +1576,7 @@ void anm2_frame_erase(Anm2* self, Anm2Reference* reference)
 {
 	Anm2Item* item = anm2_item_from_reference(self, reference);
 	if (!item) return;
+	anm2_animation_item_dirty_set(anm2_animation_from_reference(self, reference), item);
 	item->frames.erase(item->frames.begin() + reference->frameIndex);
 }
 
@@ -979,6 +1606,8 @@ void anm2_item_frame_set(Anm2* self, Anm2Reference* reference, const Anm2FrameCh
 
     const s32 end = std::min(start + count, size);
 
+    anm2_animation_item_dirty_set(anm2_animation_from_reference(self, reference), item);
+
     for (s32 i = start; i < end; ++i)
     {
         Anm2Frame& dest = item->frames[i];
@@ -1030,6 +1659,8 @@ void anm2_item_frame_set(Anm2* self, Anm2Reference* reference, const Anm2FrameCh
 
 void anm2_animation_merge(Anm2* self, s32 animationID, const std::vector<s32>& mergeIDs, Anm2MergeType type)
 {
+	anm2_animation_materialize(&self->animations[animationID]);
+
 	Anm2Animation newAnimation = self->animations[animationID];
 
  	auto merge_item = [&](Anm2Item& destinationItem, const Anm2Item& sourceItem)
@@ -1057,6 +1688,8 @@ void anm2_animation_merge(Anm2* self, s32 animationID, const std::vector<s32>& m
     {
 		if (animationID == mergeID) continue;
 
+		anm2_animation_materialize(&self->animations[mergeID]);
+
         const Anm2Animation& mergeAnimation = self->animations[mergeID];
 
         merge_item(newAnimation.rootAnimation, mergeAnimation.rootAnimation);
@@ -1072,6 +1705,7 @@ void anm2_animation_merge(Anm2* self, s32 animationID, const std::vector<s32>& m
 	
 	self->animations[animationID] = newAnimation;
 
+	anm2_animation_dirty_set(&self->animations[animationID]);
 	anm2_animation_length_set(&self->animations[animationID]);
 }
 
@@ -1082,6 +1716,8 @@ void anm2_frame_bake(Anm2* self, Anm2Reference* reference, s32 interval, bool is
 
 	Anm2Frame* frame = anm2_frame_from_reference(self, reference);
 	if (!frame) return;
+
+	anm2_animation_item_dirty_set(anm2_animation_from_reference(self, reference), item);
 	
 	Anm2Reference referenceNext = *reference;
 	referenceNext.frameIndex = reference->frameIndex + 1;
@@ -1132,6 +1768,9 @@ void anm2_scale(Anm2* self, f32 scale)
 		frame.pivot = vec2((s32)(frame.pivot.x * scale), (s32)(frame.pivot.y * scale));
 	};
 
+	anm2_animations_materialize(self);
+	anm2_animations_dirty_set(self);
+
 	for (auto& [_, animation] : self->animations)
 	{
 		for (auto& frame : animation.rootAnimation.frames)
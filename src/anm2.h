@@ -11,10 +11,13 @@
 #define ANM2_FRAME_NUM_MIN 1
 #define ANM2_FRAME_NUM_MAX 1000000
 #define ANM2_FRAME_DELAY_MIN 1
+#define ANM2_LENGTH_NONE -1
 #define ANM2_STRING_MAX 0xFF
 
 #define ANM2_READ_ERROR "Failed to read anm2 from file: {}"
 #define ANM2_READ_INFO "Read anm2 from file: {}"
+#define ANM2_MATERIALIZE_ERROR "Failed to read animation \"{}\": {}"
+#define ANM2_LENGTH_ERROR "Animation \"{}\" cached length {} does not match its frames ({})"
 #define ANM2_WRITE_ERROR "Failed to write anm2 to file: {}"
 #define ANM2_WRITE_INFO "Wrote anm2 to file: {}"
 #define ANM2_CREATED_ON_FORMAT "%d-%B-%Y %I:%M:%S %p"
@@ -130,23 +133,31 @@ enum Anm2Type
 struct Anm2Spritesheet
 {
     std::string path{};
+
+    bool operator==(const Anm2Spritesheet&) const = default;
 };
 
 struct Anm2Layer
 {
     std::string name = "New Layer";
 	s32 spritesheetID = ID_NONE;
+
+    bool operator==(const Anm2Layer&) const = default;
 };
 
 struct Anm2Null
 {
     std::string name = "New Null";   
     bool isShowRect = false;
+
+    bool operator==(const Anm2Null&) const = default;
 };
 
 struct Anm2Event
 {
     std::string name = "New Event";
+
+    bool operator==(const Anm2Event&) const = default;
 };
 
 struct Anm2Frame
@@ -164,6 +175,7 @@ struct Anm2Frame
 	vec2 scale = {100, 100};
 	vec3 offsetRGB{};
 	vec4 tintRGBA = {1.0f, 1.0f, 1.0f, 1.0f};
+	bool operator==(const Anm2Frame&) const = default;
 };
 
 struct Anm2FrameChange
@@ -181,21 +193,83 @@ struct Anm2FrameChange
     std::optional<vec4> tintRGBA;
 };
 
+// Packed frames: a u32 header with a bit per field that differs from the previous frame (floats, then ints, then colors),
+// followed by a u32 of the same bits for fields too wide for s16 (or u8 colors) when ANM2_PACKED_WIDE is set, then the fields
+#define ANM2_PACKED_FLOAT_COUNT 11
+#define ANM2_PACKED_INT_COUNT 3
+#define ANM2_PACKED_COLOR_COUNT 7
+#define ANM2_PACKED_VISIBLE (1u << 21)
+#define ANM2_PACKED_INTERPOLATED (1u << 22)
+#define ANM2_PACKED_WIDE (1u << 23)
+
+#define ANM2_TRACK_VISIBLE (1 << 0)
+#define ANM2_TRACK_INTERPOLATED (1 << 1)
+
+// Structure-of-arrays copy of an item's frames, so sampling only pulls the fields it reads through the cache. A
+// derived view, not the storage: the frames stay the editable copy. Only what sampling reads is kept, so a delay is
+// the difference of two ends, and triggers' fields live in their own track
+struct Anm2Track
+{
+    std::vector<s32> delayEnds; // running total of delays; the time each frame ends at, for binary searches
+    std::vector<u8> flags; // ANM2_TRACK_*
+    std::vector<f32> rotations;
+    std::vector<vec2> positions;
+    std::vector<vec2> scales;
+    std::vector<vec2> pivots;
+    std::vector<vec2> crops;
+    std::vector<vec2> sizes;
+    std::vector<vec3> offsetRGBs;
+    std::vector<vec4> tintRGBAs;
+};
+
+static inline s32 anm2_track_delay_get(const Anm2Track* self, s32 index)
+{
+    return self->delayEnds[index] - (index > 0 ? self->delayEnds[index - 1] : 0);
+}
+
+// A triggers item's (atFrame, eventID) pairs sorted by time, for range queries during playback
+struct Anm2TriggerTrack
+{
+    std::vector<s32> atFrames; // ascending; triggers at the same frame keep their frame order
+    std::vector<s32> eventIDs;
+    std::vector<s32> indices; // into the item's frames
+};
+
+// Triggers [begin, end) of a trigger track
+struct Anm2TriggerRange
+{
+    const Anm2TriggerTrack* track = nullptr;
+    s32 begin = 0;
+    s32 end = 0;
+};
+
 struct Anm2Item
 {
     bool isVisible = true;
-	std::vector<Anm2Frame> frames;
+	CowVector<Anm2Frame> frames; // what edits go through; shared with copies until written; the track is rebuilt from it
+    std::shared_ptr<const Anm2Track> track{}; // built on first sample, dropped when the item is dirtied
+    std::shared_ptr<const Anm2TriggerTrack> triggerTrack{}; // triggers only; built on first query, dropped with the track
+    s32 length = ANM2_LENGTH_NONE; // furthest frame end (for triggers, last atFrame + 1); cached and dropped with the track
 };
 
+u64 anm2_revision_next(void);
+
 struct Anm2Animation
 {
 	s32 frameNum = ANM2_FRAME_NUM_MIN;
     std::string name = "New Animation";
 	bool isLoop = true;
     Anm2Item rootAnimation;
-    std::map<s32, Anm2Item> layerAnimations;
-    std::map<s32, Anm2Item> nullAnimations;
+    IdMap<Anm2Item> layerAnimations;
+    IdMap<Anm2Item> nullAnimations;
     Anm2Item triggers;
+    std::shared_ptr<const std::string> source{}; // lazily read; file the children are still unread in, null once materialized
+    std::string_view body{}; // the children's span of source, exactly as written
+    std::shared_ptr<const std::string> fragment{}; // children as last written; reused by saves until the animation is dirtied
+    u64 fragmentKey{}; // layer map hash the fragment was written under
+    s32 length = ANM2_LENGTH_NONE; // longest item length; cached until the animation is dirtied
+    std::shared_ptr<const std::vector<u8>> packed{}; // compact; the children's only copy while set, decoded on materialize
+    u64 revision = anm2_revision_next(); // unique per state of the children; copies share it, dirtying takes a new one
 };
 
 struct Anm2 
@@ -203,12 +277,12 @@ struct Anm2
     std::string path{};
     std::string createdBy = "robot";
     std::string createdOn{};
-	std::map<s32, Anm2Spritesheet> spritesheets; 
-	std::map<s32, Anm2Layer> layers; 
-	std::map<s32, Anm2Null> nulls; 
-    std::map<s32, Anm2Event> events;
-	std::map<s32, Anm2Animation> animations; 
-    std::map<s32, s32> layerMap; // index, id
+	IdMap<Anm2Spritesheet> spritesheets; 
+	IdMap<Anm2Layer> layers; 
+	IdMap<Anm2Null> nulls; 
+    IdMap<Anm2Event> events;
+	IdMap<Anm2Animation> animations; 
+    IdMap<s32> layerMap; // index, id
     s32 defaultAnimationID{};
     s32 fps = ANM2_FPS_DEFAULT;
 	s32 version{};
@@ -241,6 +315,97 @@ struct Anm2FrameWithReference
     Anm2Frame frame;
 };
 
+#define ANM2_POSE_LANES 4 // channel runs are padded to a multiple of this, so they're lerped in whole SIMD vectors
+
+// A pose's interpolated values; each is stored as a run of one float per track, so lerping them is one flat loop
+enum Anm2PoseChannel
+{
+    ANM2_POSE_ROTATION,
+    ANM2_POSE_POSITION_X,
+    ANM2_POSE_POSITION_Y,
+    ANM2_POSE_SCALE_X,
+    ANM2_POSE_SCALE_Y,
+    ANM2_POSE_OFFSET_R,
+    ANM2_POSE_OFFSET_G,
+    ANM2_POSE_OFFSET_B,
+    ANM2_POSE_TINT_R,
+    ANM2_POSE_TINT_G,
+    ANM2_POSE_TINT_B,
+    ANM2_POSE_TINT_A,
+    ANM2_POSE_CHANNEL_COUNT
+};
+
+// Every track of an animation sampled at one time; the root, then its layers in layer map order, then its nulls.
+// Reused between samples, so sampling every frame doesn't allocate
+struct Anm2Pose
+{
+    s32 count{};
+    s32 stride{}; // count, padded to ANM2_POSE_LANES
+    mat4 rootModel = mat4(1.0f); // what the other tracks' models are parented to; identity unless root transformed
+    std::vector<Anm2Type> types;
+    std::vector<s32> ids;
+    std::vector<bool> isVisibles; // item and frame both visible; layers and nulls also need a frame
+    std::vector<bool> isInterpolateds; // lerping toward the next key, so later times in the same frame lerp further
+    std::vector<s32> spritesheetIDs; // layers'; ID_NONE for the rest
+    std::vector<vec2> crops; // with sizes, the spritesheet texels UVs are taken from
+    std::vector<vec2> sizes;
+    std::vector<vec2> pivots;
+    std::vector<mat4> models; // each track's quad, parented to rootModel (but the root's own)
+    std::vector<f32> channels; // ANM2_POSE_CHANNEL_COUNT runs of stride
+    std::vector<f32> channelsNext; // the next keys' channels, while sampling
+    std::vector<f32> interpolations; // stride, while sampling; 0 holds the current key
+    std::vector<Anm2Item*> items; // while sampling
+};
+
+#define ANM2_POSE_CACHE_TRACK_FRAMES_MAX (1 << 17) // frames times tracks; longer or wider animations aren't cached
+
+// Poses of an animation at each of its integer frames, baked as they're first drawn; a time between two is lerped
+// from them. A track is rebaked once edited, which its item having a different Anm2Track from the one baked shows
+struct Anm2PoseCache
+{
+    s32 animationID = ID_NONE;
+    s32 frameNum{};
+    bool isRootTransform = false;
+    std::vector<Anm2Type> types; // the tracks baked; any change to them drops every frame
+    std::vector<s32> ids;
+    std::vector<std::shared_ptr<const Anm2Track>> tracks; // as baked; held, so a rebuilt one can't reuse the address
+    std::vector<Anm2Pose> frames; // results only
+    std::vector<bool> isBakeds; // per frame, per track
+    Anm2Pose bake; // tracks being baked
+};
+
+static inline f32 anm2_pose_channel_get(const Anm2Pose* self, Anm2PoseChannel channel, s32 index)
+{
+    return self->channels[channel * self->stride + index];
+}
+
+static inline f32 anm2_pose_rotation_get(const Anm2Pose* self, s32 index)
+{
+    return anm2_pose_channel_get(self, ANM2_POSE_ROTATION, index);
+}
+
+static inline vec2 anm2_pose_position_get(const Anm2Pose* self, s32 index)
+{
+    return {anm2_pose_channel_get(self, ANM2_POSE_POSITION_X, index), anm2_pose_channel_get(self, ANM2_POSE_POSITION_Y, index)};
+}
+
+static inline vec2 anm2_pose_scale_get(const Anm2Pose* self, s32 index)
+{
+    return {anm2_pose_channel_get(self, ANM2_POSE_SCALE_X, index), anm2_pose_channel_get(self, ANM2_POSE_SCALE_Y, index)};
+}
+
+static inline vec3 anm2_pose_offset_get(const Anm2Pose* self, s32 index)
+{
+    return {anm2_pose_channel_get(self, ANM2_POSE_OFFSET_R, index), anm2_pose_channel_get(self, ANM2_POSE_OFFSET_G, index),
+            anm2_pose_channel_get(self, ANM2_POSE_OFFSET_B, index)};
+}
+
+static inline vec4 anm2_pose_tint_get(const Anm2Pose* self, s32 index)
+{
+    return {anm2_pose_channel_get(self, ANM2_POSE_TINT_R, index), anm2_pose_channel_get(self, ANM2_POSE_TINT_G, index),
+            anm2_pose_channel_get(self, ANM2_POSE_TINT_B, index), anm2_pose_channel_get(self, ANM2_POSE_TINT_A, index)};
+}
+
 enum Anm2MergeType
 {
     ANM2_MERGE_APPEND_FRAMES,
@@ -256,17 +421,41 @@ enum Anm2ChangeType
     ANM2_CHANGE_SET
 };
 
+enum Anm2ReadType
+{
+    ANM2_READ_STREAM,
+    ANM2_READ_DOCUMENT,
+    ANM2_READ_CACHE, // stream, through the binary sidecar cache
+    ANM2_READ_LAZY // stream, with animation children read on first access
+};
+
 void anm2_layer_add(Anm2* self);
 void anm2_layer_remove(Anm2* self, s32 id);
 void anm2_null_add(Anm2* self);
 void anm2_null_remove(Anm2* self, s32 id);
+void anm2_null_swap(Anm2* self, s32 animationID, s32 id, s32 otherID);
 bool anm2_serialize(Anm2* self, const std::string& path);
-bool anm2_deserialize(Anm2* self, Resources* resources, const std::string& path);
+void anm2_serialize_prepare(Anm2* self, const std::string& path);
+bool anm2_serialize_write(Anm2* self, const std::string& path);
+bool anm2_deserialize(Anm2* self, Resources* resources, const std::string& path, Anm2ReadType type = ANM2_READ_STREAM);
 void anm2_new(Anm2* self);
 void anm2_created_on_set(Anm2* self);
 s32 anm2_animation_add(Anm2* self);
 void anm2_animation_remove(Anm2* self, s32 id);
 void anm2_spritesheet_texture_load(Anm2* self, Resources* resources, const std::string& path, s32 id);
+void anm2_animation_materialize(Anm2Animation* self);
+void anm2_animations_materialize(Anm2* self);
+void anm2_animation_compact(Anm2Animation* self);
+void anm2_animations_compact(Anm2* self);
+void anm2_animation_dirty_set(Anm2Animation* self);
+void anm2_item_dirty_set(Anm2Item* self);
+void anm2_animation_item_dirty_set(Anm2Animation* self, Anm2Item* item);
+const Anm2Track* anm2_item_track_get(Anm2Item* self);
+Anm2Frame anm2_track_frame_get(const Anm2Track* self, s32 index);
+const Anm2TriggerTrack* anm2_trigger_track_get(Anm2Item* self);
+Anm2TriggerRange anm2_trigger_range_get(Anm2Item* self, f32 start, f32 end);
+bool anm2_trigger_is_at(Anm2Item* self, s32 atFrame, s32 ignoreIndex = INDEX_NONE);
+void anm2_animations_dirty_set(Anm2* self);
 Anm2Animation* anm2_animation_from_reference(Anm2* self, Anm2Reference* reference);
 Anm2Item* anm2_item_from_reference(Anm2* self, Anm2Reference* reference);
 Anm2Frame* anm2_frame_from_reference(Anm2* self, Anm2Reference* reference);
@@ -274,6 +463,9 @@ s32 anm2_frame_index_from_time(Anm2* self, Anm2Reference reference, f32 time);
 Anm2Frame* anm2_frame_add(Anm2* self, Anm2Frame* frame, Anm2Reference* reference, s32 time = 0.0f);
 void anm2_frame_erase(Anm2* self, Anm2Reference* reference);
 void anm2_frame_from_time(Anm2* self, Anm2Frame* frame, Anm2Reference reference, f32 time);
+void anm2_pose_get(Anm2* self, Anm2Pose* pose, s32 animationID, f32 time, bool isRootTransform);
+void anm2_pose_cache_get(Anm2* self, Anm2PoseCache* cache, Anm2Pose* pose, s32 animationID, f32 time, bool isRootTransform);
+void anm2_pose_cache_clear(Anm2PoseCache* self);
 void anm2_reference_clear(Anm2Reference* self);
 void anm2_reference_item_clear(Anm2Reference* self);
 void anm2_reference_frame_clear(Anm2Reference* self);
@@ -0,0 +1,392 @@
+#include "anm2_cache.h"
+
+#include "anm2_writer.h"
+
+#if defined(_WIN32)
+  #define WIN32_LEAN_AND_MEAN
+  #define NOMINMAX
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+static_assert(std::is_trivially_copyable_v<Anm2Frame>, "Anm2Frame is stored in the cache as raw bytes");
+
+struct Anm2CacheMapping
+{
+    const u8* data = nullptr;
+    size_t size = 0;
+#if defined(_WIN32)
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#else
+    s32 file = -1;
+#endif
+};
+
+static bool _anm2_cache_map(Anm2CacheMapping* self, const std::string& path)
+{
+#if defined(_WIN32)
+	self->file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (self->file == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(self->file, &size) || size.QuadPart < (LONGLONG)sizeof(Anm2CacheHeader)) return false;
+	self->size = (size_t)size.QuadPart;
+
+	self->mapping = CreateFileMappingA(self->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!self->mapping) return false;
+
+	self->data = (const u8*)MapViewOfFile(self->mapping, FILE_MAP_READ, 0, 0, 0);
+	return self->data != nullptr;
+#else
+	self->file = open(path.c_str(), O_RDONLY);
+	if (self->file < 0) return false;
+
+	struct stat status;
+	if (fstat(self->file, &status) != 0 || status.st_size < (off_t)sizeof(Anm2CacheHeader)) return false;
+	self->size = (size_t)status.st_size;
+
+	void* data = mmap(nullptr, self->size, PROT_READ, MAP_PRIVATE, self->file, 0);
+	if (data == MAP_FAILED) return false;
+
+	self->data = (const u8*)data;
+	return true;
+#endif
+}
+
+static void _anm2_cache_unmap(Anm2CacheMapping* self)
+{
+#if defined(_WIN32)
+	if (self->data) UnmapViewOfFile(self->data);
+	if (self->mapping) CloseHandle(self->mapping);
+	if (self->file != INVALID_HANDLE_VALUE) CloseHandle(self->file);
+#else
+	if (self->data) munmap((void*)self->data, self->size);
+	if (self->file >= 0) close(self->file);
+#endif
+	*self = Anm2CacheMapping{};
+}
+
+static s64 _anm2_cache_source_time_get(const std::string& path)
+{
+	std::error_code errorCode;
+	auto time = std::filesystem::last_write_time(path, errorCode);
+	return errorCode ? 0 : (s64)time.time_since_epoch().count();
+}
+
+static std::string _anm2_cache_key_get(const std::string& path)
+{
+	std::error_code errorCode;
+	std::filesystem::path canonicalPath = std::filesystem::weakly_canonical(path, errorCode);
+	return errorCode ? path : canonicalPath.generic_string();
+}
+
+std::string anm2_cache_path_get(const std::string& path)
+{
+	return preferences_path_get() + ANM2_CACHE_DIRECTORY + "/" + std::format("{:016x}", hash_fnv1a(_anm2_cache_key_get(path))) + ANM2_CACHE_EXTENSION;
+}
+
+bool anm2_cache_exists(const std::string& path)
+{
+	return path_exists(anm2_cache_path_get(path));
+}
+
+/* Reading */
+
+static bool _anm2_cache_range_valid(const Anm2CacheMapping* mapping, Anm2CacheRange range, size_t stride)
+{
+	return range.offset % ANM2_CACHE_ALIGNMENT == 0 && (u64)range.offset + (u64)range.count * stride <= mapping->size;
+}
+
+static bool _anm2_cache_string_get(const Anm2CacheMapping* mapping, Anm2CacheString string, std::string* out)
+{
+	if ((u64)string.offset + string.length > mapping->size) return false;
+	out->assign((const char*)mapping->data + string.offset, string.length);
+	return true;
+}
+
+template <typename T>
+static const T* _anm2_cache_table_get(const Anm2CacheMapping* mapping, Anm2CacheRange range)
+{
+	if (!_anm2_cache_range_valid(mapping, range, sizeof(T))) return nullptr;
+	return (const T*)(mapping->data + range.offset);
+}
+
+static bool _anm2_cache_image_read(Anm2* self, const Anm2CacheMapping* mapping, const Anm2CacheHeader* header)
+{
+	const Anm2CacheSpritesheet* spritesheets = _anm2_cache_table_get<Anm2CacheSpritesheet>(mapping, header->spritesheets);
+	const Anm2CacheLayer* layers = _anm2_cache_table_get<Anm2CacheLayer>(mapping, header->layers);
+	const Anm2CacheNull* nulls = _anm2_cache_table_get<Anm2CacheNull>(mapping, header->nulls);
+	const Anm2CacheEvent* events = _anm2_cache_table_get<Anm2CacheEvent>(mapping, header->events);
+	const Anm2CacheLayerMap* layerMap = _anm2_cache_table_get<Anm2CacheLayerMap>(mapping, header->layerMap);
+	const Anm2CacheAnimation* animations = _anm2_cache_table_get<Anm2CacheAnimation>(mapping, header->animations);
+	const Anm2CacheItem* items = _anm2_cache_table_get<Anm2CacheItem>(mapping, header->items);
+	const Anm2Frame* frames = _anm2_cache_table_get<Anm2Frame>(mapping, header->frames);
+
+	if (!spritesheets || !layers || !nulls || !events || !layerMap || !animations || !items || !frames)
+		return false;
+
+	if (!_anm2_cache_string_get(mapping, header->createdBy, &self->createdBy)) return false;
+	if (!_anm2_cache_string_get(mapping, header->createdOn, &self->createdOn)) return false;
+	self->version = header->anm2Version;
+	self->fps = header->fps;
+	self->defaultAnimationID = header->defaultAnimationID;
+
+	for (u32 i = 0; i < header->spritesheets.count; i++)
+		if (!_anm2_cache_string_get(mapping, spritesheets[i].path, &self->spritesheets[spritesheets[i].id].path)) return false;
+
+	for (u32 i = 0; i < header->layers.count; i++)
+	{
+		Anm2Layer& layer = self->layers[layers[i].id];
+		layer.spritesheetID = layers[i].spritesheetID;
+		if (!_anm2_cache_string_get(mapping, layers[i].name, &layer.name)) return false;
+	}
+
+	for (u32 i = 0; i < header->nulls.count; i++)
+	{
+		Anm2Null& null = self->nulls[nulls[i].id];
+		null.isShowRect = nulls[i].isShowRect;
+		if (!_anm2_cache_string_get(mapping, nulls[i].name, &null.name)) return false;
+	}
+
+	for (u32 i = 0; i < header->events.count; i++)
+		if (!_anm2_cache_string_get(mapping, events[i].name, &self->events[events[i].id].name)) return false;
+
+	for (u32 i = 0; i < header->layerMap.count; i++)
+		self->layerMap[layerMap[i].index] = layerMap[i].id;
+
+	for (u32 i = 0; i < header->animations.count; i++)
+	{
+		const Anm2CacheAnimation& animationImage = animations[i];
+		Anm2Animation& animation = self->animations[animationImage.id];
+
+		animation.frameNum = animationImage.frameNum;
+		animation.isLoop = animationImage.isLoop;
+		if (!_anm2_cache_string_get(mapping, animationImage.name, &animation.name)) return false;
+
+		if ((u64)animationImage.items.offset + animationImage.items.count > header->items.count) return false;
+
+		for (u32 j = 0; j < animationImage.items.count; j++)
+		{
+			const Anm2CacheItem& itemImage = items[animationImage.items.offset + j];
+			Anm2Item* item = nullptr;
+
+			switch (itemImage.type)
+			{
+				case ANM2_ROOT: item = &animation.rootAnimation; break;
+				case ANM2_TRIGGERS: item = &animation.triggers; break;
+				case ANM2_LAYER: item = &animation.layerAnimations[itemImage.id]; break;
+				case ANM2_NULL: item = &animation.nullAnimations[itemImage.id]; break;
+				default: return false;
+			}
+
+			if ((u64)itemImage.frames.offset + itemImage.frames.count > header->frames.count) return false;
+
+			item->isVisible = itemImage.isVisible;
+			item->frames.assign(frames + itemImage.frames.offset, frames + itemImage.frames.offset + itemImage.frames.count);
+		}
+	}
+
+	return true;
+}
+
+bool anm2_cache_read(Anm2* self, const std::string& path, const std::string& data)
+{
+	Anm2CacheMapping mapping;
+	std::string cachePath = anm2_cache_path_get(path);
+	std::string sourcePath;
+
+	if (!path_exists(cachePath)) return false;
+
+	if (!_anm2_cache_map(&mapping, cachePath))
+	{
+		_anm2_cache_unmap(&mapping);
+		return false;
+	}
+
+	Anm2CacheHeader header;
+	memcpy(&header, mapping.data, sizeof(header));
+
+	bool isValid =
+		memcmp(header.magic, ANM2_CACHE_MAGIC, sizeof(header.magic)) == 0 &&
+		header.version == ANM2_CACHE_VERSION &&
+		header.frameSize == sizeof(Anm2Frame) &&
+		header.size == mapping.size &&
+		header.sourceSize == data.size() &&
+		header.sourceTime == _anm2_cache_source_time_get(path) &&
+		_anm2_cache_string_get(&mapping, header.sourcePath, &sourcePath) &&
+		sourcePath == _anm2_cache_key_get(path) &&
+		header.sourceHash == hash_fnv1a(data) &&
+		header.bodyHash == hash_fnv1a(std::string_view((const char*)mapping.data + sizeof(header), mapping.size - sizeof(header)));
+
+	if (isValid)
+	{
+		Anm2 cached;
+		isValid = _anm2_cache_image_read(&cached, &mapping, &header);
+
+		if (isValid)
+		{
+			cached.path = self->path;
+			*self = std::move(cached);
+		}
+	}
+
+	_anm2_cache_unmap(&mapping);
+
+	if (isValid)
+		log_info(std::format(ANM2_CACHE_READ_INFO, cachePath));
+
+	return isValid;
+}
+
+/* Writing */
+
+struct Anm2CacheImage
+{
+	std::string body;
+	std::string strings;
+};
+
+template <typename T>
+static Anm2CacheRange _anm2_cache_table_append(std::string* body, const T* data, size_t count)
+{
+	while (body->size() % ANM2_CACHE_ALIGNMENT) body->push_back('\0');
+
+	Anm2CacheRange range = {(u32)(sizeof(Anm2CacheHeader) + body->size()), (u32)count};
+	body->append((const char*)data, count * sizeof(T));
+	return range;
+}
+
+static Anm2CacheString _anm2_cache_string_add(Anm2CacheImage* self, const std::string& string)
+{
+	Anm2CacheString result = {(u32)self->strings.size(), (u32)string.size()};
+	self->strings.append(string);
+	return result;
+}
+
+bool anm2_cache_write(Anm2* self, const std::string& path, const std::string& data)
+{
+	Anm2CacheImage image;
+	Anm2CacheHeader header{};
+	std::vector<Anm2CacheSpritesheet> spritesheets;
+	std::vector<Anm2CacheLayer> layers;
+	std::vector<Anm2CacheNull> nulls;
+	std::vector<Anm2CacheEvent> events;
+	std::vector<Anm2CacheLayerMap> layerMap;
+	std::vector<Anm2CacheAnimation> animations;
+	std::vector<Anm2CacheItem> items;
+	std::vector<Anm2Frame> frames;
+	std::string cachePath = anm2_cache_path_get(path);
+
+	// Unread animations have no frames to image; a stale entry fails validation on the next read anyway
+	for (auto& [_, animation] : self->animations)
+		if (animation.source) return false;
+
+	// String offsets are relative to the pool until the pool's final position is known
+	header.sourcePath = _anm2_cache_string_add(&image, _anm2_cache_key_get(path));
+	header.createdBy = _anm2_cache_string_add(&image, self->createdBy);
+	header.createdOn = _anm2_cache_string_add(&image, self->createdOn);
+
+	for (auto& [id, spritesheet] : self->spritesheets)
+		spritesheets.push_back({id, _anm2_cache_string_add(&image, spritesheet.path)});
+	for (auto& [id, layer] : self->layers)
+		layers.push_back({id, layer.spritesheetID, _anm2_cache_string_add(&image, layer.name)});
+	for (auto& [id, null] : self->nulls)
+		nulls.push_back({id, null.isShowRect, _anm2_cache_string_add(&image, null.name)});
+	for (auto& [id, event] : self->events)
+		events.push_back({id, _anm2_cache_string_add(&image, event.name)});
+	for (auto& [index, id] : self->layerMap)
+		layerMap.push_back({index, id});
+
+	auto item_add = [&](const Anm2Item& item, Anm2Type type, s32 id)
+	{
+		items.push_back({type, id, item.isVisible, {(u32)frames.size(), (u32)item.frames.size()}});
+		frames.insert(frames.end(), item.frames.begin(), item.frames.end());
+	};
+
+	for (auto& [id, entry] : self->animations)
+	{
+		u32 itemOffset = (u32)items.size();
+		Anm2Animation unpacked;
+		const Anm2Animation& animation = entry.packed ? unpacked : entry;
+
+		// Packed animations are imaged from a decoded copy, so they stay packed
+		if (entry.packed)
+		{
+			unpacked = entry;
+			anm2_animation_materialize(&unpacked);
+		}
+
+		item_add(animation.rootAnimation, ANM2_ROOT, ID_NONE);
+		item_add(animation.triggers, ANM2_TRIGGERS, ID_NONE);
+		for (auto& [layerID, item] : animation.layerAnimations)
+			item_add(item, ANM2_LAYER, layerID);
+		for (auto& [nullID, item] : animation.nullAnimations)
+			item_add(item, ANM2_NULL, nullID);
+
+		animations.push_back({id, animation.frameNum, animation.isLoop, _anm2_cache_string_add(&image, animation.name), {itemOffset, (u32)items.size() - itemOffset}});
+	}
+
+	header.spritesheets = _anm2_cache_table_append(&image.body, spritesheets.data(), spritesheets.size());
+	header.layers = _anm2_cache_table_append(&image.body, layers.data(), layers.size());
+	header.nulls = _anm2_cache_table_append(&image.body, nulls.data(), nulls.size());
+	header.events = _anm2_cache_table_append(&image.body, events.data(), events.size());
+	header.layerMap = _anm2_cache_table_append(&image.body, layerMap.data(), layerMap.size());
+	header.animations = _anm2_cache_table_append(&image.body, animations.data(), animations.size());
+	header.items = _anm2_cache_table_append(&image.body, items.data(), items.size());
+	header.frames = _anm2_cache_table_append(&image.body, frames.data(), frames.size());
+
+	// Fix up string offsets to be relative to the start of the file
+	u32 stringsOffset = (u32)(sizeof(Anm2CacheHeader) + image.body.size());
+	auto string_fix = [&](Anm2CacheString& string) { string.offset += stringsOffset; };
+
+	string_fix(header.sourcePath);
+	string_fix(header.createdBy);
+	string_fix(header.createdOn);
+
+	auto table_fix = [&]<typename T>(Anm2CacheRange range, std::vector<T>& table)
+	{
+		for (auto& entry : table)
+		{
+			if constexpr (std::is_same_v<T, Anm2CacheSpritesheet>) string_fix(entry.path);
+			else string_fix(entry.name);
+		}
+		memcpy(image.body.data() + range.offset - sizeof(Anm2CacheHeader), table.data(), table.size() * sizeof(T));
+	};
+
+	table_fix(header.spritesheets, spritesheets);
+	table_fix(header.layers, layers);
+	table_fix(header.nulls, nulls);
+	table_fix(header.events, events);
+	table_fix(header.animations, animations);
+
+	image.body.append(image.strings);
+
+	memcpy(header.magic, ANM2_CACHE_MAGIC, sizeof(header.magic));
+	header.version = ANM2_CACHE_VERSION;
+	header.frameSize = sizeof(Anm2Frame);
+	header.size = sizeof(Anm2CacheHeader) + image.body.size();
+	header.bodyHash = hash_fnv1a(image.body);
+	header.sourceSize = data.size();
+	header.sourceTime = _anm2_cache_source_time_get(path);
+	header.sourceHash = hash_fnv1a(data);
+	header.anm2Version = self->version;
+	header.fps = self->fps;
+	header.defaultAnimationID = self->defaultAnimationID;
+
+	std::string buffer((const char*)&header, sizeof(header));
+	buffer.append(image.body);
+
+	std::error_code errorCode;
+	std::filesystem::create_directories(std::filesystem::path(cachePath).parent_path(), errorCode);
+
+	if (!anm2_writer_file_write(cachePath, buffer))
+		return false;
+
+	log_info(std::format(ANM2_CACHE_WRITE_INFO, cachePath));
+	return true;
+}
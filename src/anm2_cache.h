@@ -0,0 +1,107 @@
+// Binary sidecar cache; a flat, position-independent image of an Anm2 stored in the preferences directory,
+// keyed by the source file's path, size, modification time and content hash
+
+#pragma once
+
+#include "anm2.h"
+
+#define ANM2_CACHE_MAGIC "ANM2C\0\0"
+#define ANM2_CACHE_VERSION 1
+#define ANM2_CACHE_ALIGNMENT 8
+#define ANM2_CACHE_DIRECTORY "cache"
+#define ANM2_CACHE_EXTENSION ".anm2c"
+#define ANM2_CACHE_READ_INFO "Read anm2 cache: {}"
+#define ANM2_CACHE_WRITE_INFO "Wrote anm2 cache: {}"
+
+struct Anm2CacheString
+{
+    u32 offset;
+    u32 length;
+};
+
+struct Anm2CacheRange
+{
+    u32 offset;
+    u32 count;
+};
+
+struct Anm2CacheHeader
+{
+    char magic[8];
+    u32 version;
+    u32 frameSize;
+    u64 size;
+    u64 bodyHash;
+    u64 sourceSize;
+    s64 sourceTime;
+    u64 sourceHash;
+    Anm2CacheString sourcePath;
+    Anm2CacheString createdBy;
+    Anm2CacheString createdOn;
+    s32 anm2Version;
+    s32 fps;
+    s32 defaultAnimationID;
+    Anm2CacheRange spritesheets;
+    Anm2CacheRange layers;
+    Anm2CacheRange nulls;
+    Anm2CacheRange events;
+    Anm2CacheRange layerMap;
+    Anm2CacheRange animations;
+    Anm2CacheRange items;
+    Anm2CacheRange frames;
+};
+
+struct Anm2CacheSpritesheet
+{
+    s32 id;
+    Anm2CacheString path;
+};
+
+struct Anm2CacheLayer
+{
+    s32 id;
+    s32 spritesheetID;
+    Anm2CacheString name;
+};
+
+struct Anm2CacheNull
+{
+    s32 id;
+    u32 isShowRect;
+    Anm2CacheString name;
+};
+
+struct Anm2CacheEvent
+{
+    s32 id;
+    Anm2CacheString name;
+};
+
+struct Anm2CacheLayerMap
+{
+    s32 index;
+    s32 id;
+};
+
+// Items of an animation are stored root, triggers, then layers and nulls in id order
+struct Anm2CacheAnimation
+{
+    s32 id;
+    s32 frameNum;
+    u32 isLoop;
+    Anm2CacheString name;
+    Anm2CacheRange items;
+};
+
+struct Anm2CacheItem
+{
+    s32 type;
+    s32 id;
+    u32 isVisible;
+    Anm2CacheRange frames;
+};
+
+std::string anm2_cache_path_get(const std::string& path);
+bool anm2_cache_exists(const std::string& path);
+bool anm2_cache_read(Anm2* self, const std::string& path, const std::string& data);
+bool anm2_cache_write(Anm2* self, const std::string& path, const std::string& data);
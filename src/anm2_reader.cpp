@@ -0,0 +1,839 @@
+#include "anm2_reader.h"
+
+// Element/attribute names resolve through a switch on a compile-time hash of the X-macro strings;
+// a duplicate hash fails to compile, and the final compare guards against unknown names that collide
+Anm2Element anm2_element_from_name(std::string_view name)
+{
+	Anm2Element element = ANM2_ELEMENT_COUNT;
+
+	switch (hash_fnv1a(name))
+	{
+		#define X(symbol, string) case hash_fnv1a(string): element = ANM2_ELEMENT_##symbol; break;
+		ANM2_ELEMENT_LIST
+		#undef X
+		default:
+			return ANM2_ELEMENT_COUNT;
+	}
+
+	return name == ANM2_ELEMENT_STRINGS[element] ? element : ANM2_ELEMENT_COUNT;
+}
+
+Anm2Attribute anm2_attribute_from_name(std::string_view name)
+{
+	Anm2Attribute attribute = ANM2_ATTRIBUTE_COUNT;
+
+	switch (hash_fnv1a(name))
+	{
+		#define X(symbol, string) case hash_fnv1a(string): attribute = ANM2_ATTRIBUTE_##symbol; break;
+		ANM2_ATTRIBUTE_LIST
+		#undef X
+		default:
+			return ANM2_ATTRIBUTE_COUNT;
+	}
+
+	return name == ANM2_ATTRIBUTE_STRINGS[attribute] ? attribute : ANM2_ATTRIBUTE_COUNT;
+}
+
+static inline bool _anm2_reader_is_space(char character)
+{
+	return character == ' ' || character == '\t' || character == '\n' || character == '\r';
+}
+
+static inline bool _anm2_reader_is_name_end(char character)
+{
+	return _anm2_reader_is_space(character) || character == '/' || character == '>' || character == '=';
+}
+
+static Anm2ReaderToken _anm2_reader_error(Anm2Reader* self, const char* error)
+{
+	self->error = error;
+	self->token = ANM2_READER_TOKEN_ERROR;
+	return self->token;
+}
+
+static bool _anm2_reader_skip_past(Anm2Reader* self, std::string_view terminator)
+{
+	std::string_view remaining(self->cursor, self->end - self->cursor);
+	size_t position = remaining.find(terminator);
+
+	if (position == std::string_view::npos) return false;
+
+	self->cursor += position + terminator.size();
+	return true;
+}
+
+// Moves the cursor to the next element or closing tag, skipping text, declarations, comments, CDATA and doctypes;
+// NONE when one was found
+static Anm2ReaderToken _anm2_reader_markup_find(Anm2Reader* self)
+{
+	while (true)
+	{
+		// Text content carries nothing in anm2; skip straight to the next markup
+		const char* markup = (const char*)memchr(self->cursor, '<', self->end - self->cursor);
+
+		if (!markup)
+		{
+			self->cursor = self->end;
+			self->tokenBegin = self->end;
+
+			if (self->depth > 0)
+				return _anm2_reader_error(self, ANM2_READER_ERROR_UNCLOSED);
+
+			self->token = ANM2_READER_TOKEN_END;
+			return self->token;
+		}
+
+		self->cursor = markup;
+		self->tokenBegin = markup;
+
+		std::string_view remaining(self->cursor, self->end - self->cursor);
+
+		if (remaining.starts_with("<?"))
+		{
+			if (!_anm2_reader_skip_past(self, "?>")) return _anm2_reader_error(self, ANM2_READER_ERROR_UNTERMINATED);
+			continue;
+		}
+		if (remaining.starts_with("<!--"))
+		{
+			if (!_anm2_reader_skip_past(self, "-->")) return _anm2_reader_error(self, ANM2_READER_ERROR_UNTERMINATED);
+			continue;
+		}
+		if (remaining.starts_with("<![CDATA["))
+		{
+			if (!_anm2_reader_skip_past(self, "]]>")) return _anm2_reader_error(self, ANM2_READER_ERROR_UNTERMINATED);
+			continue;
+		}
+		if (remaining.starts_with("<!"))
+		{
+			if (!_anm2_reader_skip_past(self, ">")) return _anm2_reader_error(self, ANM2_READER_ERROR_UNTERMINATED);
+			continue;
+		}
+
+		return ANM2_READER_TOKEN_NONE;
+	}
+}
+
+void anm2_reader_init(Anm2Reader* self, const char* data, size_t size)
+{
+	*self = Anm2Reader{};
+	self->begin = data;
+	self->cursor = data;
+	self->end = data + size;
+}
+
+Anm2ReaderToken anm2_reader_next(Anm2Reader* self)
+{
+	if (self->token == ANM2_READER_TOKEN_ERROR || self->token == ANM2_READER_TOKEN_END)
+		return self->token;
+
+	self->attributeCount = 0;
+	self->isEmpty = false;
+
+	Anm2ReaderToken markup = _anm2_reader_markup_find(self);
+	if (markup != ANM2_READER_TOKEN_NONE) return markup;
+
+	self->cursor++;
+
+	bool isClose = self->cursor < self->end && *self->cursor == '/';
+	if (isClose) self->cursor++;
+
+	const char* nameBegin = self->cursor;
+	while (self->cursor < self->end && !_anm2_reader_is_name_end(*self->cursor))
+		self->cursor++;
+
+	std::string_view name(nameBegin, self->cursor - nameBegin);
+
+	if (name.empty() || self->cursor >= self->end)
+		return _anm2_reader_error(self, ANM2_READER_ERROR_ELEMENT);
+
+	self->element = anm2_element_from_name(name);
+
+	if (isClose)
+	{
+		while (self->cursor < self->end && _anm2_reader_is_space(*self->cursor))
+			self->cursor++;
+
+		if (self->cursor >= self->end || *self->cursor != '>')
+			return _anm2_reader_error(self, ANM2_READER_ERROR_ELEMENT);
+
+		self->cursor++;
+
+		if (self->depth <= 0 || self->stack[self->depth - 1] != name)
+			return _anm2_reader_error(self, ANM2_READER_ERROR_MISMATCH);
+
+		self->depth--;
+		self->token = ANM2_READER_TOKEN_CLOSE;
+		return self->token;
+	}
+
+	// Attributes
+	while (true)
+	{
+		while (self->cursor < self->end && _anm2_reader_is_space(*self->cursor))
+			self->cursor++;
+
+		if (self->cursor >= self->end)
+			return _anm2_reader_error(self, ANM2_READER_ERROR_UNTERMINATED);
+
+		if (*self->cursor == '>')
+		{
+			self->cursor++;
+			break;
+		}
+
+		if (*self->cursor == '/')
+		{
+			if (self->cursor + 1 >= self->end || self->cursor[1] != '>')
+				return _anm2_reader_error(self, ANM2_READER_ERROR_ELEMENT);
+
+			self->cursor += 2;
+			self->isEmpty = true;
+			break;
+		}
+
+		const char* attributeBegin = self->cursor;
+		while (self->cursor < self->end && !_anm2_reader_is_name_end(*self->cursor))
+			self->cursor++;
+
+		std::string_view attributeName(attributeBegin, self->cursor - attributeBegin);
+
+		while (self->cursor < self->end && _anm2_reader_is_space(*self->cursor))
+			self->cursor++;
+
+		if (attributeName.empty() || self->cursor >= self->end || *self->cursor != '=')
+			return _anm2_reader_error(self, ANM2_READER_ERROR_ATTRIBUTE);
+
+		self->cursor++;
+
+		while (self->cursor < self->end && _anm2_reader_is_space(*self->cursor))
+			self->cursor++;
+
+		if (self->cursor >= self->end || (*self->cursor != '"' && *self->cursor != '\''))
+			return _anm2_reader_error(self, ANM2_READER_ERROR_ATTRIBUTE);
+
+		char quote = *self->cursor++;
+		const char* valueBegin = self->cursor;
+		const char* valueEnd = (const char*)memchr(self->cursor, quote, self->end - self->cursor);
+
+		if (!valueEnd)
+			return _anm2_reader_error(self, ANM2_READER_ERROR_UNTERMINATED);
+
+		self->cursor = valueEnd + 1;
+
+		if (self->attributeCount >= ANM2_READER_ATTRIBUTE_MAX)
+			return _anm2_reader_error(self, ANM2_READER_ERROR_ATTRIBUTE_MAX);
+
+		Anm2ReaderAttribute& attribute = self->attributes[self->attributeCount++];
+		attribute.type = anm2_attribute_from_name(attributeName);
+		attribute.value = std::string_view(valueBegin, valueEnd - valueBegin);
+	}
+
+	if (!self->isEmpty)
+	{
+		if (self->depth >= ANM2_READER_DEPTH_MAX)
+			return _anm2_reader_error(self, ANM2_READER_ERROR_DEPTH);
+
+		self->stack[self->depth++] = name;
+	}
+
+	self->token = ANM2_READER_TOKEN_OPEN;
+	return self->token;
+}
+
+// Jumps past the rest of the element just opened without tokenizing its attributes or children; only tag
+// boundaries and nesting are tracked, so a subtree skipped here should still be fully read later to be validated
+Anm2ReaderToken anm2_reader_skip(Anm2Reader* self)
+{
+	if (self->token != ANM2_READER_TOKEN_OPEN || self->isEmpty)
+		return self->token;
+
+	s32 depth = 1;
+
+	while (depth > 0)
+	{
+		Anm2ReaderToken markup = _anm2_reader_markup_find(self);
+		if (markup != ANM2_READER_TOKEN_NONE) return markup;
+
+		bool isClose = self->cursor + 1 < self->end && self->cursor[1] == '/';
+		char quote = '\0';
+		const char* tagEnd = self->cursor + 1;
+
+		// '>' may appear unescaped inside attribute values
+		for (; tagEnd < self->end; tagEnd++)
+		{
+			if (quote)
+			{
+				if (*tagEnd == quote) quote = '\0';
+			}
+			else if (*tagEnd == '"' || *tagEnd == '\'')
+				quote = *tagEnd;
+			else if (*tagEnd == '>')
+				break;
+		}
+
+		if (tagEnd >= self->end)
+			return _anm2_reader_error(self, ANM2_READER_ERROR_UNTERMINATED);
+
+		if (isClose)
+			depth--;
+		else if (tagEnd[-1] != '/')
+			depth++;
+
+		self->cursor = tagEnd + 1;
+	}
+
+	self->depth--;
+	self->element = anm2_element_from_name(self->stack[self->depth]);
+	self->attributeCount = 0;
+	self->token = ANM2_READER_TOKEN_CLOSE;
+	return self->token;
+}
+
+std::string anm2_reader_error_get(Anm2Reader* self)
+{
+	return std::format(ANM2_READER_ERROR_FORMAT, self->error ? self->error : "", self->tokenBegin - self->begin);
+}
+
+static inline s32 _anm2_reader_int(std::string_view value)
+{
+	s32 result = 0;
+
+	while (!value.empty() && (_anm2_reader_is_space(value.front()) || value.front() == '+'))
+		value.remove_prefix(1);
+
+	std::from_chars(value.data(), value.data() + value.size(), result);
+	return result;
+}
+
+static inline f32 _anm2_reader_float(std::string_view value)
+{
+	// Parse as double and narrow, so values round the same way std::atof did
+	f64 result = 0.0;
+
+	while (!value.empty() && (_anm2_reader_is_space(value.front()) || value.front() == '+'))
+		value.remove_prefix(1);
+
+	std::from_chars(value.data(), value.data() + value.size(), result);
+	return (f32)result;
+}
+
+static inline bool _anm2_reader_bool(std::string_view value)
+{
+	if (value == "1") return true;
+	if (value.size() != 4) return false;
+
+	for (s32 i = 0; i < 4; i++)
+		if (std::tolower((u8)value[i]) != "true"[i])
+			return false;
+
+	return true;
+}
+
+static void _anm2_reader_string_set(std::string* string, std::string_view value)
+{
+	string->clear();
+
+	if (value.find_first_of("&\r") == std::string_view::npos)
+	{
+		string->assign(value);
+		return;
+	}
+
+	string->reserve(value.size());
+
+	for (size_t i = 0; i < value.size(); i++)
+	{
+		char character = value[i];
+
+		if (character == '\r')
+		{
+			if (i + 1 < value.size() && value[i + 1] == '\n') i++;
+			string->push_back('\n');
+			continue;
+		}
+
+		if (character != '&')
+		{
+			string->push_back(character);
+			continue;
+		}
+
+		size_t semicolon = value.find(';', i);
+
+		if (semicolon == std::string_view::npos)
+		{
+			string->push_back(character);
+			continue;
+		}
+
+		std::string_view entity = value.substr(i + 1, semicolon - i - 1);
+
+		if (entity == "amp") string->push_back('&');
+		else if (entity == "lt") string->push_back('<');
+		else if (entity == "gt") string->push_back('>');
+		else if (entity == "quot") string->push_back('"');
+		else if (entity == "apos") string->push_back('\'');
+		else if (entity.size() > 1 && entity[0] == '#')
+		{
+			u32 codepoint = 0;
+			bool isHex = entity[1] == 'x' || entity[1] == 'X';
+			const char* digits = entity.data() + (isHex ? 2 : 1);
+			std::from_chars(digits, entity.data() + entity.size(), codepoint, isHex ? 16 : 10);
+
+			if (codepoint < 0x80)
+				string->push_back((char)codepoint);
+			else if (codepoint < 0x800)
+			{
+				string->push_back((char)(0xC0 | (codepoint >> 6)));
+				string->push_back((char)(0x80 | (codepoint & 0x3F)));
+			}
+			else if (codepoint < 0x10000)
+			{
+				string->push_back((char)(0xE0 | (codepoint >> 12)));
+				string->push_back((char)(0x80 | ((codepoint >> 6) & 0x3F)));
+				string->push_back((char)(0x80 | (codepoint & 0x3F)));
+			}
+			else
+			{
+				string->push_back((char)(0xF0 | (codepoint >> 18)));
+				string->push_back((char)(0x80 | ((codepoint >> 12) & 0x3F)));
+				string->push_back((char)(0x80 | ((codepoint >> 6) & 0x3F)));
+				string->push_back((char)(0x80 | (codepoint & 0x3F)));
+			}
+		}
+		else
+		{
+			string->push_back(character);
+			continue;
+		}
+
+		i = semicolon;
+	}
+}
+
+static void _anm2_reader_frame_set(Anm2Reader* self, Anm2Frame* frame)
+{
+	for (s32 i = 0; i < self->attributeCount; i++)
+	{
+		std::string_view value = self->attributes[i].value;
+
+		switch (self->attributes[i].type)
+		{
+			case ANM2_ATTRIBUTE_X_POSITION: frame->position.x = _anm2_reader_float(value); break;
+			case ANM2_ATTRIBUTE_Y_POSITION: frame->position.y = _anm2_reader_float(value); break;
+			case ANM2_ATTRIBUTE_X_PIVOT: frame->pivot.x = _anm2_reader_float(value); break;
+			case ANM2_ATTRIBUTE_Y_PIVOT: frame->pivot.y = _anm2_reader_float(value); break;
+			case ANM2_ATTRIBUTE_X_CROP: frame->crop.x = _anm2_reader_float(value); break;
+			case ANM2_ATTRIBUTE_Y_CROP: frame->crop.y = _anm2_reader_float(value); break;
+			case ANM2_ATTRIBUTE_WIDTH: frame->size.x = _anm2_reader_float(value); break;
+			case ANM2_ATTRIBUTE_HEIGHT: frame->size.y = _anm2_reader_float(value); break;
+			case ANM2_ATTRIBUTE_X_SCALE: frame->scale.x = _anm2_reader_float(value); break;
+			case ANM2_ATTRIBUTE_Y_SCALE: frame->scale.y = _anm2_reader_float(value); break;
+			case ANM2_ATTRIBUTE_DELAY: frame->delay = _anm2_reader_int(value); break;
+			case ANM2_ATTRIBUTE_VISIBLE: frame->isVisible = _anm2_reader_bool(value); break;
+			case ANM2_ATTRIBUTE_RED_TINT: frame->tintRGBA.r = U8_TO_FLOAT(_anm2_reader_int(value)); break;
+			case ANM2_ATTRIBUTE_GREEN_TINT: frame->tintRGBA.g = U8_TO_FLOAT(_anm2_reader_int(value)); break;
+			case ANM2_ATTRIBUTE_BLUE_TINT: frame->tintRGBA.b = U8_TO_FLOAT(_anm2_reader_int(value)); break;
+			case ANM2_ATTRIBUTE_ALPHA_TINT: frame->tintRGBA.a = U8_TO_FLOAT(_anm2_reader_int(value)); break;
+			case ANM2_ATTRIBUTE_RED_OFFSET: frame->offsetRGB.r = U8_TO_FLOAT(_anm2_reader_int(value)); break;
+			case ANM2_ATTRIBUTE_GREEN_OFFSET: frame->offsetRGB.g = U8_TO_FLOAT(_anm2_reader_int(value)); break;
+			case ANM2_ATTRIBUTE_BLUE_OFFSET: frame->offsetRGB.b = U8_TO_FLOAT(_anm2_reader_int(value)); break;
+			case ANM2_ATTRIBUTE_ROTATION: frame->rotation = _anm2_reader_float(value); break;
+			case ANM2_ATTRIBUTE_INTERPOLATED: frame->isInterpolated = _anm2_reader_bool(value); break;
+			case ANM2_ATTRIBUTE_EVENT_ID: frame->eventID = _anm2_reader_int(value); break;
+			case ANM2_ATTRIBUTE_AT_FRAME: frame->atFrame = _anm2_reader_int(value); break;
+			default:
+				break;
+		}
+	}
+}
+
+static void _anm2_reader_animation_attributes_set(Anm2Reader* reader, Anm2Animation* animation)
+{
+	for (auto& attribute : std::span<const Anm2ReaderAttribute>(reader->attributes, reader->attributeCount))
+	{
+		switch (attribute.type)
+		{
+			case ANM2_ATTRIBUTE_NAME: _anm2_reader_string_set(&animation->name, attribute.value); break;
+			case ANM2_ATTRIBUTE_FRAME_NUM: animation->frameNum = _anm2_reader_int(attribute.value); break;
+			case ANM2_ATTRIBUTE_LOOP: animation->isLoop = _anm2_reader_bool(attribute.value); break;
+			default: break;
+		}
+	}
+}
+
+// Reads the children of an Animation until the reader closes back out to depth, or runs out of input
+static bool _anm2_reader_animation_body_read(Anm2Reader* reader, Anm2Animation* animation, std::vector<s32>* layerIDs, s32 depth)
+{
+	Anm2Item* item = nullptr;
+
+	while (true)
+	{
+		Anm2ReaderToken token = anm2_reader_next(reader);
+
+		if (token == ANM2_READER_TOKEN_ERROR) return false;
+		if (token == ANM2_READER_TOKEN_END) return true;
+
+		if (token == ANM2_READER_TOKEN_CLOSE)
+		{
+			if (reader->depth == depth) return true;
+			continue;
+		}
+
+		switch (reader->element)
+		{
+			case ANM2_ELEMENT_ROOT_ANIMATION: // RootAnimation
+			case ANM2_ELEMENT_LAYER_ANIMATION: // LayerAnimation
+			case ANM2_ELEMENT_NULL_ANIMATION: // NullAnimation
+			case ANM2_ELEMENT_TRIGGERS: // Triggers
+			{
+				item = nullptr;
+				std::optional<bool> isVisible;
+
+				if (reader->element == ANM2_ELEMENT_ROOT_ANIMATION)
+					item = &animation->rootAnimation;
+				else if (reader->element == ANM2_ELEMENT_TRIGGERS)
+					item = &animation->triggers;
+
+				for (auto& attribute : std::span<const Anm2ReaderAttribute>(reader->attributes, reader->attributeCount))
+				{
+					switch (attribute.type)
+					{
+						case ANM2_ATTRIBUTE_LAYER_ID:
+						{
+							s32 id = _anm2_reader_int(attribute.value);
+							layerIDs->push_back(id);
+							animation->layerAnimations[id] = Anm2Item{};
+							item = &animation->layerAnimations[id];
+							break;
+						}
+						case ANM2_ATTRIBUTE_NULL_ID:
+						{
+							s32 id = _anm2_reader_int(attribute.value);
+							animation->nullAnimations[id] = Anm2Item{};
+							item = &animation->nullAnimations[id];
+							break;
+						}
+						case ANM2_ATTRIBUTE_VISIBLE:
+							isVisible = _anm2_reader_bool(attribute.value);
+							break;
+						default:
+							break;
+					}
+				}
+
+				if (item && isVisible && reader->element != ANM2_ELEMENT_TRIGGERS)
+					item->isVisible = *isVisible;
+				break;
+			}
+			case ANM2_ELEMENT_FRAME: // Frame
+			case ANM2_ELEMENT_TRIGGER: // Trigger
+				if (!item) break;
+				_anm2_reader_frame_set(reader, &item->frames.emplace_back());
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+// Reads the Animation whose open tag the reader is on, through to its close
+static bool _anm2_reader_animation_read(Anm2Reader* reader, Anm2Animation* animation, std::vector<s32>* layerIDs)
+{
+	_anm2_reader_animation_attributes_set(reader, animation);
+
+	if (reader->isEmpty) return true;
+
+	return _anm2_reader_animation_body_read(reader, animation, layerIDs, reader->depth - 1);
+}
+
+bool anm2_reader_animation_body_read(Anm2Animation* animation, std::string* error)
+{
+	Anm2Reader reader;
+	std::vector<s32> layerIDs;
+
+	if (!animation->source) return true;
+
+	// The reader spans the whole source so error offsets stay absolute
+	anm2_reader_init(&reader, animation->source->data(), animation->source->size());
+	reader.cursor = animation->body.data();
+	reader.end = animation->body.data() + animation->body.size();
+
+	// The span holds only the children, so it's read through to its end
+	bool isValid = _anm2_reader_animation_body_read(&reader, animation, &layerIDs, -1);
+
+	if (!isValid && error)
+		*error = anm2_reader_error_get(&reader);
+
+	animation->source.reset();
+	animation->body = {};
+
+	return isValid;
+}
+
+// Each Animation subtree is independent, so they are parsed on worker threads pulling from a shared index;
+// the calling thread takes part, and small files never leave it
+static void _anm2_reader_animations_read(const char* data, size_t size, std::span<const Anm2ReaderRange> ranges, std::span<Anm2ReaderAnimation> animations)
+{
+	std::atomic<size_t> next = 0;
+
+	auto animations_read = [&]()
+	{
+		for (size_t i = next++; i < ranges.size(); i = next++)
+		{
+			Anm2Reader reader;
+			Anm2ReaderAnimation& animation = animations[i];
+
+			// The reader spans the whole file so error offsets stay absolute
+			anm2_reader_init(&reader, data, size);
+			reader.cursor = ranges[i].begin;
+			reader.end = ranges[i].end;
+
+			animation.isValid = anm2_reader_next(&reader) == ANM2_READER_TOKEN_OPEN &&
+								_anm2_reader_animation_read(&reader, &animation.animation, &animation.layerIDs);
+
+			if (!animation.isValid)
+				animation.error = anm2_reader_error_get(&reader);
+		}
+	};
+
+	size_t threadCount = std::min<size_t>(std::thread::hardware_concurrency(), ranges.size() / ANM2_READER_THREAD_ANIMATIONS_MIN);
+	std::vector<std::thread> threads;
+
+	for (size_t i = 1; i < threadCount; i++)
+		threads.emplace_back(animations_read);
+
+	animations_read();
+
+	for (auto& thread : threads)
+		thread.join();
+}
+
+bool anm2_reader_read(Anm2* self, Resources* resources, const std::string& directory, const char* data, size_t size, std::string* error, const std::shared_ptr<const std::string>& source)
+{
+	Anm2Reader reader;
+	bool isActor = false;
+	bool isActorDone = false;
+	bool isThreaded = !source && std::thread::hardware_concurrency() > 1;
+	std::string defaultAnimation{};
+	std::vector<Anm2ReaderRange> animationRanges;
+	std::vector<Anm2ReaderAnimation> animations;
+
+	anm2_reader_init(&reader, data, size);
+
+	while (true)
+	{
+		Anm2ReaderToken token = anm2_reader_next(&reader);
+
+		if (token == ANM2_READER_TOKEN_END || token == ANM2_READER_TOKEN_ERROR) break;
+
+		if (token == ANM2_READER_TOKEN_CLOSE)
+		{
+			if (isActor && reader.depth == 0)
+			{
+				isActor = false;
+				isActorDone = true;
+			}
+			continue;
+		}
+
+		// Only the first top-level AnimatedActor is read, same as the document path
+		if (!isActor)
+		{
+			if (!isActorDone && reader.element == ANM2_ELEMENT_ANIMATED_ACTOR && reader.depth == (reader.isEmpty ? 0 : 1))
+			{
+				isActor = !reader.isEmpty;
+				isActorDone = reader.isEmpty;
+			}
+			continue;
+		}
+
+		std::span<const Anm2ReaderAttribute> attributes(reader.attributes, reader.attributeCount);
+
+		switch (reader.element)
+		{
+			case ANM2_ELEMENT_INFO: // Info
+				for (auto& attribute : attributes)
+				{
+					switch (attribute.type)
+					{
+						case ANM2_ATTRIBUTE_CREATED_BY: _anm2_reader_string_set(&self->createdBy, attribute.value); break;
+						case ANM2_ATTRIBUTE_CREATED_ON: _anm2_reader_string_set(&self->createdOn, attribute.value); break;
+						case ANM2_ATTRIBUTE_VERSION: self->version = _anm2_reader_int(attribute.value); break;
+						case ANM2_ATTRIBUTE_FPS: self->fps = _anm2_reader_int(attribute.value); break;
+						default: break;
+					}
+				}
+				break;
+			case ANM2_ELEMENT_SPRITESHEET: // Spritesheet
+			{
+				Anm2Spritesheet spritesheet;
+				std::optional<s32> id;
+
+				for (auto& attribute : attributes)
+				{
+					switch (attribute.type)
+					{
+						case ANM2_ATTRIBUTE_PATH: _anm2_reader_string_set(&spritesheet.path, attribute.value); break;
+						case ANM2_ATTRIBUTE_ID: id = _anm2_reader_int(attribute.value); break;
+						default: break;
+					}
+				}
+
+				if (!id) break;
+
+				self->spritesheets[*id] = spritesheet;
+
+				if (resources)
+					resources_texture_init(resources, spritesheet.path, *id, directory);
+				break;
+			}
+			case ANM2_ELEMENT_LAYER: // Layer
+			{
+				Anm2Layer layer;
+				std::optional<s32> id;
+
+				for (auto& attribute : attributes)
+				{
+					switch (attribute.type)
+					{
+						case ANM2_ATTRIBUTE_NAME: _anm2_reader_string_set(&layer.name, attribute.value); break;
+						case ANM2_ATTRIBUTE_ID: id = _anm2_reader_int(attribute.value); break;
+						case ANM2_ATTRIBUTE_SPRITESHEET_ID: layer.spritesheetID = _anm2_reader_int(attribute.value); break;
+						default: break;
+					}
+				}
+
+				if (id) self->layers[*id] = layer;
+				break;
+			}
+			case ANM2_ELEMENT_NULL: // Null
+			{
+				Anm2Null null;
+				std::optional<s32> id;
+
+				for (auto& attribute : attributes)
+				{
+					switch (attribute.type)
+					{
+						case ANM2_ATTRIBUTE_NAME: _anm2_reader_string_set(&null.name, attribute.value); break;
+						case ANM2_ATTRIBUTE_ID: id = _anm2_reader_int(attribute.value); break;
+						case ANM2_ATTRIBUTE_SHOW_RECT: null.isShowRect = _anm2_reader_bool(attribute.value); break;
+						default: break;
+					}
+				}
+
+				if (id) self->nulls[*id] = null;
+				break;
+			}
+			case ANM2_ELEMENT_EVENT: // Event
+			{
+				Anm2Event event;
+				std::optional<s32> id;
+
+				for (auto& attribute : attributes)
+				{
+					switch (attribute.type)
+					{
+						case ANM2_ATTRIBUTE_NAME: _anm2_reader_string_set(&event.name, attribute.value); break;
+						case ANM2_ATTRIBUTE_ID: id = _anm2_reader_int(attribute.value); break;
+						default: break;
+					}
+				}
+
+				if (id) self->events[*id] = event;
+				break;
+			}
+			case ANM2_ELEMENT_ANIMATIONS: // Animations
+				for (auto& attribute : attributes)
+					if (attribute.type == ANM2_ATTRIBUTE_DEFAULT_ANIMATION)
+						_anm2_reader_string_set(&defaultAnimation, attribute.value);
+				break;
+			case ANM2_ELEMENT_ANIMATION: // Animation
+			{
+				// Lazily, only the header is read and the children are kept as a span of the source;
+				// the first animation is still read in full, as it defines the layer map
+				if (source && !animations.empty())
+				{
+					Anm2ReaderAnimation& animation = animations.emplace_back();
+					animation.isValid = true;
+
+					_anm2_reader_animation_attributes_set(&reader, &animation.animation);
+
+					if (reader.isEmpty) break;
+
+					const char* bodyBegin = reader.cursor;
+
+					if (anm2_reader_skip(&reader) == ANM2_READER_TOKEN_ERROR) break;
+
+					std::string_view body(bodyBegin, reader.tokenBegin - bodyBegin);
+					body = body.substr(0, body.find_last_not_of(" \t\r\n") + 1);
+
+					if (body.empty()) break;
+
+					animation.animation.source = source;
+					animation.animation.body = body;
+					break;
+				}
+
+				if (!isThreaded)
+				{
+					Anm2ReaderAnimation& animation = animations.emplace_back();
+					animation.isValid = _anm2_reader_animation_read(&reader, &animation.animation, &animation.layerIDs);
+
+					if (!animation.isValid)
+						animation.error = anm2_reader_error_get(&reader);
+					break;
+				}
+
+				// Only the extent is found here; the subtree is parsed afterwards, alongside the others
+				const char* animationBegin = reader.tokenBegin;
+
+				if (anm2_reader_skip(&reader) != ANM2_READER_TOKEN_ERROR)
+					animationRanges.push_back({animationBegin, reader.cursor});
+				break;
+			}
+			default:
+				break;
+		}
+	}
+
+	if (isThreaded)
+	{
+		animations.resize(animationRanges.size());
+		_anm2_reader_animations_read(data, size, animationRanges, animations);
+	}
+
+	// Skipped subtrees are only validated by their own read, so a bad animation can surface
+	// as a later error in the outer scan; the earliest one is reported
+	for (auto& animation : animations)
+	{
+		if (!animation.isValid)
+		{
+			if (error) *error = animation.error;
+			return false;
+		}
+	}
+
+	if (reader.token == ANM2_READER_TOKEN_ERROR)
+	{
+		if (error) *error = anm2_reader_error_get(&reader);
+		return false;
+	}
+
+	// Animations are read in order into a fresh document, so the id is the index
+	for (auto [i, animation] : std::views::enumerate(animations))
+		self->animations[(s32)i] = std::move(animation.animation);
+
+	// The layer map follows the LayerAnimation order of the first animation
+	if (!animations.empty())
+		for (auto [i, id] : std::views::enumerate(animations.front().layerIDs))
+			self->layerMap[(s32)i] = id;
+
+	// Set default animation ID
+	for (auto& [id, animation] : self->animations)
+		if (animation.name == defaultAnimation)
+			self->defaultAnimationID = id;
+
+	return true;
+}
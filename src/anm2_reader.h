@@ -0,0 +1,74 @@
+// Streaming anm2 reader; tokenizes the raw file buffer and fills Anm2 directly,
+// without building an intermediate XML document
+
+#pragma once
+
+#include "anm2.h"
+
+#define ANM2_READER_ATTRIBUTE_MAX 32
+#define ANM2_READER_DEPTH_MAX 64
+#define ANM2_READER_THREAD_ANIMATIONS_MIN 8 // animations per worker thread before another is started
+
+#define ANM2_READER_ERROR_FORMAT "{} (offset {})"
+#define ANM2_READER_ERROR_UNTERMINATED "Unterminated markup"
+#define ANM2_READER_ERROR_ELEMENT "Malformed element"
+#define ANM2_READER_ERROR_ATTRIBUTE "Malformed attribute"
+#define ANM2_READER_ERROR_ATTRIBUTE_MAX "Too many attributes"
+#define ANM2_READER_ERROR_DEPTH "Elements nested too deeply"
+#define ANM2_READER_ERROR_MISMATCH "Mismatched closing element"
+#define ANM2_READER_ERROR_UNCLOSED "Unclosed element at end of file"
+
+enum Anm2ReaderToken
+{
+    ANM2_READER_TOKEN_NONE,
+    ANM2_READER_TOKEN_OPEN,
+    ANM2_READER_TOKEN_CLOSE,
+    ANM2_READER_TOKEN_END,
+    ANM2_READER_TOKEN_ERROR
+};
+
+struct Anm2ReaderAttribute
+{
+    Anm2Attribute type = ANM2_ATTRIBUTE_COUNT;
+    std::string_view value{};
+};
+
+struct Anm2Reader
+{
+    const char* begin = nullptr;
+    const char* cursor = nullptr;
+    const char* end = nullptr;
+    const char* tokenBegin = nullptr;
+    const char* error = nullptr;
+    Anm2ReaderToken token = ANM2_READER_TOKEN_NONE;
+    Anm2Element element = ANM2_ELEMENT_COUNT;
+    bool isEmpty = false; // self-closing; no close token follows
+    s32 depth = 0;
+    s32 attributeCount = 0;
+    Anm2ReaderAttribute attributes[ANM2_READER_ATTRIBUTE_MAX];
+    std::string_view stack[ANM2_READER_DEPTH_MAX];
+};
+
+// Byte extent of one element in the source buffer, from its '<' to just past its closing '>'
+struct Anm2ReaderRange
+{
+    const char* begin = nullptr;
+    const char* end = nullptr;
+};
+
+struct Anm2ReaderAnimation
+{
+    Anm2Animation animation;
+    std::vector<s32> layerIDs{}; // LayerAnimation ids in file order
+    bool isValid = false;
+    std::string error{};
+};
+
+Anm2Element anm2_element_from_name(std::string_view name);
+Anm2Attribute anm2_attribute_from_name(std::string_view name);
+void anm2_reader_init(Anm2Reader* self, const char* data, size_t size);
+Anm2ReaderToken anm2_reader_next(Anm2Reader* self);
+Anm2ReaderToken anm2_reader_skip(Anm2Reader* self);
+std::string anm2_reader_error_get(Anm2Reader* self);
+bool anm2_reader_read(Anm2* self, Resources* resources, const std::string& directory, const char* data, size_t size, std::string* error, const std::shared_ptr<const std::string>& source = nullptr);
+bool anm2_reader_animation_body_read(Anm2Animation* animation, std::string* error);
@@ -0,0 +1,429 @@
+#include "anm2_writer.h"
+
+static void _anm2_writer_seal(Anm2Writer* self)
+{
+	if (!self->isElementOpen) return;
+
+	self->buffer->push_back('>');
+	self->isElementOpen = false;
+}
+
+static void _anm2_writer_indent(Anm2Writer* self, s32 depth)
+{
+	self->buffer->push_back('\n');
+
+	for (s32 i = 0; i < depth; i++)
+		self->buffer->append(ANM2_WRITER_INDENT);
+}
+
+static void _anm2_writer_attribute_name(Anm2Writer* self, Anm2Attribute attribute)
+{
+	self->buffer->push_back(' ');
+	self->buffer->append(ANM2_ATTRIBUTE_STRINGS[attribute]);
+	self->buffer->append("=\"");
+}
+
+static void _anm2_writer_escaped_append(std::string* buffer, const std::string& value)
+{
+	for (char character : value)
+	{
+		switch (character)
+		{
+			case '"': buffer->append("&quot;"); break;
+			case '&': buffer->append("&amp;"); break;
+			case '\'': buffer->append("&apos;"); break;
+			case '<': buffer->append("&lt;"); break;
+			case '>': buffer->append("&gt;"); break;
+			default: buffer->push_back(character); break;
+		}
+	}
+}
+
+// Shortest round-trip digits, laid out the way %.8g chooses between fixed and scientific notation. Only whole
+// numbers and values whose shortest form takes exactly 8 digits come out as tinyxml2 printed them; the rest are
+// shorter (0.3 where %.8g gave 0.30000001) or take the 9th digit %.8g dropped
+static void _anm2_writer_float_append(std::string* buffer, f32 value)
+{
+	char scientific[32];
+	char fixed[64];
+
+	auto [scientificEnd, scientificError] = std::to_chars(scientific, scientific + sizeof(scientific), value, std::chars_format::scientific);
+	std::string_view scientificString(scientific, scientificEnd - scientific);
+	size_t exponentPosition = scientificString.find('e');
+
+	if (scientificError != std::errc() || exponentPosition == std::string_view::npos)
+	{
+		buffer->append(scientificString); // inf/nan
+		return;
+	}
+
+	const char* exponentBegin = scientific + exponentPosition + 1;
+	if (*exponentBegin == '+') exponentBegin++;
+
+	s32 exponent = 0;
+	std::from_chars(exponentBegin, scientificEnd, exponent);
+
+	if (exponent < -4 || exponent >= ANM2_WRITER_FLOAT_PRECISION)
+	{
+		buffer->append(scientificString);
+		return;
+	}
+
+	auto [fixedEnd, fixedError] = std::to_chars(fixed, fixed + sizeof(fixed), value, std::chars_format::fixed);
+	buffer->append(fixed, fixedEnd - fixed);
+}
+
+void anm2_writer_init(Anm2Writer* self, std::string* buffer, s32 depth)
+{
+	*self = Anm2Writer{};
+	self->buffer = buffer;
+	self->depth = depth;
+	self->isFirstElement = depth == 0 && buffer->empty();
+}
+
+void anm2_writer_element_open(Anm2Writer* self, Anm2Element element)
+{
+	_anm2_writer_seal(self);
+
+	if (!self->isFirstElement)
+		_anm2_writer_indent(self, self->depth);
+
+	self->buffer->push_back('<');
+	self->buffer->append(ANM2_ELEMENT_STRINGS[element]);
+
+	self->stack[self->depth] = element;
+	self->depth++;
+	self->isElementOpen = true;
+	self->isFirstElement = false;
+}
+
+void anm2_writer_element_close(Anm2Writer* self)
+{
+	self->depth--;
+
+	if (self->isElementOpen)
+		self->buffer->append("/>");
+	else
+	{
+		_anm2_writer_indent(self, self->depth);
+		self->buffer->append("</");
+		self->buffer->append(ANM2_ELEMENT_STRINGS[self->stack[self->depth]]);
+		self->buffer->push_back('>');
+	}
+
+	if (self->depth == 0)
+		self->buffer->push_back('\n');
+
+	self->isElementOpen = false;
+}
+
+// Appends already-serialized children to the open element, verbatim
+void anm2_writer_raw(Anm2Writer* self, std::string_view raw)
+{
+	_anm2_writer_seal(self);
+	self->buffer->append(raw);
+}
+
+void anm2_writer_attribute_string(Anm2Writer* self, Anm2Attribute attribute, const std::string& value)
+{
+	_anm2_writer_attribute_name(self, attribute);
+	_anm2_writer_escaped_append(self->buffer, value);
+	self->buffer->push_back('"');
+}
+
+void anm2_writer_attribute_int(Anm2Writer* self, Anm2Attribute attribute, s32 value)
+{
+	char string[16];
+	auto [end, error] = std::to_chars(string, string + sizeof(string), value);
+
+	_anm2_writer_attribute_name(self, attribute);
+	self->buffer->append(string, end - string);
+	self->buffer->push_back('"');
+}
+
+void anm2_writer_attribute_float(Anm2Writer* self, Anm2Attribute attribute, f32 value)
+{
+	_anm2_writer_attribute_name(self, attribute);
+	_anm2_writer_float_append(self->buffer, value);
+	self->buffer->push_back('"');
+}
+
+void anm2_writer_attribute_bool(Anm2Writer* self, Anm2Attribute attribute, bool value)
+{
+	_anm2_writer_attribute_name(self, attribute);
+	self->buffer->append(value ? "true" : "false");
+	self->buffer->push_back('"');
+}
+
+static void _anm2_writer_frame_write(Anm2Writer* self, const Anm2Frame& frame, Anm2Type type)
+{
+	anm2_writer_element_open(self, ANM2_ELEMENT_FRAME);
+	anm2_writer_attribute_float(self, ANM2_ATTRIBUTE_X_POSITION, frame.position.x); // XPosition
+	anm2_writer_attribute_float(self, ANM2_ATTRIBUTE_Y_POSITION, frame.position.y); // YPosition
+	anm2_writer_attribute_float(self, ANM2_ATTRIBUTE_X_PIVOT, frame.pivot.x); // XPivot
+	anm2_writer_attribute_float(self, ANM2_ATTRIBUTE_Y_PIVOT, frame.pivot.y); // YPivot
+
+	// Only layer frames carry a crop
+	if (type == ANM2_LAYER)
+	{
+		anm2_writer_attribute_float(self, ANM2_ATTRIBUTE_X_CROP, frame.crop.x); // XCrop
+		anm2_writer_attribute_float(self, ANM2_ATTRIBUTE_Y_CROP, frame.crop.y); // YCrop
+		anm2_writer_attribute_float(self, ANM2_ATTRIBUTE_WIDTH, frame.size.x); // Width
+		anm2_writer_attribute_float(self, ANM2_ATTRIBUTE_HEIGHT, frame.size.y); // Height
+	}
+
+	anm2_writer_attribute_float(self, ANM2_ATTRIBUTE_X_SCALE, frame.scale.x); // XScale
+	anm2_writer_attribute_float(self, ANM2_ATTRIBUTE_Y_SCALE, frame.scale.y); // YScale
+	anm2_writer_attribute_int(self, ANM2_ATTRIBUTE_DELAY, frame.delay); // Delay
+	anm2_writer_attribute_bool(self, ANM2_ATTRIBUTE_VISIBLE, frame.isVisible); // Visible
+	anm2_writer_attribute_int(self, ANM2_ATTRIBUTE_RED_TINT, FLOAT_TO_U8(frame.tintRGBA.r)); // RedTint
+	anm2_writer_attribute_int(self, ANM2_ATTRIBUTE_GREEN_TINT, FLOAT_TO_U8(frame.tintRGBA.g)); // GreenTint
+	anm2_writer_attribute_int(self, ANM2_ATTRIBUTE_BLUE_TINT, FLOAT_TO_U8(frame.tintRGBA.b)); // BlueTint
+	anm2_writer_attribute_int(self, ANM2_ATTRIBUTE_ALPHA_TINT, FLOAT_TO_U8(frame.tintRGBA.a)); // AlphaTint
+	anm2_writer_attribute_int(self, ANM2_ATTRIBUTE_RED_OFFSET, FLOAT_TO_U8(frame.offsetRGB.r)); // RedOffset
+	anm2_writer_attribute_int(self, ANM2_ATTRIBUTE_GREEN_OFFSET, FLOAT_TO_U8(frame.offsetRGB.g)); // GreenOffset
+	anm2_writer_attribute_int(self, ANM2_ATTRIBUTE_BLUE_OFFSET, FLOAT_TO_U8(frame.offsetRGB.b)); // BlueOffset
+	anm2_writer_attribute_float(self, ANM2_ATTRIBUTE_ROTATION, frame.rotation); // Rotation
+	anm2_writer_attribute_bool(self, ANM2_ATTRIBUTE_INTERPOLATED, frame.isInterpolated); // Interpolated
+	anm2_writer_element_close(self);
+}
+
+// Frames are only read, so buffers shared with the undo history aren't copied by a save
+static void _anm2_writer_animation_children_write(Anm2Writer* self, Anm2* anm2, const Anm2Animation& animation)
+{
+	// RootAnimation
+	anm2_writer_element_open(self, ANM2_ELEMENT_ROOT_ANIMATION);
+	for (auto& frame : animation.rootAnimation.frames)
+		_anm2_writer_frame_write(self, frame, ANM2_ROOT);
+	anm2_writer_element_close(self);
+
+	// LayerAnimations
+	anm2_writer_element_open(self, ANM2_ELEMENT_LAYER_ANIMATIONS);
+	for (auto& [layerIndex, layerID] : anm2->layerMap)
+	{
+		auto it = animation.layerAnimations.find(layerID);
+		const Anm2Item& layerAnimation = it != animation.layerAnimations.end() ? it->second : dummy_value<const Anm2Item>();
+
+		// LayerAnimation
+		anm2_writer_element_open(self, ANM2_ELEMENT_LAYER_ANIMATION);
+		anm2_writer_attribute_int(self, ANM2_ATTRIBUTE_LAYER_ID, layerID); // LayerId
+		anm2_writer_attribute_bool(self, ANM2_ATTRIBUTE_VISIBLE, layerAnimation.isVisible); // Visible
+		for (auto& frame : layerAnimation.frames)
+			_anm2_writer_frame_write(self, frame, ANM2_LAYER);
+		anm2_writer_element_close(self);
+	}
+	anm2_writer_element_close(self);
+
+	// NullAnimations
+	anm2_writer_element_open(self, ANM2_ELEMENT_NULL_ANIMATIONS);
+	for (auto& [nullID, nullAnimation] : animation.nullAnimations)
+	{
+		// NullAnimation
+		anm2_writer_element_open(self, ANM2_ELEMENT_NULL_ANIMATION);
+		anm2_writer_attribute_int(self, ANM2_ATTRIBUTE_NULL_ID, nullID); // NullId
+		anm2_writer_attribute_bool(self, ANM2_ATTRIBUTE_VISIBLE, nullAnimation.isVisible); // Visible
+		for (auto& frame : nullAnimation.frames)
+			_anm2_writer_frame_write(self, frame, ANM2_NULL);
+		anm2_writer_element_close(self);
+	}
+	anm2_writer_element_close(self);
+
+	// Triggers
+	anm2_writer_element_open(self, ANM2_ELEMENT_TRIGGERS);
+	for (auto& frame : animation.triggers.frames)
+	{
+		// Trigger
+		anm2_writer_element_open(self, ANM2_ELEMENT_TRIGGER);
+		anm2_writer_attribute_int(self, ANM2_ATTRIBUTE_EVENT_ID, frame.eventID); // EventId
+		anm2_writer_attribute_int(self, ANM2_ATTRIBUTE_AT_FRAME, frame.atFrame); // AtFrame
+		anm2_writer_element_close(self);
+	}
+	anm2_writer_element_close(self);
+}
+
+static void _anm2_writer_animation_write(Anm2Writer* self, Anm2* anm2, Anm2Animation& animation, u64 fragmentKey)
+{
+	// Animation
+	anm2_writer_element_open(self, ANM2_ELEMENT_ANIMATION);
+	anm2_writer_attribute_string(self, ANM2_ATTRIBUTE_NAME, animation.name); // Name
+	anm2_writer_attribute_int(self, ANM2_ATTRIBUTE_FRAME_NUM, animation.frameNum); // FrameNum
+	anm2_writer_attribute_bool(self, ANM2_ATTRIBUTE_LOOP, animation.isLoop); // Loop
+
+	// Children never read since a lazy load go back out exactly as they came in
+	if (animation.source)
+	{
+		anm2_writer_raw(self, animation.body);
+		anm2_writer_element_close(self);
+		return;
+	}
+
+	// Children are only formatted again once dirtied, or once the layer order they were written in changes
+	if (!animation.fragment || animation.fragmentKey != fragmentKey)
+	{
+		std::string fragment;
+		Anm2Writer fragmentWriter;
+
+		anm2_writer_init(&fragmentWriter, &fragment, self->depth);
+
+		// Packed animations stay packed; their children are formatted from a decoded copy
+		if (animation.packed)
+		{
+			Anm2Animation unpacked = animation;
+			anm2_animation_materialize(&unpacked);
+			_anm2_writer_animation_children_write(&fragmentWriter, anm2, unpacked);
+		}
+		else
+			_anm2_writer_animation_children_write(&fragmentWriter, anm2, animation);
+
+		animation.fragment = std::make_shared<const std::string>(std::move(fragment));
+		animation.fragmentKey = fragmentKey;
+	}
+
+	anm2_writer_raw(self, *animation.fragment);
+	anm2_writer_element_close(self);
+}
+
+void anm2_writer_write(Anm2* self, std::string* buffer)
+{
+	Anm2Writer writer;
+
+	buffer->clear();
+	anm2_writer_init(&writer, buffer);
+
+	// AnimatedActor
+	anm2_writer_element_open(&writer, ANM2_ELEMENT_ANIMATED_ACTOR);
+
+	// Info
+	anm2_writer_element_open(&writer, ANM2_ELEMENT_INFO);
+	anm2_writer_attribute_string(&writer, ANM2_ATTRIBUTE_CREATED_BY, self->createdBy); // CreatedBy
+	anm2_writer_attribute_string(&writer, ANM2_ATTRIBUTE_CREATED_ON, self->createdOn); // CreatedOn
+	anm2_writer_attribute_int(&writer, ANM2_ATTRIBUTE_VERSION, self->version); // Version
+	anm2_writer_attribute_int(&writer, ANM2_ATTRIBUTE_FPS, self->fps); // FPS
+	anm2_writer_element_close(&writer);
+
+	// Content
+	anm2_writer_element_open(&writer, ANM2_ELEMENT_CONTENT);
+
+	// Spritesheets
+	anm2_writer_element_open(&writer, ANM2_ELEMENT_SPRITESHEETS);
+	for (auto& [id, spritesheet] : self->spritesheets)
+	{
+		anm2_writer_element_open(&writer, ANM2_ELEMENT_SPRITESHEET);
+		anm2_writer_attribute_string(&writer, ANM2_ATTRIBUTE_PATH, spritesheet.path); // Path
+		anm2_writer_attribute_int(&writer, ANM2_ATTRIBUTE_ID, id); // ID
+		anm2_writer_element_close(&writer);
+	}
+	anm2_writer_element_close(&writer);
+
+	// Layers
+	anm2_writer_element_open(&writer, ANM2_ELEMENT_LAYERS);
+	for (auto& [id, layer] : self->layers)
+	{
+		if (id == ID_NONE) continue;
+
+		anm2_writer_element_open(&writer, ANM2_ELEMENT_LAYER);
+		anm2_writer_attribute_string(&writer, ANM2_ATTRIBUTE_NAME, layer.name); // Name
+		anm2_writer_attribute_int(&writer, ANM2_ATTRIBUTE_ID, id); // ID
+		anm2_writer_attribute_int(&writer, ANM2_ATTRIBUTE_SPRITESHEET_ID, layer.spritesheetID); // SpritesheetId
+		anm2_writer_element_close(&writer);
+	}
+	anm2_writer_element_close(&writer);
+
+	// Nulls
+	anm2_writer_element_open(&writer, ANM2_ELEMENT_NULLS);
+	for (auto& [id, null] : self->nulls)
+	{
+		anm2_writer_element_open(&writer, ANM2_ELEMENT_NULL);
+		anm2_writer_attribute_string(&writer, ANM2_ATTRIBUTE_NAME, null.name); // Name
+		anm2_writer_attribute_int(&writer, ANM2_ATTRIBUTE_ID, id); // ID
+
+		// special case; only serialize if this is true
+		if (null.isShowRect)
+			anm2_writer_attribute_bool(&writer, ANM2_ATTRIBUTE_SHOW_RECT, null.isShowRect); // ShowRect
+		anm2_writer_element_close(&writer);
+	}
+	anm2_writer_element_close(&writer);
+
+	// Events
+	anm2_writer_element_open(&writer, ANM2_ELEMENT_EVENTS);
+	for (auto& [id, event] : self->events)
+	{
+		anm2_writer_element_open(&writer, ANM2_ELEMENT_EVENT);
+		anm2_writer_attribute_string(&writer, ANM2_ATTRIBUTE_NAME, event.name); // Name
+		anm2_writer_attribute_int(&writer, ANM2_ATTRIBUTE_ID, id); // ID
+		anm2_writer_element_close(&writer);
+	}
+	anm2_writer_element_close(&writer);
+
+	anm2_writer_element_close(&writer);
+
+	// Animations
+	anm2_writer_element_open(&writer, ANM2_ELEMENT_ANIMATIONS);
+	anm2_writer_attribute_string(&writer, ANM2_ATTRIBUTE_DEFAULT_ANIMATION, self->animations[self->defaultAnimationID].name); // DefaultAnimation
+
+	// The first animation's LayerAnimation order is the layer map on the next read, so it's always written out
+	if (!self->animations.empty())
+		anm2_animation_materialize(&self->animations.begin()->second);
+
+	u64 fragmentKey = FNV1A_OFFSET;
+	size_t reserveSize = buffer->size();
+
+	for (auto& [layerIndex, layerID] : self->layerMap)
+		fragmentKey = hash_fnv1a(std::string_view((const char*)&layerID, sizeof(layerID)), fragmentKey);
+
+	// Mostly-spliced saves are bound by copying, so the buffer's grown once up front
+	for (auto& [id, animation] : self->animations)
+		reserveSize += animation.fragment ? animation.fragment->size() : animation.body.size();
+
+	buffer->reserve(reserveSize);
+
+	for (auto& [id, animation] : self->animations)
+		_anm2_writer_animation_write(&writer, self, animation, fragmentKey);
+
+	anm2_writer_element_close(&writer);
+
+	anm2_writer_element_close(&writer);
+}
+
+bool anm2_writer_file_write(const std::string& path, const std::string& buffer)
+{
+	std::filesystem::path filesystemPath(path);
+	std::filesystem::path temp = filesystemPath;
+	temp += ANM2_WRITER_TEMPORARY_EXTENSION;
+
+	std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+	if (!out)
+	{
+		log_error(std::format(ANM2_WRITER_FILE_ERROR, temp.string()));
+		return false;
+	}
+
+	out.write(buffer.data(), buffer.size());
+	out.close();
+
+	if (!out.good())
+	{
+		log_error(std::format(ANM2_WRITER_FILE_ERROR, temp.string()));
+		std::error_code errorCode;
+		std::filesystem::remove(temp, errorCode);
+		return false;
+	}
+
+	std::error_code errorCode;
+	std::filesystem::rename(temp, filesystemPath, errorCode);
+	if (errorCode)
+	{
+		// Windows can block rename if target exists; try remove+rename
+		std::filesystem::remove(filesystemPath, errorCode);
+		errorCode = {};
+		std::filesystem::rename(temp, filesystemPath, errorCode);
+		if (errorCode)
+		{
+			log_error(std::format(ANM2_WRITER_FINALIZE_ERROR, filesystemPath.string(), errorCode.message()));
+			std::filesystem::remove(temp, errorCode);
+			return false;
+		}
+	}
+
+	return true;
+}
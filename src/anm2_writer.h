@@ -0,0 +1,32 @@
+// Direct anm2 writer; emits the same XML tinyxml2's printer would, straight into one buffer
+
+#pragma once
+
+#include "anm2.h"
+
+#define ANM2_WRITER_DEPTH_MAX 16
+#define ANM2_WRITER_INDENT "    "
+#define ANM2_WRITER_FLOAT_PRECISION 8 // tinyxml2 prints floats with %.8g
+#define ANM2_WRITER_TEMPORARY_EXTENSION ".tmp"
+#define ANM2_WRITER_FILE_ERROR "Failed to write temporary file: {}"
+#define ANM2_WRITER_FINALIZE_ERROR "Failed to replace {}: {}"
+
+struct Anm2Writer
+{
+    std::string* buffer = nullptr;
+    s32 depth = 0;
+    bool isElementOpen = false; // open tag not yet sealed with '>'
+    bool isFirstElement = true;
+    Anm2Element stack[ANM2_WRITER_DEPTH_MAX];
+};
+
+void anm2_writer_init(Anm2Writer* self, std::string* buffer, s32 depth = 0);
+void anm2_writer_element_open(Anm2Writer* self, Anm2Element element);
+void anm2_writer_element_close(Anm2Writer* self);
+void anm2_writer_raw(Anm2Writer* self, std::string_view raw);
+void anm2_writer_attribute_string(Anm2Writer* self, Anm2Attribute attribute, const std::string& value);
+void anm2_writer_attribute_int(Anm2Writer* self, Anm2Attribute attribute, s32 value);
+void anm2_writer_attribute_float(Anm2Writer* self, Anm2Attribute attribute, f32 value);
+void anm2_writer_attribute_bool(Anm2Writer* self, Anm2Attribute attribute, bool value);
+void anm2_writer_write(Anm2* self, std::string* buffer);
+bool anm2_writer_file_write(const std::string& path, const std::string& buffer);
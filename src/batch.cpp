@@ -0,0 +1,366 @@
+#include "batch.h"
+
+// '*' and '?' stay within one path component; "**" crosses them
+static bool _batch_glob_match(std::string_view pattern, std::string_view path)
+{
+	if (pattern.empty()) return path.empty();
+
+	if (pattern.starts_with("**"))
+	{
+		pattern.remove_prefix(2);
+
+		// "**/" also matches no directories at all
+		if (pattern.starts_with('/') && _batch_glob_match(pattern.substr(1), path))
+			return true;
+
+		for (size_t i = 0; i <= path.size(); i++)
+			if (_batch_glob_match(pattern, path.substr(i)))
+				return true;
+
+		return false;
+	}
+
+	if (pattern[0] == '*')
+	{
+		for (size_t i = 0; i <= path.size(); i++)
+		{
+			if (_batch_glob_match(pattern.substr(1), path.substr(i)))
+				return true;
+			if (i < path.size() && path[i] == '/')
+				break;
+		}
+
+		return false;
+	}
+
+	if (path.empty()) return false;
+
+	if (pattern[0] == '?' ? path[0] == '/' : pattern[0] != path[0])
+		return false;
+
+	return _batch_glob_match(pattern.substr(1), path.substr(1));
+}
+
+static bool _batch_is_anm2(const std::filesystem::path& path)
+{
+	return path.extension() == "." ANM2_EXTENSION;
+}
+
+static void _batch_file_add(Batch* self, std::unordered_set<std::string>& seen, const std::filesystem::path& path)
+{
+	std::error_code errorCode;
+	std::string absolute = std::filesystem::absolute(path, errorCode).lexically_normal().string();
+
+	if (errorCode) absolute = path.string();
+
+	if (seen.insert(absolute).second)
+		self->files.push_back(absolute);
+}
+
+static bool _batch_argument_files_add(Batch* self, std::unordered_set<std::string>& seen, const std::string& argument)
+{
+	std::error_code errorCode;
+
+	// File list; one path, directory or glob per line
+	if (argument.starts_with(BATCH_LIST_PREFIX))
+	{
+		std::ifstream list(argument.substr(1));
+		std::string line;
+
+		if (!list)
+		{
+			log_error(std::format(BATCH_LIST_ERROR, argument.substr(1)));
+			return false;
+		}
+
+		while (std::getline(list, line))
+		{
+			if (!line.empty() && line.back() == '\r') line.pop_back();
+			if (line.empty()) continue;
+			if (!_batch_argument_files_add(self, seen, line)) return false;
+		}
+
+		return true;
+	}
+
+	std::string pattern = std::filesystem::path(argument).generic_string();
+
+	if (pattern.find_first_of("*?") == std::string::npos)
+	{
+		if (std::filesystem::is_directory(argument, errorCode))
+		{
+			for (auto& entry : std::filesystem::recursive_directory_iterator(argument, errorCode))
+				if (entry.is_regular_file() && _batch_is_anm2(entry.path()))
+					_batch_file_add(self, seen, entry.path());
+		}
+		else
+			_batch_file_add(self, seen, argument);
+
+		return true;
+	}
+
+	// The glob is walked from its last directory before the first wildcard
+	size_t wildcard = pattern.find_first_of("*?");
+	size_t separator = pattern.rfind('/', wildcard);
+	std::string base = separator == std::string::npos ? "." : pattern.substr(0, separator + 1);
+	std::string relativePattern = separator == std::string::npos ? pattern : pattern.substr(separator + 1);
+
+	for (auto& entry : std::filesystem::recursive_directory_iterator(base, errorCode))
+	{
+		if (!entry.is_regular_file()) continue;
+
+		std::string relative = entry.path().lexically_relative(base).generic_string();
+
+		if (_batch_glob_match(relativePattern, relative))
+			_batch_file_add(self, seen, entry.path());
+	}
+
+	return true;
+}
+
+bool batch_arguments_parse(Batch* self, s32 argc, char* argv[])
+{
+	std::unordered_set<std::string> seen;
+	s32 i = 0;
+
+	if (argc < 1)
+	{
+		log_error(BATCH_USAGE);
+		return false;
+	}
+
+	self->operation = BATCH_OPERATION_STRING_TO_ENUM(argv[i++]);
+
+	switch (self->operation)
+	{
+		case BATCH_RESCALE:
+			if (i >= argc) break;
+			self->scale = atof(argv[i++]);
+
+			if (self->scale <= 0.0f)
+			{
+				log_error(BATCH_USAGE);
+				return false;
+			}
+			break;
+		case BATCH_PATH:
+			if (i + 1 >= argc) break;
+			self->pathFrom = argv[i++];
+			self->pathTo = argv[i++];
+			break;
+		case BATCH_VALIDATE:
+		case BATCH_NORMALIZE:
+		case BATCH_STATS:
+			break;
+		default:
+			log_error(std::format(BATCH_OPERATION_ERROR, argv[0]));
+			log_error(BATCH_USAGE);
+			return false;
+	}
+
+	for (; i < argc; i++)
+	{
+		std::string argument = argv[i];
+
+		if (argument == BATCH_ARGUMENT_THREADS && i + 1 < argc)
+		{
+			self->threadCount = std::max(0, atoi(argv[++i]));
+			continue;
+		}
+
+		if (!_batch_argument_files_add(self, seen, argument)) return false;
+	}
+
+	if (self->files.empty())
+	{
+		log_error(BATCH_FILES_ERROR);
+		log_error(BATCH_USAGE);
+		return false;
+	}
+
+	return true;
+}
+
+static BatchStats _batch_stats_get(Anm2* anm2)
+{
+	BatchStats stats;
+
+	stats.animations = anm2->animations.size();
+	stats.layers = anm2->layers.size();
+	stats.nulls = anm2->nulls.size();
+	stats.events = anm2->events.size();
+
+	for (auto& [_, animation] : anm2->animations)
+	{
+		stats.frames += animation.rootAnimation.frames.size();
+		stats.triggers += animation.triggers.frames.size();
+
+		for (auto& [_, item] : animation.layerAnimations)
+			stats.frames += item.frames.size();
+		for (auto& [_, item] : animation.nullAnimations)
+			stats.frames += item.frames.size();
+	}
+
+	return stats;
+}
+
+static void _batch_validate(Anm2* anm2, BatchResult* result)
+{
+	for (auto& [id, layer] : anm2->layers)
+		if (!anm2->spritesheets.contains(layer.spritesheetID))
+			result->messages.push_back(std::format(BATCH_VALIDATE_SPRITESHEET_ERROR, id, layer.spritesheetID));
+
+	for (auto& [_, animation] : anm2->animations)
+	{
+		for (auto& [id, _] : animation.layerAnimations)
+			if (!anm2->layers.contains(id))
+				result->messages.push_back(std::format(BATCH_VALIDATE_LAYER_ERROR, animation.name, id));
+
+		for (auto& [id, _] : animation.nullAnimations)
+			if (!anm2->nulls.contains(id))
+				result->messages.push_back(std::format(BATCH_VALIDATE_NULL_ERROR, animation.name, id));
+
+		for (auto& trigger : animation.triggers.frames)
+			if (trigger.eventID != ID_NONE && !anm2->events.contains(trigger.eventID))
+				result->messages.push_back(std::format(BATCH_VALIDATE_EVENT_ERROR, animation.name, trigger.eventID));
+	}
+
+	if (!anm2->animations.empty() && !anm2->animations.contains(anm2->defaultAnimationID))
+		result->messages.push_back(std::format(BATCH_VALIDATE_DEFAULT_ERROR, anm2->defaultAnimationID));
+
+	result->isSuccess = result->messages.empty();
+
+	if (result->isSuccess)
+		result->messages.push_back(BATCH_VALID_INFO);
+}
+
+static void _batch_file_process(Batch* self, const std::string& path, BatchResult* result)
+{
+	Anm2 anm2;
+
+	// No resources; nothing is loaded
+	if (!anm2_deserialize(&anm2, nullptr, path))
+	{
+		result->messages.push_back(BATCH_READ_ERROR);
+		return;
+	}
+
+	result->stats = _batch_stats_get(&anm2);
+	result->isSuccess = true;
+
+	switch (self->operation)
+	{
+		case BATCH_VALIDATE:
+			_batch_validate(&anm2, result);
+			return;
+		case BATCH_STATS:
+		{
+			BatchStats& stats = result->stats;
+			result->messages.push_back(std::format(BATCH_STATS_FORMAT, stats.animations, stats.layers, stats.nulls, stats.events, stats.frames, stats.triggers));
+			return;
+		}
+		case BATCH_RESCALE:
+			anm2_scale(&anm2, self->scale);
+			result->messages.push_back(std::format(BATCH_RESCALE_INFO, self->scale));
+			break;
+		case BATCH_NORMALIZE:
+			result->messages.push_back(BATCH_NORMALIZE_INFO);
+			break;
+		case BATCH_PATH:
+		{
+			s32 count = 0;
+
+			for (auto& [_, spritesheet] : anm2.spritesheets)
+			{
+				size_t position = spritesheet.path.find(self->pathFrom);
+
+				if (self->pathFrom.empty() || position == std::string::npos) continue;
+
+				for (; position != std::string::npos; position = spritesheet.path.find(self->pathFrom, position + self->pathTo.size()))
+					spritesheet.path.replace(position, self->pathFrom.size(), self->pathTo);
+
+				count++;
+			}
+
+			result->messages.push_back(std::format(BATCH_PATH_INFO, count));
+
+			// Untouched files are left as they are
+			if (count == 0) return;
+			break;
+		}
+		default:
+			return;
+	}
+
+	if (!anm2_serialize(&anm2, path))
+	{
+		result->isSuccess = false;
+		result->messages = {BATCH_WRITE_ERROR};
+	}
+}
+
+bool batch_run(Batch* self)
+{
+	ThreadPool pool;
+	std::vector<BatchResult> results(self->files.size());
+	BatchStats total;
+	s32 failedCount = 0;
+	f64 megabytes = 0.0;
+
+	for (auto& file : self->files)
+	{
+		std::error_code errorCode;
+		megabytes += std::filesystem::file_size(file, errorCode) / (1024.0 * 1024.0);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+
+	thread_pool_init(&pool, self->threadCount);
+
+	for (auto [i, file] : std::views::enumerate(self->files))
+	{
+		BatchResult* result = &results[i];
+		const std::string* path = &file;
+		thread_pool_submit(&pool, [self, path, result] { _batch_file_process(self, *path, result); });
+	}
+
+	thread_pool_wait(&pool);
+
+	s32 threadCount = (s32)pool.threads.size();
+	thread_pool_free(&pool);
+
+	f64 seconds = std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+
+	// Reported in input order once everything's done, so output is stable regardless of scheduling
+	for (auto [i, result] : std::views::enumerate(results))
+	{
+		for (auto& message : result.messages)
+		{
+			if (result.isSuccess)
+				log_info(std::format(BATCH_FILE_INFO, self->files[i], message));
+			else
+				log_error(std::format(BATCH_FILE_ERROR, self->files[i], message));
+		}
+
+		if (!result.isSuccess)
+		{
+			failedCount++;
+			continue;
+		}
+
+		total.animations += result.stats.animations;
+		total.layers += result.stats.layers;
+		total.nulls += result.stats.nulls;
+		total.events += result.stats.events;
+		total.frames += result.stats.frames;
+		total.triggers += result.stats.triggers;
+	}
+
+	if (self->operation == BATCH_STATS)
+		log_info(std::format(BATCH_STATS_TOTAL_INFO, total.animations, total.layers, total.nulls, total.events, total.frames, total.triggers));
+
+	log_info(std::format(BATCH_SUMMARY_INFO, BATCH_OPERATION_STRINGS[self->operation], self->files.size(), failedCount,
+		seconds, self->files.size() / seconds, megabytes / seconds, threadCount));
+
+	return failedCount == 0;
+}
@@ -0,0 +1,81 @@
+// Headless batch processing; applies one operation to many anm2 files across a thread pool
+
+#pragma once
+
+#include "thread_pool.h"
+#include "anm2.h"
+
+#define BATCH_LIST_PREFIX '@'
+#define BATCH_ARGUMENT_THREADS "--threads"
+#define BATCH_USAGE "--batch: usage: --batch <rescale <scale> | validate | normalize | stats | path <from> <to>> [--threads <count>] <files, directories, globs or @list>..."
+#define BATCH_OPERATION_ERROR "--batch: unknown operation: {}"
+#define BATCH_FILES_ERROR "--batch: no anm2 files matched"
+#define BATCH_LIST_ERROR "--batch: unable to read file list: {}"
+#define BATCH_FILE_ERROR "{}: {}"
+#define BATCH_FILE_INFO "{}: {}"
+#define BATCH_READ_ERROR "unable to read"
+#define BATCH_WRITE_ERROR "unable to write"
+#define BATCH_RESCALE_INFO "scaled by {}"
+#define BATCH_NORMALIZE_INFO "saved"
+#define BATCH_VALID_INFO "valid"
+#define BATCH_PATH_INFO "{} spritesheet path(s) rewritten"
+#define BATCH_STATS_FORMAT "{} animations, {} layers, {} nulls, {} events, {} frames, {} triggers"
+#define BATCH_STATS_TOTAL_INFO "Total: " BATCH_STATS_FORMAT
+#define BATCH_VALIDATE_SPRITESHEET_ERROR "layer {} uses missing spritesheet {}"
+#define BATCH_VALIDATE_LAYER_ERROR "animation \"{}\" has frames for missing layer {}"
+#define BATCH_VALIDATE_NULL_ERROR "animation \"{}\" has frames for missing null {}"
+#define BATCH_VALIDATE_EVENT_ERROR "animation \"{}\" triggers missing event {}"
+#define BATCH_VALIDATE_DEFAULT_ERROR "default animation {} does not exist"
+#define BATCH_SUMMARY_INFO "Batch {}: {} file(s), {} failed, {:.2f} s ({:.1f} files/s, {:.2f} MB/s, {} threads)"
+
+#define BATCH_OPERATION_LIST \
+    X(RESCALE,   "rescale")   \
+    X(VALIDATE,  "validate")  \
+    X(NORMALIZE, "normalize") \
+    X(STATS,     "stats")     \
+    X(PATH,      "path")
+
+typedef enum {
+    #define X(name, str) BATCH_##name,
+    BATCH_OPERATION_LIST
+    #undef X
+    BATCH_OPERATION_COUNT
+} BatchOperation;
+
+static const char* BATCH_OPERATION_STRINGS[] = {
+    #define X(name, str) str,
+    BATCH_OPERATION_LIST
+    #undef X
+};
+
+DEFINE_STRING_TO_ENUM_FUNCTION(BATCH_OPERATION_STRING_TO_ENUM, BatchOperation, BATCH_OPERATION_STRINGS, BATCH_OPERATION_COUNT)
+
+struct BatchStats
+{
+    s64 animations{};
+    s64 layers{};
+    s64 nulls{};
+    s64 events{};
+    s64 frames{};
+    s64 triggers{};
+};
+
+struct BatchResult
+{
+    bool isSuccess = false;
+    std::vector<std::string> messages;
+    BatchStats stats;
+};
+
+struct Batch
+{
+    BatchOperation operation = BATCH_OPERATION_COUNT;
+    f32 scale = 1.0f;
+    std::string pathFrom{};
+    std::string pathTo{};
+    s32 threadCount = 0;
+    std::vector<std::string> files;
+};
+
+bool batch_arguments_parse(Batch* self, s32 argc, char* argv[]);
+bool batch_run(Batch* self);
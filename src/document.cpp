@@ -0,0 +1,225 @@
+#include "document.h"
+
+// Exchanges a parked document with the working slots
+static void _documents_swap(Documents* self, Document* document)
+{
+	std::swap(*self->anm2, document->anm2);
+	std::swap(*self->reference, document->reference);
+	std::swap(self->snapshots->undoStack, document->undoStack);
+	std::swap(self->snapshots->redoStack, document->redoStack);
+	std::swap(self->snapshots->base, document->base);
+	std::swap(self->snapshots->transaction, document->transaction);
+	std::swap(self->snapshots->journal, document->journal);
+	std::swap(self->snapshots->isChanged, document->isChanged);
+	std::swap(self->snapshots->action, document->action);
+	std::swap(self->resources->textures, document->textures);
+	std::swap(self->preview->time, document->time);
+	std::swap(self->preview->animationOverlayID, document->animationOverlayID);
+	std::swap(self->editor->spritesheetID, document->spritesheetID);
+}
+
+void documents_init(Documents* self, Anm2* anm2, Anm2Reference* reference, Snapshots* snapshots, Resources* resources, Preview* preview, Editor* editor)
+{
+	self->anm2 = anm2;
+	self->reference = reference;
+	self->snapshots = snapshots;
+	self->resources = resources;
+	self->preview = preview;
+	self->editor = editor;
+
+	self->documents.clear();
+	self->index = documents_add(self);
+}
+
+// Appends an empty document after the others; it isn't switched to
+s32 documents_add(Documents* self)
+{
+	self->documents.emplace_back();
+	self->documents.back().id = self->nextID++;
+	return (s32)self->documents.size() - 1;
+}
+
+void documents_set(Documents* self, s32 index)
+{
+	if (index == self->index || index < 0 || index >= (s32)self->documents.size()) return;
+
+	// An edit left open would otherwise be checked against the next document
+	snapshots_undo_commit(self->snapshots);
+
+	_documents_swap(self, &self->documents[self->index]);
+	_documents_swap(self, &self->documents[index]);
+
+	self->index = index;
+	self->preview->isPlaying = false;
+}
+
+// Closing the active document switches to its neighbor; closing the last leaves an empty one
+void documents_remove(Documents* self, s32 index)
+{
+	if (index < 0 || index >= (s32)self->documents.size()) return;
+
+	if (self->documents.size() == 1)
+	{
+		resources_textures_free(self->resources);
+		anm2_reference_clear(self->reference);
+		anm2_new(self->anm2);
+		snapshots_reset(self->snapshots);
+		self->preview->time = 0.0f;
+		self->preview->animationOverlayID = ID_NONE;
+		self->editor->spritesheetID = ID_NONE;
+		self->documents[0].id = self->nextID++;
+		return;
+	}
+
+	if (index == self->index)
+		documents_set(self, index > 0 ? index - 1 : index + 1);
+
+	// The parked document's textures are released through the working slot, so shared ones stay loaded
+	std::swap(self->resources->textures, self->documents[index].textures);
+	resources_textures_free(self->resources);
+	std::swap(self->resources->textures, self->documents[index].textures);
+
+	snapshot_stack_free(&self->documents[index].undoStack);
+	journal_free(&self->documents[index].journal);
+	self->documents.erase(self->documents.begin() + index);
+
+	if (self->index > index) self->index--;
+}
+
+// Parked documents' histories and journals; the working one goes through snapshots_free
+void documents_free(Documents* self)
+{
+	for (auto& document : self->documents)
+	{
+		snapshot_stack_free(&document.undoStack);
+		journal_free(&document.journal);
+	}
+}
+
+// Opens what each journal a crash left behind recovers in a tab of its own, as an edit over the file it was of,
+// so undoing it goes back to what was last saved. A journal that can't be read is left where it is, as are those
+// of other instances still running. Meant for startup, before this instance has journaled anything of its own
+void documents_recover(Documents* self)
+{
+	for (const std::string& path : journal_paths_get())
+	{
+		Anm2 recovered;
+		std::error_code errorCode;
+
+		if (!journal_replay(&recovered, path)) continue;
+
+		if (!self->anm2->path.empty() || !self->snapshots->undoStack.is_empty())
+			documents_set(self, documents_add(self));
+
+		anm2_reference_clear(self->reference);
+		resources_textures_free(self->resources);
+
+		if (recovered.path.empty() || !anm2_deserialize(self->anm2, nullptr, recovered.path))
+			anm2_new(self->anm2);
+
+		snapshots_reset(self->snapshots);
+		snapshots_undo_push(self->snapshots, DOCUMENT_ACTION_RECOVER);
+		*self->anm2 = std::move(recovered);
+		snapshots_undo_commit(self->snapshots); // starts its own journal, with the recovered state as the checkpoint
+
+		for (auto& [id, spritesheet] : self->anm2->spritesheets)
+			resources_texture_init(self->resources, spritesheet.path, id, path_directory_get(self->anm2->path));
+
+		std::filesystem::remove(path, errorCode);
+	}
+}
+
+// Saves in the background, from a copy of the document as it is now
+void documents_save(Documents* self, Saves* saves, s32 index, const std::string& path)
+{
+	bool isActive = index == self->index;
+	Document* document = &self->documents[index];
+
+	(isActive ? self->snapshots->isChanged : document->isChanged) = false;
+	saves_submit(saves, documents_anm2_get(self, index), isActive ? self->reference : &document->reference, document->id, path);
+}
+
+// The fragments a save wrote on its copy, for the animations the document hasn't changed since; the next save splices
+// them rather than writing those out again
+static void _documents_fragments_take(Anm2* anm2, Anm2* saved)
+{
+	for (auto& [id, savedAnimation] : saved->animations)
+	{
+		Anm2Animation* animation = map_find(anm2->animations, id);
+
+		if (!animation || !savedAnimation.fragment || animation->revision != savedAnimation.revision) continue;
+
+		animation->fragment = std::move(savedAnimation.fragment);
+		animation->fragmentKey = savedAnimation.fragmentKey;
+	}
+}
+
+// Once a save's written, its document's journal starts over from what was saved, unless it's been changed since.
+// One that failed leaves its document unsaved. Saves of documents since closed are let go
+void documents_save_finish(Documents* self, Save* save)
+{
+	for (s32 i = 0; i < (s32)self->documents.size(); i++)
+	{
+		if (self->documents[i].id != save->documentID) continue;
+
+		bool isActive = i == self->index;
+		bool* isChanged = isActive ? &self->snapshots->isChanged : &self->documents[i].isChanged;
+
+		_documents_fragments_take(documents_anm2_get(self, i), &save->anm2);
+
+		if (!save->isSuccess)
+			*isChanged = true;
+		else if (!*isChanged)
+			journal_reset(isActive ? &self->snapshots->journal : &self->documents[i].journal, save->anm2);
+
+		return;
+	}
+}
+
+// Paths are matched by the file they name, however they're spelled
+s32 documents_find(Documents* self, const std::string& path)
+{
+	std::error_code errorCode;
+
+	for (s32 i = 0; i < (s32)self->documents.size(); i++)
+	{
+		const std::string& documentPath = documents_anm2_get(self, i)->path;
+
+		if (!documentPath.empty() && std::filesystem::equivalent(documentPath, path, errorCode))
+			return i;
+	}
+
+	return INDEX_NONE;
+}
+
+Anm2* documents_anm2_get(Documents* self, s32 index)
+{
+	return index == self->index ? self->anm2 : &self->documents[index].anm2;
+}
+
+// As with exiting, anything on the undo stack counts as a change that could be lost
+bool documents_is_modified(Documents* self, s32 index)
+{
+	return index == self->index ? !self->snapshots->undoStack.is_empty() : !self->documents[index].undoStack.is_empty();
+}
+
+bool documents_is_any_modified(Documents* self)
+{
+	for (s32 i = 0; i < (s32)self->documents.size(); i++)
+		if (documents_is_modified(self, i))
+			return true;
+
+	return false;
+}
+
+// Unlike being modified, this is cleared by saving
+bool documents_is_changed(Documents* self, s32 index)
+{
+	return index == self->index ? self->snapshots->isChanged : self->documents[index].isChanged;
+}
+
+std::string documents_name_get(Documents* self, s32 index)
+{
+	Anm2* anm2 = documents_anm2_get(self, index);
+	return anm2->path.empty() ? DOCUMENT_UNTITLED : std::filesystem::path(anm2->path).filename().string();
+}
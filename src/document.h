@@ -0,0 +1,58 @@
+// Open documents, one per tab. The active one is edited in place through the working slots every module points at
+// (anm2, reference, snapshots and the active texture map); the others are parked here with their own undo history
+
+#pragma once
+
+#include "editor.h"
+#include "preview.h"
+#include "save.h"
+#include "snapshots.h"
+
+#define DOCUMENT_UNTITLED "Untitled"
+#define DOCUMENT_ACTION_RECOVER "Recover"
+
+struct Document
+{
+    s32 id = ID_NONE; // stays with the tab; everything else is swapped in and out with the working slots
+    Anm2 anm2;
+    Anm2Reference reference;
+    SnapshotStack undoStack;
+    SnapshotStack redoStack;
+    Anm2 base; // see Snapshots
+    SnapshotTransaction transaction;
+    Journal journal;
+    bool isChanged = false; // see Snapshots
+    std::string action = SNAPSHOT_ACTION;
+    std::map<s32, ResourcesTexture*> textures;
+    f32 time{};
+    s32 animationOverlayID = ID_NONE;
+    s32 spritesheetID = ID_NONE;
+};
+
+struct Documents
+{
+    Anm2* anm2 = nullptr;
+    Anm2Reference* reference = nullptr;
+    Snapshots* snapshots = nullptr;
+    Resources* resources = nullptr;
+    Preview* preview = nullptr;
+    Editor* editor = nullptr;
+    std::vector<Document> documents; // in tab order; the active one's entry stays empty while it's in the working slots
+    s32 index = 0;
+    s32 nextID = 0;
+};
+
+void documents_init(Documents* self, Anm2* anm2, Anm2Reference* reference, Snapshots* snapshots, Resources* resources, Preview* preview, Editor* editor);
+s32 documents_add(Documents* self);
+void documents_set(Documents* self, s32 index);
+void documents_remove(Documents* self, s32 index);
+void documents_free(Documents* self);
+void documents_recover(Documents* self);
+void documents_save(Documents* self, Saves* saves, s32 index, const std::string& path);
+void documents_save_finish(Documents* self, Save* save);
+s32 documents_find(Documents* self, const std::string& path);
+Anm2* documents_anm2_get(Documents* self, s32 index);
+bool documents_is_modified(Documents* self, s32 index);
+bool documents_is_any_modified(Documents* self);
+bool documents_is_changed(Documents* self, s32 index);
+std::string documents_name_get(Documents* self, s32 index);
@@ -26,11 +26,10 @@ void editor_draw(Editor* self)
     canvas_viewport_set(&self->canvas);
     canvas_clear(self->settings->editorBackgroundColor);
 
-    if (self->spritesheetID != ID_NONE)
+    if (Texture* texture = resources_texture_get(self->resources, self->spritesheetID))
     {
-        Texture texture = self->resources->textures[self->spritesheetID];
-        mat4 mvp = canvas_mvp_get(transform, texture.size);
-        canvas_texture_draw(&self->canvas, shaderTexture, texture.id, mvp);
+        mat4 mvp = canvas_mvp_get(transform, texture->size);
+        canvas_texture_draw(&self->canvas, shaderTexture, texture->id, mvp);
 
         if (self->settings->editorIsBorder)
             canvas_rect_draw(&self->canvas, shaderLine, mvp, EDITOR_BORDER_COLOR);
@@ -26,7 +26,7 @@ void generate_preview_draw(GeneratePreview* self)
     canvas_clear(self->settings->previewBackgroundColor);
  
     Anm2Item* item = anm2_item_from_reference(self->anm2, self->reference);
-    Texture* texture = map_find(self->resources->textures, self->anm2->layers[self->reference->itemID].spritesheetID);
+    Texture* texture = resources_texture_get(self->resources, self->anm2->layers[self->reference->itemID].spritesheetID);
         
     if (item && texture && !texture->isInvalid)
     {
@@ -19,32 +19,51 @@ static bool _imgui_window_color_from_position_get(SDL_Window* self, const vec2&
     return true;
 }
 
+// Files already open are switched to; others open in a new tab, unless the current one is still untouched
 static void _imgui_anm2_new(Imgui* self, const std::string& path)
 {
+	s32 index = documents_find(self->documents, path);
+	s32 previousIndex = self->documents->index;
+	bool isNewTab = !self->anm2->path.empty() || !self->snapshots->undoStack.is_empty();
+
+	if (index != INDEX_NONE)
+	{
+		imgui_document_set(self, index);
+		return;
+	}
+
+	if (isNewTab) imgui_document_set(self, documents_add(self->documents));
+
 	*self->reference = Anm2Reference{};
 	resources_textures_free(self->resources);
-	if (anm2_deserialize(self->anm2, self->resources, path))
+	if (anm2_deserialize(self->anm2, self->resources, path, settings_anm2_read_type_get(self->settings)))
 	{
+		if (self->settings->fileIsCompact) anm2_animations_compact(self->anm2);
 		window_title_from_path_set(self->window, path);
 		snapshots_reset(self->snapshots);
 		imgui_log_push(self, std::format(IMGUI_LOG_FILE_OPEN_FORMAT, path));
 	}
 	else
+	{
 		imgui_log_push(self, std::format(IMGUI_LOG_FILE_OPEN_FORMAT, path));
+
+		if (isNewTab)
+		{
+			imgui_document_remove(self, self->documents->index);
+			imgui_document_set(self, previousIndex);
+		}
+	}
 }
 
 static void _imgui_spritesheet_add(Imgui* self, const std::string& path)
 {
-	std::filesystem::path workingPath = std::filesystem::current_path();
-	std::string anm2WorkingPath = working_directory_from_file_set(self->anm2->path);
-	std::string spritesheetPath = std::filesystem::relative(path, anm2WorkingPath).string();
+	std::string directory = path_directory_get(self->anm2->path);
+	std::string spritesheetPath = std::filesystem::relative(path, directory).string();
 
 	s32 id = map_next_id_get(self->resources->textures);
 	self->anm2->spritesheets[id] = Anm2Spritesheet{};
 	self->anm2->spritesheets[id].path = spritesheetPath;
-	resources_texture_init(self->resources, spritesheetPath, id);
-	
-	std::filesystem::current_path(workingPath);
+	resources_texture_init(self->resources, spritesheetPath, id, directory);
 }
 
 template<typename T>
@@ -68,6 +87,20 @@ static bool _imgui_is_input_begin(void)
 	return ImGui::IsItemHovered() && (ImGui::IsKeyPressed(IMGUI_INPUT_RENAME) || ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left));
 }
 
+// Any held key, mouse button or active widget; the document only ever changes in response to one
+static bool _imgui_is_input(void)
+{
+	if (ImGui::IsAnyItemActive()) return true;
+
+	for (s32 i = 0; i < ImGuiMouseButton_COUNT; i++)
+		if (ImGui::IsMouseDown(i)) return true;
+
+	for (s32 key = ImGuiKey_NamedKey_BEGIN; key < ImGuiKey_NamedKey_END; key++)
+		if (ImGui::IsKeyDown((ImGuiKey)key)) return true;
+
+	return false;
+}
+
 static bool _imgui_is_input_default(void)
 {
 	return ImGui::IsItemHovered() && (ImGui::IsKeyPressed(IMGUI_INPUT_DEFAULT) || ImGui::IsMouseClicked(IMGUI_MOUSE_DEFAULT));
@@ -854,7 +887,11 @@ static void _imgui_timeline(Imgui* self)
 		}
 		
 		const ImguiItem& visibleItem = item->isVisible ? IMGUI_TIMELINE_ITEM_VISIBLE : IMGUI_TIMELINE_ITEM_INVISIBLE;
-		if (_imgui_atlas_button(visibleItem, self)) item->isVisible = !item->isVisible;
+		if (_imgui_atlas_button(visibleItem, self))
+		{
+			item->isVisible = !item->isVisible;
+			imgui_anm2_item_dirty_set(self, &reference);
+		}
 
 		ImGui::PopStyleVar(2);
 		
@@ -887,8 +924,6 @@ static void _imgui_timeline(Imgui* self)
 
 		if (isItemSwap)
 		{
-			Anm2Animation* animation = anm2_animation_from_reference(self->anm2, self->reference);
-
 			switch (swapItemReference.itemType)
 			{
 				case ANM2_LAYER:
@@ -909,8 +944,7 @@ static void _imgui_timeline(Imgui* self)
 					break;
 				}
 				case ANM2_NULL:
-					map_swap(self->anm2->nulls, self->reference->itemID, swapItemReference.itemID);
-					map_swap(animation->nullAnimations, self->reference->itemID, swapItemReference.itemID);
+					anm2_null_swap(self->anm2, self->reference->animationID, self->reference->itemID, swapItemReference.itemID);
 					break;
 				default:
 					break;
@@ -987,12 +1021,12 @@ static void _imgui_timeline(Imgui* self)
 
 		ImGui::SetCursorPos(startPos);
 
-		std::function<void(s32, Anm2Frame&)> timeline_item_frame = [&](s32 i, Anm2Frame& frame)
+		std::function<void(s32, const Anm2Frame&)> timeline_item_frame = [&](s32 i, const Anm2Frame& frame)
 		{
 			static s32 frameDelayStart{};
 			static f32 frameDelayTimeStart{};
 			const bool isModCtrl = ImGui::IsKeyDown(IMGUI_INPUT_CTRL);
-			static Anm2Frame* draggingFrame = nullptr;
+			static Anm2Reference draggingReference{}; // looked up again each use; the undo push shares the frame's buffer
 			static Anm2Type draggingFrameType = ANM2_NONE;
 
 			ImGui::PushID(i);
@@ -1023,7 +1057,7 @@ static void _imgui_timeline(Imgui* self)
 			{
 				if (type == ANM2_TRIGGERS || isModCtrl)
 				{
-					draggingFrame = &frame;
+					draggingReference = reference;
 					draggingFrameType = type;
 					*self->reference = reference;
 				}
@@ -1033,34 +1067,32 @@ static void _imgui_timeline(Imgui* self)
 				else if (isModCtrl)
 				{
 					imgui_undo_push(self, IMGUI_ACTION_FRAME_DELAY);
-					frameDelayStart = draggingFrame->delay;
+					frameDelayStart = frame.delay;
 					frameDelayTimeStart = frameTime;
 				}
 			}
 
+			Anm2Frame* draggingFrame = draggingFrameType == ANM2_NONE ? nullptr : anm2_frame_from_reference(self->anm2, &draggingReference);
+
 			if (draggingFrame)
 			{
+				s32 atFrame = draggingFrame->atFrame;
+				s32 delay = draggingFrame->delay;
+
 				if (draggingFrameType == ANM2_TRIGGERS)
 				{
 					draggingFrame->atFrame = std::max(frameTime, 0);
-					for (auto& frameCheck : animation->triggers.frames)
-					{
-						if (draggingFrame == &frameCheck) continue;
-						if (draggingFrame->atFrame == frameCheck.atFrame)
-						{
-							draggingFrame->atFrame++;
-							break;
-						}
-					}
+					if (anm2_trigger_is_at(&animation->triggers, draggingFrame->atFrame, draggingReference.frameIndex))
+						draggingFrame->atFrame++;
 				}
 				else if (isModCtrl)
 					draggingFrame->delay = std::max(frameDelayStart + (s32)(frameTime - frameDelayTimeStart), ANM2_FRAME_NUM_MIN);
 
+				if (draggingFrame->atFrame != atFrame || draggingFrame->delay != delay)
+					imgui_anm2_item_dirty_set(self, &draggingReference);
+
 				if (ImGui::IsMouseReleased(0))
-				{
-					draggingFrame = nullptr;
 					draggingFrameType = ANM2_NONE;
-				}
 			}
 			else
 			{
@@ -1090,6 +1122,9 @@ static void _imgui_timeline(Imgui* self)
 								*swapFrame = *dragFrame;
 								*dragFrame = oldFrame;
 
+								imgui_anm2_item_dirty_set(self, &reference);
+								imgui_anm2_item_dirty_set(self, &swapReference);
+
 								*self->reference = swapReference;
 							}
 						}
@@ -1103,7 +1138,8 @@ static void _imgui_timeline(Imgui* self)
 			ImGui::PopID();
 		};
 
-		for (auto [i, frame] : std::views::enumerate(item->frames))
+		// Read only; drawing shouldn't copy frames the undo history shares
+		for (auto [i, frame] : std::views::enumerate(item->frames.read()))
 			timeline_item_frame(i, frame);
 
 		_imgui_end_child(); // itemFramesChild
@@ -1186,6 +1222,10 @@ static void _imgui_timeline(Imgui* self)
 
 		anm2_reference_item_clear(self->reference);
 	}
+
+	// Adding or removing items moves the ones stored after them
+	frame = anm2_frame_from_reference(self->anm2, self->reference);
+	item = anm2_item_from_reference(self->anm2, self->reference);
 	
 	_imgui_end_child(); //IMGUI_TIMELINE_FOOTER_ITEM_CHILD
 	
@@ -1257,9 +1297,50 @@ static void _imgui_timeline(Imgui* self)
 	_imgui_end(); // IMGUI_TIMELINE
 }
 
+// One tab per open document; a tab is only switched to once the tab bar shows the active document,
+// so a switch made elsewhere (opening a file) isn't undone by the tab that was selected before it
+static void _imgui_documents(Imgui* self)
+{
+	static s32 tabIndex = INDEX_NONE;
+	Documents* documents = self->documents;
+	s32 closeIndex = INDEX_NONE;
+
+	ImGui::SameLine();
+
+	if (!ImGui::BeginTabBar(IMGUI_DOCUMENTS.label_get(), IMGUI_DOCUMENTS.flags)) return;
+
+	for (s32 i = 0; i < (s32)documents->documents.size(); i++)
+	{
+		bool isOpen = true;
+		ImGuiTabItemFlags flags = documents_is_modified(documents, i) ? ImGuiTabItemFlags_UnsavedDocument : ImGuiTabItemFlags_None;
+		std::string label = std::format(IMGUI_DOCUMENT_FORMAT, documents_name_get(documents, i), documents->documents[i].id);
+
+		if (i == documents->index && tabIndex != documents->index)
+			flags |= ImGuiTabItemFlags_SetSelected;
+
+		if (ImGui::BeginTabItem(label.c_str(), &isOpen, flags))
+		{
+			if (i != documents->index && tabIndex == documents->index)
+				imgui_document_set(self, i);
+
+			if (i == documents->index)
+				tabIndex = i;
+
+			ImGui::EndTabItem();
+		}
+
+		if (!isOpen) closeIndex = i;
+	}
+
+	ImGui::EndTabBar();
+
+	if (closeIndex != INDEX_NONE) imgui_document_close(self, closeIndex);
+}
+
 static void _imgui_taskbar(Imgui* self)
 {
 	static ImguiPopupState exitConfirmState = IMGUI_POPUP_STATE_CLOSED;
+	static ImguiPopupState closeConfirmState = IMGUI_POPUP_STATE_CLOSED;
 
 	ImGuiViewport* viewport = ImGui::GetMainViewport();
 	ImguiItem taskbar = IMGUI_TASKBAR;
@@ -1278,6 +1359,7 @@ static void _imgui_taskbar(Imgui* self)
 		_imgui_selectable(IMGUI_OPEN, self);
 		_imgui_selectable(IMGUI_SAVE, self);
 		_imgui_selectable(IMGUI_SAVE_AS, self);
+		_imgui_selectable(IMGUI_CLOSE, self);
 		_imgui_selectable(IMGUI_EXPLORE_ANM2_LOCATION, self);
 		_imgui_selectable(IMGUI_EXIT, self);
 		imgui_end_popup(self);
@@ -1291,9 +1373,8 @@ static void _imgui_taskbar(Imgui* self)
 
 	if (self->dialog->isSelected && self->dialog->type == DIALOG_ANM2_SAVE)
 	{
-		anm2_serialize(self->anm2, self->dialog->path);
+		imgui_anm2_save(self, self->dialog->path);
 		window_title_from_path_set(self->window, self->dialog->path);
-		imgui_log_push(self, std::format(IMGUI_LOG_FILE_SAVE_FORMAT, self->dialog->path));
 		dialog_reset(self->dialog);
 	}
 
@@ -1309,6 +1390,18 @@ static void _imgui_taskbar(Imgui* self)
 		case IMGUI_POPUP_STATE_CANCEL: self->isTryQuit = false; break;
 	}
 
+	if (self->closeIndex != INDEX_NONE) imgui_open_popup(IMGUI_CLOSE_CONFIRMATION.label);
+
+	_imgui_option_popup(IMGUI_CLOSE_CONFIRMATION, self, &closeConfirmState);
+
+	switch (closeConfirmState)
+	{
+		case IMGUI_POPUP_STATE_CONFIRM: imgui_document_remove(self, self->closeIndex); self->closeIndex = INDEX_NONE; break;
+		case IMGUI_POPUP_STATE_CLOSED:
+		case IMGUI_POPUP_STATE_CANCEL: self->closeIndex = INDEX_NONE; break;
+		default: break;
+	}
+
 	_imgui_selectable(IMGUI_WIZARD.copy({}), self);
 	
 	if (imgui_begin_popup(IMGUI_WIZARD.popup, self))
@@ -1600,17 +1693,13 @@ static void _imgui_taskbar(Imgui* self)
 			{
 				case RENDER_PNG:
 				{
-					std::filesystem::path workingPath = std::filesystem::current_path();
-					std::filesystem::current_path(path);
-
 					for (auto [i, frame] : std::views::enumerate(frames))
 					{
 						std::string framePath = std::vformat(format, std::make_format_args(i));
-						framePath = path_extension_change(framePath, RENDER_EXTENSIONS[type]);
+						framePath = path_resolve(path_extension_change(framePath, RENDER_EXTENSIONS[type]), path);
 						if (!frame.isInvalid) texture_from_gl_write(&frame, framePath);
 					}
 
-					std::filesystem::current_path(workingPath);
 					imgui_log_push(self, std::format(IMGUI_LOG_RENDER_ANIMATION_FRAMES_SAVE_FORMAT, path));
 					break;
 				}
@@ -1643,6 +1732,7 @@ static void _imgui_taskbar(Imgui* self)
 	{
 		_imgui_checkbox_selectable(IMGUI_ALWAYS_LOOP, self, self->settings->playbackIsLoop);
 		_imgui_checkbox_selectable(IMGUI_CLAMP_PLAYHEAD, self, self->settings->playbackIsClampPlayhead);
+		_imgui_checkbox_selectable(IMGUI_POSE_CACHE, self, self->settings->playbackIsPoseCache);
 		imgui_end_popup(self);
 	}
 
@@ -1651,8 +1741,19 @@ static void _imgui_taskbar(Imgui* self)
 	if (imgui_begin_popup(IMGUI_SETTINGS.popup, self, IMGUI_SETTINGS.popupSize))
 	{
 		if (_imgui_checkbox_selectable(IMGUI_VSYNC, self, self->settings->isVsync)) window_vsync_set(self->settings->isVsync);
+		_imgui_checkbox_selectable(IMGUI_FILE_CACHE, self, self->settings->fileIsCache);
+		_imgui_checkbox_selectable(IMGUI_FILE_LAZY, self, self->settings->fileIsLazy);
+		_imgui_checkbox_selectable(IMGUI_FILE_COMPACT, self, self->settings->fileIsCompact);
+		_imgui_checkbox_selectable(IMGUI_FILE_SAVE_BACKGROUND, self, self->settings->fileIsSaveBackground);
+		_imgui_checkbox_selectable(IMGUI_FILE_AUTOSAVE, self, self->settings->fileIsAutosave);
+		_imgui_input_int(IMGUI_FILE_AUTOSAVE_TIME, self, self->settings->fileAutosaveTime);
+		_imgui_input_int(IMGUI_HISTORY_MEMORY_BUDGET, self, self->settings->historyMemoryBudget);
+		_imgui_input_int(IMGUI_HISTORY_COMPRESSED_BUDGET, self, self->settings->historyCompressedBudget);
+		_imgui_checkbox_selectable(IMGUI_HISTORY_JOURNAL, self, self->settings->historyIsJournal);
 		imgui_end_popup(self);
 	}
+
+	_imgui_documents(self);
 	
 	_imgui_end();
 }
@@ -1688,6 +1789,15 @@ static void _imgui_tools(Imgui* self)
 			_imgui_atlas_button(item, self);
 		else
 			_imgui_color_edit4(item, self, self->settings->toolColor);
+
+		// Replaces the undo tooltip with one that also shows how much of the history is shared
+		if (i == TOOL_UNDO && ImGui::IsItemHovered(ImGuiHoveredFlags_DelayNormal))
+		{
+			SnapshotsMemory memory = snapshots_memory_get(self->snapshots);
+			ImGui::SetTooltip("%s", std::format(IMGUI_TOOL_UNDO_MEMORY_FORMAT, item.tooltip,
+				memory.sharedBytes / (1024.0 * 1024.0), memory.uniqueBytes / (1024.0 * 1024.0), memory.copiedBytes / (1024.0 * 1024.0),
+				memory.compressedBytes / (1024.0 * 1024.0), memory.spilledBytes / (1024.0 * 1024.0)).c_str());
+		}
 	
 		usedWidth += ImGui::GetItemRectSize().x + style.ItemSpacing.x;
 	}
@@ -1767,6 +1877,9 @@ static void _imgui_animations(Imgui* self)
 
 		if (self->anm2->animations.size() == 0)
 			self->anm2->defaultAnimationID = id;
+
+		// Adding moves the animations after it
+		animation = anm2_animation_from_reference(self->anm2, self->reference);
 	}
 
 	if (_imgui_button(IMGUI_ANIMATION_DUPLICATE.copy({!animation}), self))
@@ -1774,6 +1887,7 @@ static void _imgui_animations(Imgui* self)
 		s32 id = map_next_id_get(self->anm2->animations);
 		self->anm2->animations.insert({id, *animation});
 		self->reference->animationID = id;
+		animation = anm2_animation_from_reference(self->anm2, self->reference);
 	}
 
 	_imgui_button(IMGUI_ANIMATION_MERGE.copy({!animation}), self);
@@ -1941,6 +2055,8 @@ static void _imgui_events(Imgui* self)
 	{
 		std::unordered_set<s32> usedEventIDs;
 
+		anm2_animations_materialize(self->anm2);
+
 		for (auto& [id, animation] : self->anm2->animations)
 			for (auto& trigger : animation.triggers.frames)
 				if (trigger.eventID != ID_NONE)
@@ -1974,7 +2090,7 @@ static void _imgui_spritesheets(Imgui* self)
 	{
 		ImGui::PushID(id);
 		
-		Texture* texture = &self->resources->textures[id];
+		Texture* texture = resources_texture_get(self->resources, id);
 		bool isContains = selectedIDs.contains(id);
 		
 		_imgui_begin_child(IMGUI_SPRITESHEET_CHILD, self);
@@ -2012,14 +2128,14 @@ static void _imgui_spritesheets(Imgui* self)
 		}
 
 		ImVec2 spritesheetPreviewSize = IMGUI_SPRITESHEET_PREVIEW_SIZE;
-		f32 spritesheetAspect = (f32)self->resources->textures[id].size.x / self->resources->textures[id].size.y;
+		f32 spritesheetAspect = texture ? (f32)texture->size.x / texture->size.y : 1.0f;
 
 		if ((IMGUI_SPRITESHEET_PREVIEW_SIZE.x / IMGUI_SPRITESHEET_PREVIEW_SIZE.y) > spritesheetAspect)
 			spritesheetPreviewSize.x = IMGUI_SPRITESHEET_PREVIEW_SIZE.y * spritesheetAspect;
 		else
 			spritesheetPreviewSize.y = IMGUI_SPRITESHEET_PREVIEW_SIZE.x / spritesheetAspect;
 
-		if (texture->isInvalid)
+		if (!texture || texture->isInvalid)
 			_imgui_atlas(ATLAS_NONE, self);
 		else
 			ImGui::Image(texture->id, spritesheetPreviewSize);
@@ -2048,12 +2164,7 @@ static void _imgui_spritesheets(Imgui* self)
 	if (_imgui_button(IMGUI_SPRITESHEETS_RELOAD.copy({selectedIDs.empty()}), self))
 	{
 		for (auto& id : selectedIDs)
-		{
-			std::filesystem::path workingPath = std::filesystem::current_path();
-			working_directory_from_file_set(self->anm2->path);
-			resources_texture_init(self->resources, self->anm2->spritesheets[id].path, id);
-			std::filesystem::current_path(workingPath);
-		}
+			resources_texture_init(self->resources, self->anm2->spritesheets[id].path, id, path_directory_get(self->anm2->path));
 	}
 
 	if (_imgui_button(IMGUI_SPRITESHEETS_REPLACE.copy({highlightedID == ID_NONE}), self))
@@ -2061,15 +2172,12 @@ static void _imgui_spritesheets(Imgui* self)
 
 	if (self->dialog->isSelected && self->dialog->type == DIALOG_SPRITESHEET_REPLACE)
 	{
-		std::filesystem::path workingPath = std::filesystem::current_path();
-		std::string anm2WorkingPath = working_directory_from_file_set(self->anm2->path);
-		std::string spritesheetPath = std::filesystem::relative(self->dialog->path, anm2WorkingPath).string();
+		std::string directory = path_directory_get(self->anm2->path);
+		std::string spritesheetPath = std::filesystem::relative(self->dialog->path, directory).string();
 	
 		self->anm2->spritesheets[self->dialog->replaceID].path = spritesheetPath;
-		resources_texture_init(self->resources, spritesheetPath, self->dialog->replaceID);
+		resources_texture_init(self->resources, spritesheetPath, self->dialog->replaceID, directory);
 		dialog_reset(self->dialog);
-
-		std::filesystem::current_path(workingPath);
 	}
 
 	if (_imgui_button(IMGUI_SPRITESHEETS_REMOVE_UNUSED.copy({self->anm2->spritesheets.empty()}), self))
@@ -2084,8 +2192,8 @@ static void _imgui_spritesheets(Imgui* self)
 		{
 			if (!usedSpritesheetIDs.count(it->first))
 			{
+				resources_texture_release(self->resources, it->first);
 				it = self->anm2->spritesheets.erase(it);
-				texture_free(&self->resources->textures[it->first]);
 			}
 			else
 				it++;
@@ -2104,12 +2212,10 @@ static void _imgui_spritesheets(Imgui* self)
 		for (auto& id : selectedIDs)
 		{
 			Anm2Spritesheet* spritesheet = &self->anm2->spritesheets[id];
-			Texture* texture = &self->resources->textures[id];
-			std::filesystem::path workingPath = std::filesystem::current_path();
-			working_directory_from_file_set(self->anm2->path);
-			texture_from_gl_write(texture, spritesheet->path);
+			Texture* texture = resources_texture_get(self->resources, id);
+			if (!texture) continue;
+			texture_from_gl_write(texture, path_resolve(spritesheet->path, path_directory_get(self->anm2->path)));
 			imgui_log_push(self, std::format(IMGUI_LOG_SPRITESHEET_SAVE_FORMAT, id, spritesheet->path));
-			std::filesystem::current_path(workingPath);
 		}
 	}
 
@@ -2256,6 +2362,7 @@ static void _imgui_animation_preview(Imgui* self)
 	if (frame)
 	{
 		f32 step = isMod ? TOOL_STEP_MOD : TOOL_STEP;
+		Anm2Frame oldFrame = *frame;
 		
 		switch (tool)
 		{
@@ -2293,6 +2400,8 @@ static void _imgui_animation_preview(Imgui* self)
 			default:
 				break;
 		}
+
+		if (*frame != oldFrame) imgui_anm2_item_dirty_set(self, self->reference);
 	}
 
 	if (mouseWheel != 0 || isZoomIn || isZoomOut)
@@ -2377,7 +2486,7 @@ static void _imgui_spritesheet_editor(Imgui* self)
 	if (self->reference->itemType == ANM2_LAYER) 
 		frame = anm2_frame_from_reference(self->anm2, self->reference);
 
-	Texture* texture = map_find(self->resources->textures, self->editor->spritesheetID);
+	Texture* texture = resources_texture_get(self->resources, self->editor->spritesheetID);
 
 	vec2 position = mousePos;
 
@@ -2398,11 +2507,16 @@ static void _imgui_spritesheet_editor(Imgui* self)
 			if (isMouseClick)
 			{
 				imgui_undo_push(self, IMGUI_ACTION_FRAME_CROP);
+				frame = anm2_frame_from_reference(self->anm2, self->reference); // the push shared the old one
 				frame->crop = position;
 				frame->size = ivec2(0,0);
+				imgui_anm2_item_dirty_set(self, self->reference);
 			}
-			else if (isMouseDown)
+			else if (isMouseDown && frame->size != position - frame->crop)
+			{
 				frame->size = position - frame->crop;
+				imgui_anm2_item_dirty_set(self, self->reference);
+			}
 			break;
 		case TOOL_DRAW:
 		case TOOL_ERASE:
@@ -2445,6 +2559,7 @@ static void _imgui_frame_properties(Imgui* self)
 	IMGUI_BEGIN_OR_RETURN(IMGUI_FRAME_PROPERTIES, self);
 
 	Anm2Frame* frame = anm2_frame_from_reference(self->anm2, self->reference);
+	Anm2Frame oldFrame = frame ? *frame : Anm2Frame{};
 	
 	bool isLayerFrame = frame && type == ANM2_LAYER;
 	
@@ -2486,6 +2601,9 @@ static void _imgui_frame_properties(Imgui* self)
 		_imgui_input_int(IMGUI_FRAME_PROPERTIES_AT_FRAME.copy({!frame}), self, frame->atFrame);
 	}
 
+	// The widgets report activation (for the undo push) rather than change, so the frame is compared instead
+	if (frame && *frame != oldFrame) imgui_anm2_item_dirty_set(self, self->reference);
+
 	_imgui_end(); // IMGUI_FRAME_PROPERTIES
 }
 
@@ -2554,6 +2672,31 @@ static void _imgui_dock(Imgui* self)
 	_imgui_end(); // IMGUI_WINDOW_MAIN 
 }
 
+// Every so often, each changed document with a file is saved in the background. Only done between gestures, so
+// no edit is saved halfway through
+static void _imgui_autosave(Imgui* self)
+{
+	u64 tick = SDL_GetTicks();
+
+	if (!self->settings->fileIsAutosave)
+	{
+		self->autosaveTick = tick;
+		return;
+	}
+
+	if (tick - self->autosaveTick < (u64)std::max(1, self->settings->fileAutosaveTime) * 1000) return;
+
+	self->autosaveTick = tick;
+
+	for (s32 i = 0; i < (s32)self->documents->documents.size(); i++)
+	{
+		const std::string& path = documents_anm2_get(self->documents, i)->path;
+
+		if (!path.empty() && documents_is_changed(self->documents, i))
+			documents_save(self->documents, self->saves, i, path);
+	}
+}
+
 void imgui_init
 (
     Imgui* self,
@@ -2566,6 +2709,8 @@ void imgui_init
     GeneratePreview* generatePreview,
     Settings* settings,
     Snapshots* snapshots,
+    Documents* documents,
+    Saves* saves,
     Clipboard* clipboard,
     SDL_Window* window,
     SDL_GLContext* glContext
@@ -2582,6 +2727,8 @@ void imgui_init
 	self->generatePreview = generatePreview;
 	self->settings = settings;
 	self->snapshots = snapshots;
+	self->documents = documents;
+	self->saves = saves;
 	self->clipboard = clipboard;
 	self->window = window;
 	self->glContext = glContext;
@@ -2662,6 +2809,23 @@ void imgui_update(Imgui* self)
 		}
 	}
 
+	// Once the gesture that pushed an undo step is over (and no popup could still be filling it in), it's
+	// committed; a step that changed nothing is dropped there
+	if (!_imgui_is_input() && !ImGui::IsPopupOpen("", ImGuiPopupFlags_AnyPopupId | ImGuiPopupFlags_AnyPopupLevel) && self->pendingPopup.empty())
+	{
+		imgui_undo_commit(self);
+		_imgui_autosave(self);
+	}
+
+	for (Save& save : saves_finished_get(self->saves))
+	{
+		documents_save_finish(self->documents, &save);
+
+		if (save.isSuccess)
+			imgui_log_push(self, std::format(IMGUI_LOG_FILE_SAVE_FORMAT, save.path));
+		else
+			imgui_log_push(self, std::format(IMGUI_LOG_FILE_SAVE_ERROR_FORMAT, save.path));
+	}
 }
 
 void imgui_draw(void)
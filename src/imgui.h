@@ -2,6 +2,7 @@
 
 #include "clipboard.h"
 #include "dialog.h"
+#include "document.h"
 #include "editor.h"
 #include "ffmpeg.h"
 #include "preview.h"
@@ -74,6 +75,7 @@
 
 #define IMGUI_LOG_FILE_OPEN_FORMAT "Opened anm2: {}" 
 #define IMGUI_LOG_FILE_SAVE_FORMAT "Saved anm2 to: {}" 
+#define IMGUI_LOG_FILE_SAVE_ERROR_FORMAT "Failed to save anm2 to: {}"
 #define IMGUI_LOG_RENDER_ANIMATION_FRAMES_SAVE_FORMAT "Saved rendered frames to: {}" 
 #define IMGUI_LOG_RENDER_ANIMATION_SAVE_FORMAT "Saved rendered animation to: {}" 
 #define IMGUI_LOG_RENDER_ANIMATION_NO_ANIMATION_ERROR "No animation selected; rendering cancelled."
@@ -184,6 +186,8 @@ struct Imgui
     GeneratePreview* generatePreview = nullptr;
     Settings* settings = nullptr;
     Snapshots* snapshots = nullptr;
+    Documents* documents = nullptr;
+    Saves* saves = nullptr;
     Clipboard* clipboard = nullptr;
     SDL_Window* window = nullptr;
     SDL_GLContext* glContext = nullptr;
@@ -197,6 +201,8 @@ struct Imgui
     bool isContextualActionsEnabled = true;
     bool isQuit = false;
     bool isTryQuit = false;
+    s32 closeIndex = INDEX_NONE; // document waiting on the close confirmation
+    u64 autosaveTick{};
 };
 
 typedef void(*ImguiFunction)(Imgui*);
@@ -218,17 +224,51 @@ static void imgui_log_push(Imgui* self, const std::string& text)
     log_imgui(text);
 }
 
+// Widgets edit frames in place; whichever changed one dirties just that item, so the others' tracks and cached poses stay
+static inline void imgui_anm2_item_dirty_set(Imgui* self, Anm2Reference* reference)
+{
+    Anm2Animation* animation = anm2_animation_from_reference(self->anm2, reference);
+    Anm2Item* item = anm2_item_from_reference(self->anm2, reference);
+
+    if (animation && item) anm2_animation_item_dirty_set(animation, item);
+}
+
 static std::vector<ImguiHotkey>& imgui_hotkey_registry()
 {
     static std::vector<ImguiHotkey> registry;
     return registry;
 }
 
+static inline void imgui_document_set(Imgui* self, s32 index)
+{
+    documents_set(self->documents, index);
+    window_title_from_path_set(self->window, self->anm2->path);
+}
+
+static inline void imgui_document_remove(Imgui* self, s32 index)
+{
+    documents_remove(self->documents, index);
+    window_title_from_path_set(self->window, self->anm2->path);
+}
+
+// Documents with changes are only closed once confirmed
+static inline void imgui_document_close(Imgui* self, s32 index)
+{
+    if (documents_is_modified(self->documents, index))
+        self->closeIndex = index;
+    else
+        imgui_document_remove(self, index);
+}
+
 static inline void imgui_file_new(Imgui* self)
 {
-    anm2_reference_clear(self->reference);
+    imgui_document_set(self, documents_add(self->documents));
 	anm2_new(self->anm2);
-    resources_textures_free(self->resources);
+}
+
+static inline void imgui_file_close(Imgui* self)
+{
+    imgui_document_close(self, self->documents->index);
 }
 
 static inline void imgui_file_open(Imgui* self)
@@ -236,15 +276,19 @@ static inline void imgui_file_open(Imgui* self)
     dialog_anm2_open(self->dialog);
 }
 
+// Written in the background; unless set to, this waits for it. Either way it's logged once written
+static inline void imgui_anm2_save(Imgui* self, const std::string& path)
+{
+    documents_save(self->documents, self->saves, self->documents->index, path);
+    if (!self->settings->fileIsSaveBackground) saves_wait(self->saves);
+}
+
 static inline void imgui_file_save(Imgui* self)
 {
     if (self->anm2->path.empty())
 		dialog_anm2_save(self->dialog);
 	else 
-    {
-		anm2_serialize(self->anm2, self->anm2->path);
-        imgui_log_push(self, std::format(IMGUI_LOG_FILE_SAVE_FORMAT, self->anm2->path));
-    }
+        imgui_anm2_save(self, self->anm2->path);
 }
 
 static inline void imgui_file_save_as(Imgui* self)
@@ -254,7 +298,7 @@ static inline void imgui_file_save_as(Imgui* self)
 
 static inline void imgui_quit(Imgui* self)
 {
-    if (!self->snapshots->undoStack.is_empty())
+    if (documents_is_any_modified(self->documents))
         self->isTryQuit = true;
     else
         self->isQuit = true;
@@ -269,8 +313,16 @@ static inline void imgui_explore(Imgui* self)
 
 static inline void imgui_undo_push(Imgui* self, const std::string& action = SNAPSHOT_ACTION)
 {
-    Snapshot snapshot = {*self->anm2, *self->reference, self->preview->time, action};
-    snapshots_undo_push(self->snapshots, &snapshot);
+    self->snapshots->isCompact = self->settings->fileIsCompact;
+    self->snapshots->memoryBudget = (s64)self->settings->historyMemoryBudget << 20;
+    self->snapshots->compressedBudget = (s64)self->settings->historyCompressedBudget << 20;
+    self->snapshots->isJournal = self->settings->historyIsJournal;
+    snapshots_undo_push(self->snapshots, action);
+}
+
+static inline void imgui_undo_commit(Imgui* self)
+{
+    snapshots_undo_commit(self->snapshots);
 }
 
 static inline void imgui_tool_pan_set(Imgui* self)
@@ -315,7 +367,7 @@ static inline void imgui_tool_color_picker_set(Imgui* self)
 
 static inline void imgui_undo(Imgui* self)
 {
-    if (self->snapshots->undoStack.top == 0) return;
+    if (self->snapshots->undoStack.is_empty()) return;
 
     snapshots_undo(self->snapshots);
     imgui_log_push(self, std::format(IMGUI_LOG_UNDO_FORMAT, self->snapshots->action));
@@ -323,7 +375,7 @@ static inline void imgui_undo(Imgui* self)
 
 static inline void imgui_redo(Imgui* self)
 {
-    if (self->snapshots->redoStack.top == 0) return;
+    if (self->snapshots->redoStack.is_empty()) return;
     
     std::string action = self->snapshots->action;
     snapshots_redo(self->snapshots);
@@ -666,6 +718,15 @@ IMGUI_ITEM(IMGUI_SAVE_AS,
     self.isShortcutInLabel = true
 );
 
+IMGUI_ITEM(IMGUI_CLOSE,
+    self.label = "&Close         ",
+    self.tooltip = "Closes the current .anm2 file's tab.",
+    self.function = imgui_file_close,
+    self.chord = ImGuiMod_Ctrl | ImGuiKey_W,
+    self.isSizeToText = true,
+    self.isShortcutInLabel = true
+);
+
 IMGUI_ITEM(IMGUI_EXPLORE_ANM2_LOCATION,
     self.label = "E&xplore Anm2 Location",
     self.tooltip = "Open the system's file explorer in the anm2's path.",
@@ -688,6 +749,17 @@ IMGUI_ITEM(IMGUI_EXIT_CONFIRMATION,
     self.text = "Unsaved changes will be lost!\nAre you sure you want to exit?"
 );
 
+IMGUI_ITEM(IMGUI_CLOSE_CONFIRMATION,
+    self.label = "Close Confirmation",
+    self.text = "Unsaved changes will be lost!\nAre you sure you want to close this file?"
+);
+
+#define IMGUI_DOCUMENT_FORMAT "{}###Document{}"
+IMGUI_ITEM(IMGUI_DOCUMENTS,
+    self.label = "## Documents",
+    self.flags = ImGuiTabBarFlags_FittingPolicyScroll
+);
+
 IMGUI_ITEM(IMGUI_WIZARD,
     self.label = "&Wizard",
     self.tooltip = "Opens the wizard menu, for neat functions related to the .anm2.",
@@ -993,6 +1065,12 @@ IMGUI_ITEM(IMGUI_CLAMP_PLAYHEAD,
     self.isSizeToText = true
 );
 
+IMGUI_ITEM(IMGUI_POSE_CACHE,
+    self.label = "Cache &Poses",
+    self.tooltip = "Keep the previewed and overlaid animations' poses at each frame once drawn, so looping playback doesn't work them out again.\nAn edited item's poses are worked out again; very long animations with many items aren't kept.",
+    self.isSizeToText = true
+);
+
 IMGUI_ITEM(IMGUI_SETTINGS,
     self.label = "&Settings",
     self.tooltip = "Opens the setting menu, for configuring general program settings.",
@@ -1007,6 +1085,70 @@ IMGUI_ITEM(IMGUI_VSYNC,
     self.isSizeToText = true
 );
 
+IMGUI_ITEM(IMGUI_FILE_CACHE,
+    self.label = "&Binary Cache",
+    self.tooltip = "Keep a binary copy of opened files in the settings directory, so reopening large files skips parsing.\nThe copy is refreshed on save and ignored whenever the file changes.",
+    self.isSizeToText = true
+);
+
+IMGUI_ITEM(IMGUI_FILE_LAZY,
+    self.label = "&Lazy Loading",
+    self.tooltip = "Open files reading only each animation's name and length; frames are read when the animation is first used.\nAnimations left untouched are saved back exactly as they were.\nTakes precedence over the binary cache.",
+    self.isSizeToText = true
+);
+
+IMGUI_ITEM(IMGUI_FILE_COMPACT,
+    self.label = "&Compact Memory",
+    self.tooltip = "Keep animations that aren't being used, and undo history, in a packed form that takes several times less memory.\nAnimations are unpacked when first used again; saved files are unchanged.",
+    self.isSizeToText = true
+);
+
+IMGUI_ITEM(IMGUI_FILE_SAVE_BACKGROUND,
+    self.label = "&Save in Background",
+    self.tooltip = "Write saved files on a separate thread, so editing carries on while large files are written.\nThe file is saved as it was when the save was made.",
+    self.isSizeToText = true
+);
+
+IMGUI_ITEM(IMGUI_FILE_AUTOSAVE,
+    self.label = "&Autosave",
+    self.tooltip = "Save changed documents that already have a file every so often, in the background.\nUntitled documents aren't autosaved.",
+    self.isSizeToText = true
+);
+
+#define IMGUI_FILE_AUTOSAVE_TIME_MAX 3600
+
+IMGUI_ITEM(IMGUI_FILE_AUTOSAVE_TIME,
+    self.label = "Autosave Interval (s)",
+    self.tooltip = "How long to wait between autosaves.",
+    self.min = 1,
+    self.max = IMGUI_FILE_AUTOSAVE_TIME_MAX,
+    self.value = 60
+);
+
+#define IMGUI_HISTORY_BUDGET_MAX 65536
+
+IMGUI_ITEM(IMGUI_HISTORY_MEMORY_BUDGET,
+    self.label = "History Memory (MB)",
+    self.tooltip = "How much memory undo history may take before older steps are compressed.\nRecent steps are always kept as they are, so undoing them stays instant.",
+    self.min = 0,
+    self.max = IMGUI_HISTORY_BUDGET_MAX,
+    self.value = 256
+);
+
+IMGUI_ITEM(IMGUI_HISTORY_COMPRESSED_BUDGET,
+    self.label = "Compressed History (MB)",
+    self.tooltip = "How much memory compressed undo history may take before the oldest steps are moved to a file in the settings directory.\nThere's no limit on how many steps can be undone.",
+    self.min = 0,
+    self.max = IMGUI_HISTORY_BUDGET_MAX,
+    self.value = 256
+);
+
+IMGUI_ITEM(IMGUI_HISTORY_JOURNAL,
+    self.label = "Crash &Recovery",
+    self.tooltip = "Keep a journal of each document's edits in the settings directory, so they can be recovered if the program crashes.\nRecovered documents open on the next start; undo the recovery to go back to the saved file.",
+    self.isSizeToText = true
+);
+
 IMGUI_ITEM(IMGUI_ANIMATIONS, 
     self.label = "Animations",
     self.flags = ImGuiWindowFlags_NoScrollbar       |
@@ -1548,6 +1690,7 @@ IMGUI_ITEM(IMGUI_TOOL_COLOR_PICKER,
     self.atlas = ATLAS_COLOR_PICKER
 );
 
+#define IMGUI_TOOL_UNDO_MEMORY_FORMAT "{}\nHistory frame data: {:.2f} MB shared, {:.2f} MB unique ({:.2f} MB if copied)\nOlder steps: {:.2f} MB compressed, {:.2f} MB on disk"
 IMGUI_ITEM(IMGUI_TOOL_UNDO,
     self.label = "## Undo",
     self.tooltip = "Undoes the last action.",
@@ -2062,6 +2205,8 @@ void imgui_init
     GeneratePreview* generatePreview,
     Settings* settings,
     Snapshots* snapshots,
+    Documents* documents,
+    Saves* saves,
     Clipboard* clipboard,
     SDL_Window* window,
     SDL_GLContext* glContext
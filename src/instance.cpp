@@ -0,0 +1,165 @@
+#include "instance.h"
+
+#include "log.h"
+
+#if defined(_WIN32)
+  #define WIN32_LEAN_AND_MEAN
+  #define NOMINMAX
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/file.h>
+  #include <unistd.h>
+#endif
+
+#if defined(_WIN32)
+typedef HANDLE InstanceLock;
+#define INSTANCE_LOCK_NONE INVALID_HANDLE_VALUE
+#else
+typedef s32 InstanceLock;
+#define INSTANCE_LOCK_NONE -1
+#endif
+
+static std::string _instance_lock_path_get(const std::string& id)
+{
+	return preferences_path_get() + INSTANCE_DIRECTORY + "/" + id + INSTANCE_EXTENSION;
+}
+
+// Opens and exclusively locks path without waiting, creating it if need be. Locks are per open file, so one this
+// process already holds through another open fails too
+static InstanceLock _instance_lock(const std::string& path)
+{
+#if defined(_WIN32)
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) return INSTANCE_LOCK_NONE;
+
+	OVERLAPPED overlapped{};
+	if (!LockFileEx(file, LOCKFILE_EXCLUSIVE_LOCK | LOCKFILE_FAIL_IMMEDIATELY, 0, 1, 0, &overlapped))
+	{
+		CloseHandle(file);
+		return INSTANCE_LOCK_NONE;
+	}
+
+	return file;
+#else
+	s32 file = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+	if (file < 0) return INSTANCE_LOCK_NONE;
+
+	if (flock(file, LOCK_EX | LOCK_NB) != 0)
+	{
+		close(file);
+		return INSTANCE_LOCK_NONE;
+	}
+
+	return file;
+#endif
+}
+
+static void _instance_unlock(InstanceLock lock)
+{
+#if defined(_WIN32)
+	CloseHandle(lock);
+#else
+	close(lock);
+#endif
+}
+
+static u64 _instance_process_id_get(void)
+{
+#if defined(_WIN32)
+	return (u64)GetCurrentProcessId();
+#else
+	return (u64)getpid();
+#endif
+}
+
+// Lock files of instances that are gone; any files still named after them count as left behind all the same
+static void _instance_locks_clear(void)
+{
+	std::error_code errorCode;
+
+	for (auto& entry : std::filesystem::directory_iterator(preferences_path_get() + INSTANCE_DIRECTORY, errorCode))
+	{
+		if (entry.path().extension() != INSTANCE_EXTENSION) continue;
+
+		InstanceLock lock = _instance_lock(entry.path().string());
+		if (lock == INSTANCE_LOCK_NONE) continue;
+
+		std::filesystem::remove(entry.path(), errorCode);
+		_instance_unlock(lock);
+	}
+}
+
+// Made and locked on first use, clearing the lock files of instances that are gone; the lock is held until the
+// process exits. One removed by another instance's clearing before it was locked is made again
+const std::string& instance_id_get(void)
+{
+	static const std::string id = []
+	{
+		std::error_code errorCode;
+
+		std::filesystem::create_directories(preferences_path_get() + INSTANCE_DIRECTORY, errorCode);
+		_instance_locks_clear();
+
+		std::string id;
+
+		for (s32 i = 0; i < INSTANCE_LOCK_ATTEMPTS; i++)
+		{
+			u64 time = (u64)std::chrono::system_clock::now().time_since_epoch().count();
+			id = std::format("{:016x}{:08x}", time, _instance_process_id_get());
+
+			std::string path = _instance_lock_path_get(id);
+			InstanceLock lock = _instance_lock(path);
+
+			if (lock == INSTANCE_LOCK_NONE) continue;
+			if (std::filesystem::exists(path, errorCode)) return id;
+
+			_instance_unlock(lock);
+		}
+
+		log_warning(std::format(INSTANCE_LOCK_ERROR, _instance_lock_path_get(id)));
+		return id;
+	}();
+
+	return id;
+}
+
+// A new file's path in directory, named for when it was made (so names sort oldest first) and for this instance
+std::string instance_path_get(const std::string& directory, const std::string& extension)
+{
+	static std::atomic<u64> fileID{};
+	u64 time = (u64)std::chrono::system_clock::now().time_since_epoch().count();
+	std::string path = preferences_path_get() + directory + "/" +
+		std::format("{:016x}{:04x}{}{}", time, (u16)++fileID, INSTANCE_SEPARATOR, instance_id_get()) + extension;
+	std::error_code errorCode;
+
+	std::filesystem::create_directories(std::filesystem::path(path).parent_path(), errorCode);
+
+	return path;
+}
+
+// Whether the instance a file from instance_path_get was made by still runs. Files named otherwise, or whose
+// instance's lock can be taken, were left by one that's gone; the lock file of one found gone is removed
+bool instance_path_is_live(const std::string& path)
+{
+	std::string name = std::filesystem::path(path).stem().string();
+	size_t separator = name.rfind(INSTANCE_SEPARATOR);
+
+	if (separator == std::string::npos) return false;
+
+	std::string id = name.substr(separator + 1);
+	std::string lockPath = _instance_lock_path_get(id);
+	std::error_code errorCode;
+
+	if (id == instance_id_get()) return true;
+	if (!std::filesystem::exists(lockPath, errorCode)) return false;
+
+	InstanceLock lock = _instance_lock(lockPath);
+
+	if (lock == INSTANCE_LOCK_NONE) return true;
+
+	std::filesystem::remove(lockPath, errorCode);
+	_instance_unlock(lock);
+	return false;
+}
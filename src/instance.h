@@ -0,0 +1,17 @@
+// The running instance; files it keeps in the preferences directory while it runs (crash-recovery journals, spilled
+// undo history) are named after it, and it holds a lock on a file of its own until it exits. The lock goes with the
+// process, crash or not, so another instance can tell a live one's files from those a crash left behind
+
+#pragma once
+
+#include "COMMON.h"
+
+#define INSTANCE_DIRECTORY "instances"
+#define INSTANCE_EXTENSION ".lock"
+#define INSTANCE_SEPARATOR '-' // between a file's own name and its instance's
+#define INSTANCE_LOCK_ATTEMPTS 4
+#define INSTANCE_LOCK_ERROR "Unable to lock {}; other instances may take this one's journals and history for a crash's"
+
+const std::string& instance_id_get(void);
+std::string instance_path_get(const std::string& directory, const std::string& extension);
+bool instance_path_is_live(const std::string& path);
@@ -0,0 +1,603 @@
+#include "journal.h"
+
+#include "anm2_writer.h"
+#include "instance.h"
+
+static_assert(std::is_trivially_copyable_v<Anm2Frame>, "Anm2Frame is stored in the journal as raw bytes");
+
+/* Encoding */
+
+template <typename T>
+static void _journal_put(std::string* out, const T& value)
+{
+	out->append((const char*)&value, sizeof(T));
+}
+
+static void _journal_string_put(std::string* out, const std::string& string)
+{
+	_journal_put(out, (u32)string.size());
+	out->append(string);
+}
+
+static void _journal_header_put(std::string* out, const Anm2& anm2)
+{
+	_journal_string_put(out, anm2.path);
+	_journal_string_put(out, anm2.createdBy);
+	_journal_string_put(out, anm2.createdOn);
+	_journal_put(out, anm2.version);
+	_journal_put(out, anm2.fps);
+	_journal_put(out, anm2.defaultAnimationID);
+
+	_journal_put(out, (u32)anm2.spritesheets.size());
+	for (auto& [id, spritesheet] : anm2.spritesheets)
+	{
+		_journal_put(out, id);
+		_journal_string_put(out, spritesheet.path);
+	}
+
+	_journal_put(out, (u32)anm2.layers.size());
+	for (auto& [id, layer] : anm2.layers)
+	{
+		_journal_put(out, id);
+		_journal_put(out, layer.spritesheetID);
+		_journal_string_put(out, layer.name);
+	}
+
+	_journal_put(out, (u32)anm2.nulls.size());
+	for (auto& [id, null] : anm2.nulls)
+	{
+		_journal_put(out, id);
+		_journal_put(out, (u8)null.isShowRect);
+		_journal_string_put(out, null.name);
+	}
+
+	_journal_put(out, (u32)anm2.events.size());
+	for (auto& [id, event] : anm2.events)
+	{
+		_journal_put(out, id);
+		_journal_string_put(out, event.name);
+	}
+
+	_journal_put(out, (u32)anm2.layerMap.size());
+	for (auto& [index, id] : anm2.layerMap)
+	{
+		_journal_put(out, index);
+		_journal_put(out, id);
+	}
+}
+
+static void _journal_item_put(std::string* out, const Anm2Item& item)
+{
+	_journal_put(out, (u8)item.isVisible);
+	_journal_put(out, (u32)item.frames.size());
+	out->append((const char*)item.frames.data(), item.frames.size() * sizeof(Anm2Frame));
+}
+
+// Packed children are stored as they are and decoded on first use after a replay, like any packed animation.
+// Unread ones are read first, as the file they'd be read from may since have changed
+static void _journal_animation_put(std::string* out, const Anm2Animation& entry)
+{
+	_journal_string_put(out, entry.name);
+	_journal_put(out, entry.frameNum);
+	_journal_put(out, (u8)entry.isLoop);
+	_journal_put(out, (u8)(entry.packed != nullptr));
+
+	if (entry.packed)
+	{
+		_journal_put(out, (u32)entry.packed->size());
+		out->append((const char*)entry.packed->data(), entry.packed->size());
+		return;
+	}
+
+	Anm2Animation unread;
+	const Anm2Animation& animation = entry.source ? unread : entry;
+
+	if (entry.source)
+	{
+		unread = entry;
+		anm2_animation_materialize(&unread);
+	}
+
+	_journal_item_put(out, animation.rootAnimation);
+	_journal_item_put(out, animation.triggers);
+
+	_journal_put(out, (u32)animation.layerAnimations.size());
+	for (auto& [id, item] : animation.layerAnimations)
+	{
+		_journal_put(out, id);
+		_journal_item_put(out, item);
+	}
+
+	_journal_put(out, (u32)animation.nullAnimations.size());
+	for (auto& [id, item] : animation.nullAnimations)
+	{
+		_journal_put(out, id);
+		_journal_item_put(out, item);
+	}
+}
+
+/* Decoding */
+
+struct JournalReader
+{
+	const u8* data = nullptr;
+	size_t size = 0;
+	size_t offset = 0;
+	bool isValid = true; // cleared by any read past the end; everything read after is zeroed
+};
+
+template <typename T>
+static T _journal_get(JournalReader* self)
+{
+	T value{};
+
+	if (!self->isValid || self->size - self->offset < sizeof(T))
+	{
+		self->isValid = false;
+		return value;
+	}
+
+	memcpy(&value, self->data + self->offset, sizeof(T));
+	self->offset += sizeof(T);
+	return value;
+}
+
+static const u8* _journal_bytes_get(JournalReader* self, size_t size)
+{
+	if (!self->isValid || self->size - self->offset < size)
+	{
+		self->isValid = false;
+		return nullptr;
+	}
+
+	const u8* bytes = self->data + self->offset;
+	self->offset += size;
+	return bytes;
+}
+
+static std::string _journal_string_get(JournalReader* self)
+{
+	u32 length = _journal_get<u32>(self);
+	const u8* bytes = _journal_bytes_get(self, length);
+	return bytes ? std::string((const char*)bytes, length) : std::string{};
+}
+
+static void _journal_header_get(JournalReader* self, Anm2* anm2)
+{
+	anm2->path = _journal_string_get(self);
+	anm2->createdBy = _journal_string_get(self);
+	anm2->createdOn = _journal_string_get(self);
+	anm2->version = _journal_get<s32>(self);
+	anm2->fps = _journal_get<s32>(self);
+	anm2->defaultAnimationID = _journal_get<s32>(self);
+
+	anm2->spritesheets.clear();
+	for (u32 i = _journal_get<u32>(self); i > 0 && self->isValid; i--)
+	{
+		s32 id = _journal_get<s32>(self);
+		anm2->spritesheets[id].path = _journal_string_get(self);
+	}
+
+	anm2->layers.clear();
+	for (u32 i = _journal_get<u32>(self); i > 0 && self->isValid; i--)
+	{
+		Anm2Layer& layer = anm2->layers[_journal_get<s32>(self)];
+		layer.spritesheetID = _journal_get<s32>(self);
+		layer.name = _journal_string_get(self);
+	}
+
+	anm2->nulls.clear();
+	for (u32 i = _journal_get<u32>(self); i > 0 && self->isValid; i--)
+	{
+		Anm2Null& null = anm2->nulls[_journal_get<s32>(self)];
+		null.isShowRect = _journal_get<u8>(self);
+		null.name = _journal_string_get(self);
+	}
+
+	anm2->events.clear();
+	for (u32 i = _journal_get<u32>(self); i > 0 && self->isValid; i--)
+	{
+		s32 id = _journal_get<s32>(self);
+		anm2->events[id].name = _journal_string_get(self);
+	}
+
+	anm2->layerMap.clear();
+	for (u32 i = _journal_get<u32>(self); i > 0 && self->isValid; i--)
+	{
+		s32 index = _journal_get<s32>(self);
+		anm2->layerMap[index] = _journal_get<s32>(self);
+	}
+}
+
+static void _journal_item_get(JournalReader* self, Anm2Item* item)
+{
+	item->isVisible = _journal_get<u8>(self);
+
+	u32 count = _journal_get<u32>(self);
+	const u8* bytes = _journal_bytes_get(self, (size_t)count * sizeof(Anm2Frame));
+
+	if (bytes) item->frames.assign((const Anm2Frame*)bytes, (const Anm2Frame*)bytes + count);
+}
+
+// A new animation takes a revision of its own, as one read from a file does
+static void _journal_animation_get(JournalReader* self, Anm2Animation* animation)
+{
+	*animation = Anm2Animation{};
+	animation->name = _journal_string_get(self);
+	animation->frameNum = _journal_get<s32>(self);
+	animation->isLoop = _journal_get<u8>(self);
+
+	if (_journal_get<u8>(self))
+	{
+		u32 size = _journal_get<u32>(self);
+		const u8* bytes = _journal_bytes_get(self, size);
+
+		if (bytes) animation->packed = std::make_shared<const std::vector<u8>>(bytes, bytes + size);
+		return;
+	}
+
+	_journal_item_get(self, &animation->rootAnimation);
+	_journal_item_get(self, &animation->triggers);
+
+	for (u32 i = _journal_get<u32>(self); i > 0 && self->isValid; i--)
+		_journal_item_get(self, &animation->layerAnimations[_journal_get<s32>(self)]);
+
+	for (u32 i = _journal_get<u32>(self); i > 0 && self->isValid; i--)
+		_journal_item_get(self, &animation->nullAnimations[_journal_get<s32>(self)]);
+}
+
+// An animation's part of an edit record, decoded
+struct JournalEdit
+{
+	JournalEditType type = JOURNAL_EDIT_REMOVE;
+	Anm2Animation animation; // whole, or just the name, length and loop of one with items
+	std::vector<std::tuple<Anm2Type, s32, Anm2Item>> items;
+};
+
+static void _journal_edit_get(JournalReader* self, JournalEdit* edit)
+{
+	edit->type = (JournalEditType)_journal_get<u8>(self);
+
+	switch (edit->type)
+	{
+		case JOURNAL_EDIT_REMOVE:
+			break;
+		case JOURNAL_EDIT_ANIMATION:
+			_journal_animation_get(self, &edit->animation);
+			break;
+		case JOURNAL_EDIT_ITEMS:
+			edit->animation.name = _journal_string_get(self);
+			edit->animation.frameNum = _journal_get<s32>(self);
+			edit->animation.isLoop = _journal_get<u8>(self);
+
+			for (u32 i = _journal_get<u32>(self); i > 0 && self->isValid; i--)
+			{
+				Anm2Type type = (Anm2Type)_journal_get<u8>(self);
+				s32 id = _journal_get<s32>(self);
+
+				_journal_item_get(self, &std::get<Anm2Item>(edit->items.emplace_back(type, id, Anm2Item{})));
+
+				if (type != ANM2_ROOT && type != ANM2_LAYER && type != ANM2_NULL && type != ANM2_TRIGGERS)
+					self->isValid = false;
+			}
+			break;
+		default:
+			self->isValid = false;
+			break;
+	}
+}
+
+static void _journal_edit_apply(Anm2* anm2, s32 id, JournalEdit* edit)
+{
+	switch (edit->type)
+	{
+		case JOURNAL_EDIT_REMOVE:
+			anm2->animations.erase(id);
+			break;
+		case JOURNAL_EDIT_ANIMATION:
+			anm2->animations[id] = std::move(edit->animation);
+			break;
+		case JOURNAL_EDIT_ITEMS:
+		{
+			Anm2Animation* animation = &anm2->animations[id];
+
+			animation->name = std::move(edit->animation.name);
+			animation->frameNum = edit->animation.frameNum;
+			animation->isLoop = edit->animation.isLoop;
+
+			for (auto& [type, itemID, item] : edit->items)
+			{
+				switch (type)
+				{
+					case ANM2_ROOT: animation->rootAnimation = std::move(item); break;
+					case ANM2_LAYER: animation->layerAnimations[itemID] = std::move(item); break;
+					case ANM2_NULL: animation->nullAnimations[itemID] = std::move(item); break;
+					case ANM2_TRIGGERS: animation->triggers = std::move(item); break;
+					default: break;
+				}
+			}
+
+			anm2_animation_dirty_set(animation);
+			break;
+		}
+	}
+}
+
+/* Writing */
+
+static std::string _journal_record_get(JournalRecordType type, const std::string& payload)
+{
+	JournalRecordHeader header{JOURNAL_MAGIC, JOURNAL_VERSION, (u16)type, (u32)payload.size(), (u32)sizeof(Anm2Frame), hash_fnv1a(payload)};
+	std::string record((const char*)&header, sizeof(header));
+
+	record.append(payload);
+	return record;
+}
+
+static void _journal_write_fail(Journal* self)
+{
+	log_error(std::format(JOURNAL_WRITE_ERROR, self->path));
+	self->isFailed = true;
+}
+
+// The checkpoint replaces the file whole (through a temporary, so a crash mid-write leaves the last one),
+// and the edits after it are appended
+static void _journal_checkpoint_write(Journal* self)
+{
+	std::string payload;
+
+	if (self->path.empty()) self->path = instance_path_get(JOURNAL_DIRECTORY, JOURNAL_EXTENSION);
+
+	_journal_header_put(&payload, self->state);
+
+	_journal_put(&payload, (u32)self->state.animations.size());
+	for (auto& [id, animation] : self->state.animations)
+	{
+		_journal_put(&payload, id);
+		_journal_animation_put(&payload, animation);
+	}
+
+	std::string record = _journal_record_get(JOURNAL_RECORD_CHECKPOINT, payload);
+
+	if (!anm2_writer_file_write(self->path, record))
+	{
+		_journal_write_fail(self);
+		return;
+	}
+
+	self->size = (s64)record.size();
+	self->editCount = 0;
+}
+
+// Only the items an edit touched are stored, when the animation had any to compare against; copies share the
+// frames of items left alone, so those are told apart by their buffers
+static void _journal_animation_edit_put(std::string* out, const Anm2Animation& animation, const Anm2Animation* previous)
+{
+	auto is_same = [](const Anm2Item& item, const Anm2Item& previousItem)
+	{ return item.isVisible == previousItem.isVisible && item.frames.id_get() == previousItem.frames.id_get(); };
+
+	auto is_keys_same = [](const IdMap<Anm2Item>& items, const IdMap<Anm2Item>& previousItems)
+	{ return std::ranges::equal(std::views::keys(items), std::views::keys(previousItems)); };
+
+	if (!previous || animation.packed || animation.source || previous->packed || previous->source ||
+		!is_keys_same(animation.layerAnimations, previous->layerAnimations) || !is_keys_same(animation.nullAnimations, previous->nullAnimations))
+	{
+		_journal_put(out, (u8)JOURNAL_EDIT_ANIMATION);
+		_journal_animation_put(out, animation);
+		return;
+	}
+
+	std::vector<std::tuple<Anm2Type, s32, const Anm2Item*>> items;
+
+	if (!is_same(animation.rootAnimation, previous->rootAnimation)) items.push_back({ANM2_ROOT, ID_NONE, &animation.rootAnimation});
+	if (!is_same(animation.triggers, previous->triggers)) items.push_back({ANM2_TRIGGERS, ID_NONE, &animation.triggers});
+
+	// Same keys, so entries pair up in order
+	for (size_t i = 0; i < animation.layerAnimations.size(); i++)
+	{
+		auto& [id, item] = animation.layerAnimations.values[i];
+		if (!is_same(item, previous->layerAnimations.values[i].second)) items.push_back({ANM2_LAYER, id, &item});
+	}
+
+	for (size_t i = 0; i < animation.nullAnimations.size(); i++)
+	{
+		auto& [id, item] = animation.nullAnimations.values[i];
+		if (!is_same(item, previous->nullAnimations.values[i].second)) items.push_back({ANM2_NULL, id, &item});
+	}
+
+	_journal_put(out, (u8)JOURNAL_EDIT_ITEMS);
+	_journal_string_put(out, animation.name);
+	_journal_put(out, animation.frameNum);
+	_journal_put(out, (u8)animation.isLoop);
+
+	_journal_put(out, (u32)items.size());
+	for (auto& [type, id, item] : items)
+	{
+		_journal_put(out, (u8)type);
+		_journal_put(out, id);
+		_journal_item_put(out, *item);
+	}
+}
+
+// Journals a change the caller has already made to the journal's state: the header if isHeader, and the
+// animations in previous, as they were before it (a missing one having been added). Every so often a checkpoint
+// of the whole state is written in place of the edit, so the file, and a replay of it, stays bounded
+void journal_edit_append(Journal* self, bool isHeader, const std::vector<std::pair<s32, std::optional<Anm2Animation>>>& previous)
+{
+	if (self->isFailed) return;
+
+	if (self->path.empty() || self->editCount >= self->checkpointEdits || self->size >= self->checkpointBytes)
+	{
+		_journal_checkpoint_write(self);
+		return;
+	}
+
+	std::string payload;
+
+	_journal_put(&payload, (u8)isHeader);
+	if (isHeader) _journal_header_put(&payload, self->state);
+
+	_journal_put(&payload, (u32)previous.size());
+	for (auto& [id, previousAnimation] : previous)
+	{
+		const Anm2Animation* animation = map_find(self->state.animations, id);
+
+		_journal_put(&payload, id);
+
+		if (animation)
+			_journal_animation_edit_put(&payload, *animation, previousAnimation ? &*previousAnimation : nullptr);
+		else
+			_journal_put(&payload, (u8)JOURNAL_EDIT_REMOVE);
+	}
+
+	std::string record = _journal_record_get(JOURNAL_RECORD_EDIT, payload);
+	std::ofstream file(self->path, std::ios::binary | std::ios::app);
+
+	if (file) file.write(record.data(), record.size());
+
+	if (!file)
+	{
+		_journal_write_fail(self);
+		return;
+	}
+
+	self->size += (s64)record.size();
+	self->editCount++;
+}
+
+// The document's been opened, saved or replaced; there's nothing to recover until it's edited again
+void journal_reset(Journal* self, const Anm2& anm2)
+{
+	journal_free(self);
+	self->state = anm2;
+}
+
+void journal_free(Journal* self)
+{
+	std::error_code errorCode;
+
+	if (!self->path.empty()) std::filesystem::remove(self->path, errorCode);
+
+	*self = Journal{};
+}
+
+/* Replay */
+
+// Journals left by instances that are gone, oldest first, as their names start with the time they were begun at.
+// Those of instances still running are theirs to keep
+std::vector<std::string> journal_paths_get(void)
+{
+	std::vector<std::string> paths;
+	std::error_code errorCode;
+
+	for (auto& entry : std::filesystem::directory_iterator(preferences_path_get() + JOURNAL_DIRECTORY, errorCode))
+		if (entry.path().extension() == JOURNAL_EXTENSION && !instance_path_is_live(entry.path().string()))
+			paths.push_back(entry.path().string());
+
+	std::sort(paths.begin(), paths.end());
+	return paths;
+}
+
+// Rebuilds the document a journal was kept for, up to its last intact record. Fails if not even the checkpoint is
+bool journal_replay(Anm2* anm2, const std::string& path, s32* editCount)
+{
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	std::string data;
+	bool isCheckpoint = false;
+	s32 count = 0;
+
+	if (file)
+	{
+		data.resize((size_t)file.tellg());
+		file.seekg(0);
+		file.read(data.data(), data.size());
+	}
+
+	if (!file)
+	{
+		log_error(std::format(JOURNAL_READ_ERROR, path));
+		return false;
+	}
+
+	JournalReader records = {(const u8*)data.data(), data.size()};
+
+	while (records.offset < records.size)
+	{
+		JournalRecordHeader header = _journal_get<JournalRecordHeader>(&records);
+		const u8* bytes = _journal_bytes_get(&records, header.size);
+
+		if (!bytes || header.magic != JOURNAL_MAGIC || header.version != JOURNAL_VERSION || header.frameSize != sizeof(Anm2Frame) ||
+			header.hash != hash_fnv1a(std::string_view((const char*)bytes, header.size)))
+			break;
+
+		JournalReader reader = {bytes, header.size};
+
+		// Records are decoded whole before any of one is applied, so a bad one leaves the document as the last left it
+		if (header.type == JOURNAL_RECORD_CHECKPOINT)
+		{
+			Anm2 checkpoint;
+
+			_journal_header_get(&reader, &checkpoint);
+			for (u32 i = _journal_get<u32>(&reader); i > 0 && reader.isValid; i--)
+				_journal_animation_get(&reader, &checkpoint.animations[_journal_get<s32>(&reader)]);
+
+			if (!reader.isValid) break;
+
+			*anm2 = std::move(checkpoint);
+			isCheckpoint = true;
+			count = 0;
+		}
+		else if (header.type == JOURNAL_RECORD_EDIT && isCheckpoint)
+		{
+			std::optional<Anm2> edited; // header only
+			std::vector<std::pair<s32, JournalEdit>> edits;
+
+			if (_journal_get<u8>(&reader)) _journal_header_get(&reader, &edited.emplace());
+
+			for (u32 i = _journal_get<u32>(&reader); i > 0 && reader.isValid; i--)
+			{
+				auto& [id, edit] = edits.emplace_back(_journal_get<s32>(&reader), JournalEdit{});
+				_journal_edit_get(&reader, &edit);
+
+				// Items apply to the animation as the records before left it, which has to have them all
+				if (edit.type != JOURNAL_EDIT_ITEMS) continue;
+
+				Anm2Animation* animation = map_find(anm2->animations, id);
+
+				if (!animation || animation->packed || animation->source)
+					reader.isValid = false;
+				else
+					for (auto& [type, itemID, item] : edit.items)
+						if ((type == ANM2_LAYER && !animation->layerAnimations.contains(itemID)) ||
+							(type == ANM2_NULL && !animation->nullAnimations.contains(itemID)))
+							reader.isValid = false;
+			}
+
+			if (!reader.isValid) break;
+
+			if (edited)
+			{
+				edited->animations = std::move(anm2->animations);
+				*anm2 = std::move(*edited);
+			}
+
+			for (auto& [id, edit] : edits)
+				_journal_edit_apply(anm2, id, &edit);
+
+			count++;
+		}
+		else
+			break;
+	}
+
+	if (!isCheckpoint)
+	{
+		log_error(std::format(JOURNAL_READ_ERROR, path));
+		return false;
+	}
+
+	if (editCount) *editCount = count;
+
+	log_info(std::format(JOURNAL_REPLAY_INFO, count, path));
+	return true;
+}
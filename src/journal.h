@@ -0,0 +1,59 @@
+// Crash-recovery journal; a document's committed edits appended to a file in the preferences directory, after
+// a checkpoint of the whole document. Closing the document removes it, so any found at startup whose instance is no
+// longer running were left by a crash
+
+#pragma once
+
+#include "anm2.h"
+
+#define JOURNAL_DIRECTORY "journal"
+#define JOURNAL_EXTENSION ".journal"
+#define JOURNAL_MAGIC 0x4c4e524au // "JRNL"
+#define JOURNAL_VERSION 1
+#define JOURNAL_CHECKPOINT_EDITS 1024 // edits appended before the next one is written as a checkpoint instead
+#define JOURNAL_CHECKPOINT_BYTES (64ll << 20) // likewise, for the bytes they take
+#define JOURNAL_WRITE_ERROR "Unable to write crash-recovery journal {}; edits are no longer journaled"
+#define JOURNAL_READ_ERROR "Unable to read crash-recovery journal {}"
+#define JOURNAL_REPLAY_INFO "Replayed {} edits from crash-recovery journal {}"
+
+enum JournalRecordType
+{
+    JOURNAL_RECORD_CHECKPOINT, // the whole document
+    JOURNAL_RECORD_EDIT // the header, if it changed, and each animation that did
+};
+
+// How an edit record stores each animation it changed
+enum JournalEditType
+{
+    JOURNAL_EDIT_REMOVE,
+    JOURNAL_EDIT_ANIMATION, // whole, for one that's new or whose layers or nulls changed
+    JOURNAL_EDIT_ITEMS // its name, length and loop, and the items whose frames changed
+};
+
+// A record is this, then its payload; one torn by a crash fails its hash, and replay ends before it
+struct JournalRecordHeader
+{
+    u32 magic;
+    u16 version;
+    u16 type;
+    u32 size; // of the payload
+    u32 frameSize; // frames are stored as raw bytes
+    u64 hash; // of the payload
+};
+
+struct Journal
+{
+    Anm2 state{}; // the document as journaled, for the next edit to be found against; shares its frames
+    std::string path{}; // chosen on the first edit, so a document that's never edited has no file
+    s64 size{}; // of the file
+    s32 editCount{}; // since the checkpoint
+    s32 checkpointEdits = JOURNAL_CHECKPOINT_EDITS;
+    s64 checkpointBytes = JOURNAL_CHECKPOINT_BYTES;
+    bool isFailed = false; // set by a failed write; nothing more is journaled until a reset
+};
+
+void journal_reset(Journal* self, const Anm2& anm2);
+void journal_edit_append(Journal* self, bool isHeader, const std::vector<std::pair<s32, std::optional<Anm2Animation>>>& previous);
+void journal_free(Journal* self);
+std::vector<std::string> journal_paths_get(void);
+bool journal_replay(Anm2* anm2, const std::string& path, s32* editCount = nullptr);
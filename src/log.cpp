@@ -4,6 +4,8 @@ inline std::ofstream logFile;
 
 inline bool keep_trying_out_to_console=true;
 
+inline std::mutex logMutex; // batch jobs log from worker threads
+
 std::string log_path_get(void)
 {
     return preferences_path_get() + LOG_PATH;
@@ -11,6 +13,8 @@ std::string log_path_get(void)
 
 void log_write(const std::string& string)
 {
+    std::lock_guard lock(logMutex);
+
     if (keep_trying_out_to_console) {
         try {
             std::println("{}", string);
@@ -62,4 +66,10 @@ void log_command(const std::string& command)
 void log_free(void)
 {
     logFile.close();
+}
+
+void log_console_set(bool isConsole)
+{
+    std::lock_guard lock(logMutex);
+    keep_trying_out_to_console = isConsole;
 }
\ No newline at end of file
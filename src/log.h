@@ -18,4 +18,5 @@ void log_info(const std::string& info);
 void log_warning(const std::string& warning);
 void log_imgui(const std::string& imgui);
 void log_command(const std::string& command);
-void log_free(void);
\ No newline at end of file
+void log_free(void);
+void log_console_set(bool isConsole);
\ No newline at end of file
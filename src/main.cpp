@@ -38,6 +38,16 @@ main(s32 argc, char* argv[])
 			
 			return EXIT_FAILURE;
 		}
+		else if (std::string(argv[1]) == ARGUMENT_BATCH)
+		{
+			// Never reaches init(), so no window or GL context is created
+			Batch batch;
+
+			if (!batch_arguments_parse(&batch, argc - 2, argv + 2))
+				return EXIT_FAILURE;
+
+			return batch_run(&batch) ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
 		else
 			if (argv[1])
 				state.argument = argv[1];
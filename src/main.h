@@ -4,5 +4,7 @@
 #define ARGUMENT_RESCALE_ARGUMENT_ERROR "--rescale: specify both anm2 and scale arguments" 
 #define ARGUMENT_RESCALE_ANM2_ERROR "Unable to rescale anm2 {} by value {}. Make sure the file is valid."
 #define ARGUMENT_RESCALE_ANM2_INFO "Scaled anm2 {} by {}"
+#define ARGUMENT_BATCH "--batch"
 
+#include "batch.h"
 #include "state.h"
\ No newline at end of file
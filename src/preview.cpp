@@ -8,6 +8,17 @@ static void _preview_render_textures_free(Preview* self)
     self->renderFrames.clear();
 }
 
+static void _preview_pose_get(Preview* self, Anm2PoseCache* cache, Anm2Pose* pose, s32 animationID)
+{
+    if (self->settings->playbackIsPoseCache)
+        anm2_pose_cache_get(self->anm2, cache, pose, animationID, self->time, self->settings->previewIsRootTransform);
+    else
+    {
+        anm2_pose_cache_clear(cache);
+        anm2_pose_get(self->anm2, pose, animationID, self->time, self->settings->previewIsRootTransform);
+    }
+}
+
 void preview_init(Preview* self, Anm2* anm2, Anm2Reference* reference, Resources* resources, Settings* settings)
 {
     self->anm2 = anm2;
@@ -97,151 +108,123 @@ void preview_draw(Preview* self)
     if (self->settings->previewIsAxes)
         canvas_axes_draw(&self->canvas, shaderLine, transform, self->settings->previewAxesColor);
 
-    Anm2Animation* animation = anm2_animation_from_reference(self->anm2, self->reference);
-    s32& animationID = self->reference->animationID;
-
-    if (animation)
-    {
-        Anm2Frame root;
-        mat4 rootModel = mat4(1.0f);
-        
-        anm2_frame_from_time(self->anm2, &root, Anm2Reference{animationID, ANM2_ROOT}, self->time);
+    Anm2Pose& pose = self->pose;
+    Anm2Pose& poseOverlay = self->poseOverlay;
 
-        if (self->settings->previewIsRootTransform)
-            rootModel = quad_parent_model_get(root.position, vec2(0.0f), root.rotation, PERCENT_TO_UNIT(root.scale));
+    _preview_pose_get(self, &self->poseCache, &pose, self->reference->animationID);
 
-        // Root
-        if (self->settings->previewIsTargets && animation->rootAnimation.isVisible && root.isVisible)
-        {
-            mat4 model = quad_model_get(PREVIEW_TARGET_SIZE, root.position, PREVIEW_TARGET_SIZE * 0.5f, root.rotation, PERCENT_TO_UNIT(root.scale));
-            mat4 rootTransform = transform * model;
-            f32 vertices[] = ATLAS_UV_VERTICES(ATLAS_TARGET);
-            canvas_texture_draw(&self->canvas, shaderTexture, self->resources->atlas.id, rootTransform, vertices, PREVIEW_ROOT_COLOR);
-        }
+    mat4& rootModel = pose.rootModel;
 
-        // Layers
-		for (auto [i, id] : self->anm2->layerMap)
-        {
-            Anm2Frame frame;
-            Anm2Item& layerAnimation = animation->layerAnimations[id];
+    for (s32 i = 0; i < pose.count; i++)
+    {
+        if (!pose.isVisibles[i])
+            continue;
 
-            if (!layerAnimation.isVisible || layerAnimation.frames.size() <= 0)
-                continue;
+        s32 id = pose.ids[i];
+        vec2 position = anm2_pose_position_get(&pose, i);
+        f32 rotation = anm2_pose_rotation_get(&pose, i);
+        vec2 scale = PERCENT_TO_UNIT(anm2_pose_scale_get(&pose, i));
 
-            anm2_frame_from_time(self->anm2, &frame, Anm2Reference{animationID, ANM2_LAYER, id}, self->time);
+        switch (pose.types[i])
+        {
+            // Root
+            case ANM2_ROOT:
+            {
+                if (!self->settings->previewIsTargets)
+                    break;
+
+                mat4 model = quad_model_get(PREVIEW_TARGET_SIZE, position, PREVIEW_TARGET_SIZE * 0.5f, rotation, scale);
+                mat4 rootTransform = transform * model;
+                f32 vertices[] = ATLAS_UV_VERTICES(ATLAS_TARGET);
+                canvas_texture_draw(&self->canvas, shaderTexture, self->resources->atlas.id, rootTransform, vertices, PREVIEW_ROOT_COLOR);
+                break;
+            }
+            // Layers
+            case ANM2_LAYER:
+            {
+                mat4 layerTransform = transform * pose.models[i];
 
-            if (!frame.isVisible)
-                continue;
+                Texture* texture = resources_texture_get(self->resources, pose.spritesheetIDs[i]);
 
-            mat4 model = quad_model_get(frame.size, frame.position, frame.pivot, frame.rotation, PERCENT_TO_UNIT(frame.scale));
-            mat4 layerTransform = transform * (rootModel * model);
+                if (texture && !texture->isInvalid)
+                {
+                    vec2 uvMin = pose.crops[i] / vec2(texture->size);
+                    vec2 uvMax = (pose.crops[i] + pose.sizes[i]) / vec2(texture->size);
+                    f32 vertices[] = UV_VERTICES(uvMin, uvMax);
 
-            Texture* texture = map_find(self->resources->textures, self->anm2->layers[id].spritesheetID);
-           
-            if (texture && !texture->isInvalid)
-            {
-                vec2 uvMin = frame.crop / vec2(texture->size);
-                vec2 uvMax = (frame.crop + frame.size) / vec2(texture->size);
-                f32 vertices[] = UV_VERTICES(uvMin, uvMax);
+                    canvas_texture_draw(&self->canvas, shaderTexture, texture->id, layerTransform, vertices, anm2_pose_tint_get(&pose, i), anm2_pose_offset_get(&pose, i));
+                }
 
-                canvas_texture_draw(&self->canvas, shaderTexture, texture->id, layerTransform, vertices, frame.tintRGBA, frame.offsetRGB);
-            }
- 
-            if (self->settings->previewIsBorder)
-                canvas_rect_draw(&self->canvas, shaderLine, layerTransform, PREVIEW_BORDER_COLOR);
+                if (self->settings->previewIsBorder)
+                    canvas_rect_draw(&self->canvas, shaderLine, layerTransform, PREVIEW_BORDER_COLOR);
 
-            if (self->settings->previewIsPivots)
-            {
-                f32 vertices[] = ATLAS_UV_VERTICES(ATLAS_PIVOT);
-                mat4 pivotModel = quad_model_get(CANVAS_PIVOT_SIZE, frame.position, CANVAS_PIVOT_SIZE * 0.5f, frame.rotation, PERCENT_TO_UNIT(frame.scale));
-                mat4 pivotTransform = transform * (rootModel * pivotModel);
-                canvas_texture_draw(&self->canvas, shaderTexture, self->resources->atlas.id, pivotTransform, vertices, PREVIEW_PIVOT_COLOR);
+                if (self->settings->previewIsPivots)
+                {
+                    f32 vertices[] = ATLAS_UV_VERTICES(ATLAS_PIVOT);
+                    mat4 pivotModel = quad_model_get(CANVAS_PIVOT_SIZE, position, CANVAS_PIVOT_SIZE * 0.5f, rotation, scale);
+                    mat4 pivotTransform = transform * (rootModel * pivotModel);
+                    canvas_texture_draw(&self->canvas, shaderTexture, self->resources->atlas.id, pivotTransform, vertices, PREVIEW_PIVOT_COLOR);
+                }
+                break;
             }
-        }
-
-        // Nulls
-        if (self->settings->previewIsTargets)
-        {
-            for (auto& [id, nullAnimation] : animation->nullAnimations)
+            // Nulls
+            case ANM2_NULL:
             {
-                if (!nullAnimation.isVisible || nullAnimation.frames.size() <= 0)
-                    continue;
-
-                Anm2Frame frame;
-                anm2_frame_from_time(self->anm2, &frame, Anm2Reference{animationID, ANM2_NULL, id}, self->time);
+                if (!self->settings->previewIsTargets)
+                    break;
 
-                if (!frame.isVisible)
-                    continue;
-
-                Anm2Null null = self->anm2->nulls[id];
+                auto null = self->anm2->nulls.find(id);
+                bool isShowRect = null != self->anm2->nulls.end() && null->second.isShowRect;
 
                 vec4 color = (self->reference->itemType == ANM2_NULL && self->reference->itemID == id) ? 
                              PREVIEW_NULL_SELECTED_COLOR                                               : 
                              PREVIEW_NULL_COLOR;
 
-                vec2 size = null.isShowRect ? CANVAS_PIVOT_SIZE : PREVIEW_TARGET_SIZE;
-                AtlasType atlas = null.isShowRect ? ATLAS_SQUARE : ATLAS_TARGET;
+                vec2 size = isShowRect ? CANVAS_PIVOT_SIZE : PREVIEW_TARGET_SIZE;
+                AtlasType atlas = isShowRect ? ATLAS_SQUARE : ATLAS_TARGET;
           
-                mat4 model = quad_model_get(size, frame.position, size * 0.5f, frame.rotation, PERCENT_TO_UNIT(frame.scale));
+                mat4 model = quad_model_get(size, position, size * 0.5f, rotation, scale);
                 mat4 nullTransform = transform * (rootModel * model);
      
                 f32 vertices[] = ATLAS_UV_VERTICES(atlas);
         
                 canvas_texture_draw(&self->canvas, shaderTexture, self->resources->atlas.id, nullTransform, vertices, color);
 
-                if (null.isShowRect)
+                if (isShowRect)
                 {
-                    mat4 rectModel = quad_model_get(PREVIEW_NULL_RECT_SIZE, frame.position, PREVIEW_NULL_RECT_SIZE * 0.5f, frame.rotation, PERCENT_TO_UNIT(frame.scale));
+                    mat4 rectModel = quad_model_get(PREVIEW_NULL_RECT_SIZE, position, PREVIEW_NULL_RECT_SIZE * 0.5f, rotation, scale);
                     mat4 rectTransform = transform * (rootModel * rectModel);
                     canvas_rect_draw(&self->canvas, shaderLine, rectTransform, color);
                 }
+                break;
             }
+            default:
+                break;
         }
     }
 
-    s32& animationOverlayID = self->animationOverlayID;
-    Anm2Animation* animationOverlay = map_find(self->anm2->animations, animationOverlayID);
+    _preview_pose_get(self, &self->poseOverlayCache, &poseOverlay, self->animationOverlayID);
 
-    if (animationOverlay)
+    for (s32 i = 0; i < poseOverlay.count; i++)
     {
-        Anm2Frame root;
-        mat4 rootModel = mat4(1.0f);
-        
-        anm2_frame_from_time(self->anm2, &root, Anm2Reference{animationOverlayID, ANM2_ROOT}, self->time);
-
-        if (self->settings->previewIsRootTransform)
-            rootModel = quad_parent_model_get(root.position, vec2(0.0f), root.rotation, PERCENT_TO_UNIT(root.scale));
-
-		for (auto [i, id] : self->anm2->layerMap)
-        {
-            Anm2Frame frame;
-            Anm2Item& layerAnimation = animationOverlay->layerAnimations[id];
+        if (poseOverlay.types[i] != ANM2_LAYER || !poseOverlay.isVisibles[i])
+            continue;
 
-            if (!layerAnimation.isVisible || layerAnimation.frames.size() <= 0)
-                continue;
-
-            anm2_frame_from_time(self->anm2, &frame, Anm2Reference{animationOverlayID, ANM2_LAYER, id}, self->time);
-
-            if (!frame.isVisible)
-                continue;
-
-            Texture* texture = map_find(self->resources->textures, self->anm2->layers[id].spritesheetID);
-            
-            if (!texture || texture->isInvalid)
-                continue;
+        Texture* texture = resources_texture_get(self->resources, poseOverlay.spritesheetIDs[i]);
+        
+        if (!texture || texture->isInvalid)
+            continue;
 
-            vec2 uvMin = frame.crop / vec2(texture->size);
-            vec2 uvMax = (frame.crop + frame.size) / vec2(texture->size);
-            f32 vertices[] = UV_VERTICES(uvMin, uvMax);
+        vec2 uvMin = poseOverlay.crops[i] / vec2(texture->size);
+        vec2 uvMax = (poseOverlay.crops[i] + poseOverlay.sizes[i]) / vec2(texture->size);
+        f32 vertices[] = UV_VERTICES(uvMin, uvMax);
 
-            mat4 model = quad_model_get(frame.size, frame.position, frame.pivot, frame.rotation, PERCENT_TO_UNIT(frame.scale));
-            mat4 layerTransform = transform * (rootModel * model);
+        mat4 layerTransform = transform * poseOverlay.models[i];
 
-            vec4 tint = frame.tintRGBA;
-            tint.a *= U8_TO_FLOAT(self->settings->previewOverlayTransparency);
+        vec4 tint = anm2_pose_tint_get(&poseOverlay, i);
+        tint.a *= U8_TO_FLOAT(self->settings->previewOverlayTransparency);
 
-            canvas_texture_draw(&self->canvas, shaderTexture, texture->id, layerTransform, vertices, tint, frame.offsetRGB);
-        }
+        canvas_texture_draw(&self->canvas, shaderTexture, texture->id, layerTransform, vertices, tint, anm2_pose_offset_get(&poseOverlay, i));
     }
 
     canvas_unbind();
@@ -265,5 +248,7 @@ void preview_render_end(Preview* self)
 
 void preview_free(Preview* self)
 {
+    anm2_pose_cache_clear(&self->poseCache);
+    anm2_pose_cache_clear(&self->poseOverlayCache);
     canvas_free(&self->canvas);
 }
\ No newline at end of file
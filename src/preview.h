@@ -39,6 +39,10 @@ struct Preview
     bool isRenderFinished = false;
     bool isRenderCancelled = false;
     std::vector<Texture> renderFrames;
+    Anm2Pose pose; // the animation's, as last drawn
+    Anm2Pose poseOverlay;
+    Anm2PoseCache poseCache;
+    Anm2PoseCache poseOverlayCache;
     f32 time{};
 };
 
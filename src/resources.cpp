@@ -1,19 +1,95 @@
 #include "resources.h"
 
-void resources_texture_init(Resources* self, const std::string& path, s32 id)
+// Spritesheets resolving to the same file share one texture, so only the first to use a file decodes it.
+// That texture is an invalid placeholder until resources_textures_update uploads its pixels; a relative path
+// resolves against directory. Initializing an id with the file it already has decodes it again, for everyone using it
+void resources_texture_init(Resources* self, const std::string& path, s32 id, const std::string& directory)
 {
-	Texture texture;
+	std::string key = path_canonical_resolve(path, directory.empty() ? std::filesystem::current_path().string() : directory);
+	ResourcesTexture** current = map_find(self->textures, id);
+	auto [it, isNew] = self->textureCache.try_emplace(key);
+	ResourcesTexture* texture = &it->second;
+	bool isDecode = isNew;
 
-    if (map_find(self->textures, id))
-		texture_free(&self->textures[id]);
+	if (current && *current == texture)
+	{
+		texture_free(&texture->texture);
+		isDecode = true;
+	}
+	else
+	{
+		texture->path = key;
+		texture->refCount++;
+		resources_texture_release(self, id);
+		self->textures[id] = texture;
+	}
 
-	texture_from_path_init(&texture, path);
+	if (!isDecode) return;
 
-    self->textures[id] = texture;
+	texture->texture.isInvalid = true;
+	texture->texture.decodeID = self->decodeNextID++;
+
+	TextureDecode decode = {texture->texture.decodeID, path, directory};
+
+	thread_pool_submit(&self->decodePool, [self, decode]() mutable
+	{
+		texture_decode(&decode);
+
+		std::lock_guard lock(self->decodeMutex);
+		self->decodes.push_back(decode);
+	});
+}
+
+Texture* resources_texture_get(Resources* self, s32 id)
+{
+	ResourcesTexture** texture = map_find(self->textures, id);
+	return texture ? &(*texture)->texture : nullptr;
+}
+
+// Drops the active document's use of a texture; it's freed once no document uses it
+void resources_texture_release(Resources* self, s32 id)
+{
+	auto it = self->textures.find(id);
+
+	if (it == self->textures.end()) return;
+
+	ResourcesTexture* texture = it->second;
+	self->textures.erase(it);
+
+	if (--texture->refCount > 0) return;
+
+	texture_free(&texture->texture);
+	self->textureCache.erase(texture->path);
+}
+
+// Uploads finished decodes; main thread only. Decodes for textures since freed or reloaded are dropped
+void resources_textures_update(Resources* self)
+{
+	std::vector<TextureDecode> decodes;
+
+	{
+		std::lock_guard lock(self->decodeMutex);
+		decodes.swap(self->decodes);
+	}
+
+	for (auto& decode : decodes)
+	{
+		for (auto& [_, texture] : self->textureCache)
+		{
+			if (texture.texture.decodeID != decode.id) continue;
+
+			texture_from_decode_init(&texture.texture, &decode);
+			break;
+		}
+
+		texture_decode_free(&decode);
+	}
 }
 
 void resources_init(Resources* self)
 {
+	thread_pool_init(&self->decodePool);
+
     texture_from_encoded_data_init(&self->atlas, TEXTURE_ATLAS_SIZE, TEXTURE_CHANNELS, (u8*)TEXTURE_ATLAS, TEXTURE_ATLAS_LENGTH);
     
     for (s32 i = 0; i < SHADER_COUNT; i++) 
@@ -22,7 +98,16 @@ void resources_init(Resources* self)
 
 void resources_free(Resources* self)
 {
-    resources_textures_free(self);
+    thread_pool_free(&self->decodePool);
+
+    for (auto& decode : self->decodes)
+        texture_decode_free(&decode);
+    self->decodes.clear();
+
+    for (auto& [_, texture] : self->textureCache)
+        texture_free(&texture.texture);
+    self->textureCache.clear();
+    self->textures.clear();
     
     for (auto& shader : self->shaders)
         shader_free(&shader);
@@ -30,10 +115,11 @@ void resources_free(Resources* self)
     texture_free(&self->atlas);
 }
 
+// Releases the active document's textures; ones other documents share stay loaded
 void resources_textures_free(Resources* self)
 {
-    for (auto& [id, texture] : self->textures) 
-        texture_free(&self->textures[id]);
+    while (!self->textures.empty())
+        resources_texture_release(self, self->textures.begin()->first);
     
     log_info(RESOURCES_TEXTURES_FREE_INFO);
 }
\ No newline at end of file
@@ -1,19 +1,45 @@
 #pragma once
 
+#ifndef ANM2ED_HEADLESS
 #include "PACKED.h"
 #include "texture.h"
 #include "shader.h"
+#include "thread_pool.h"
 
 #define RESOURCES_TEXTURES_FREE_INFO "Freed texture resources"
 
+// One GL texture per spritesheet file, shared by every open document that uses it
+struct ResourcesTexture
+{
+    Texture texture;
+    std::string path{}; // canonical; the entry's key in the texture cache
+    s32 refCount = 0; // spritesheets pointing at it across all documents; freed at zero
+};
+
 struct Resources
 {
     GLuint shaders[SHADER_COUNT];
     Texture atlas;
-    std::map<s32, Texture> textures;
+    std::map<std::string, ResourcesTexture> textureCache; // by canonical path
+    std::map<s32, ResourcesTexture*> textures; // the active document's spritesheets, by id; swapped out with the document
+    ThreadPool decodePool;
+    std::mutex decodeMutex;
+    std::vector<TextureDecode> decodes; // decoded on a worker, waiting for their upload
+    u64 decodeNextID = 1;
 };
 
 void resources_init(Resources* self);
-void resources_texture_init(Resources* self, const std::string& path, s32 id);
+void resources_texture_init(Resources* self, const std::string& path, s32 id, const std::string& directory);
+Texture* resources_texture_get(Resources* self, s32 id);
+void resources_texture_release(Resources* self, s32 id);
+void resources_textures_update(Resources* self);
 void resources_free(Resources* self);
 void resources_textures_free(Resources* self);
+#else
+#include "log.h"
+
+// Headless tools never load textures; deserializing with resources == nullptr never calls this
+struct Resources {};
+
+static inline void resources_texture_init(Resources*, const std::string&, s32, const std::string&) {}
+#endif
@@ -0,0 +1,75 @@
+#include "save.h"
+
+void saves_init(Saves* self)
+{
+	thread_pool_init(&self->pool, SAVES_THREAD_COUNT);
+}
+
+// Prepares the document for the save (its path and version) and queues a copy of it to be written. Widgets write
+// the referenced item's frames through pointers held across frames, so the copy takes its own of those; everything
+// else it shares is only ever replaced, never written in place, while it's shared
+void saves_submit(Saves* self, Anm2* anm2, Anm2Reference* reference, s32 documentID, const std::string& path)
+{
+	anm2_serialize_prepare(anm2, path);
+
+	Save save = {documentID, path, *anm2};
+	Anm2Animation* animation = map_find(save.anm2.animations, reference->animationID);
+
+	if (animation && !animation->packed && !animation->source)
+		if (Anm2Item* item = anm2_item_from_reference(&save.anm2, reference))
+			item->frames.write();
+
+	{
+		std::lock_guard lock(self->mutex);
+
+		// One still waiting is written with this one's copy instead, and finishes as this one
+		if (auto it = self->pending.find(path); it != self->pending.end())
+		{
+			it->second = std::move(save);
+			return;
+		}
+
+		self->pending[path] = std::move(save);
+	}
+
+	thread_pool_submit(&self->pool, [self, path]
+	{
+		Save save;
+
+		{
+			std::lock_guard lock(self->mutex);
+			auto it = self->pending.find(path);
+			save = std::move(it->second);
+			self->pending.erase(it);
+		}
+
+		save.isSuccess = anm2_serialize_write(&save.anm2, save.path);
+
+		std::lock_guard lock(self->mutex);
+		self->finished.push_back(std::move(save));
+	});
+}
+
+// Blocks until every save made has been written
+void saves_wait(Saves* self)
+{
+	thread_pool_wait(&self->pool);
+}
+
+// Saves written since the last call, oldest first; main thread only
+std::vector<Save> saves_finished_get(Saves* self)
+{
+	std::vector<Save> finished;
+
+	std::lock_guard lock(self->mutex);
+	finished.swap(self->finished);
+	return finished;
+}
+
+// Saves still waiting are written first
+void saves_free(Saves* self)
+{
+	thread_pool_free(&self->pool);
+	self->pending.clear();
+	self->finished.clear();
+}
@@ -0,0 +1,31 @@
+// Saves written on a worker thread, from a copy of the document taken when they're made; the copy shares the
+// document's frames, so taking it costs about as much as an undo push. Saves run one at a time, in the order made
+
+#pragma once
+
+#include "thread_pool.h"
+#include "anm2.h"
+
+#define SAVES_THREAD_COUNT 1
+
+struct Save
+{
+    s32 documentID = ID_NONE;
+    std::string path{};
+    Anm2 anm2{}; // as written
+    bool isSuccess = false;
+};
+
+struct Saves
+{
+    ThreadPool pool;
+    std::mutex mutex;
+    std::map<std::string, Save> pending; // by path; one made while another to the same path waits replaces it
+    std::vector<Save> finished; // waiting for saves_finished_get
+};
+
+void saves_init(Saves* self);
+void saves_submit(Saves* self, Anm2* anm2, Anm2Reference* reference, s32 documentID, const std::string& path);
+void saves_wait(Saves* self);
+std::vector<Save> saves_finished_get(Saves* self);
+void saves_free(Saves* self);
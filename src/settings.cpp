@@ -257,4 +257,11 @@ void settings_init(Settings* self)
         else
             log_error(std::format(SETTINGS_DEFAULT_ERROR, path));
     }
-}
\ No newline at end of file
+}
+
+Anm2ReadType settings_anm2_read_type_get(Settings* self)
+{
+    if (self->fileIsLazy) return ANM2_READ_LAZY;
+    if (self->fileIsCache) return ANM2_READ_CACHE;
+    return ANM2_READ_STREAM;
+}
@@ -35,6 +35,7 @@ struct Settings
     bool isVsync = true;
     bool playbackIsLoop = true;
     bool playbackIsClampPlayhead = true;
+    bool playbackIsPoseCache = true;
     bool changeIsCrop = false;
     bool changeIsSize = false;
     bool changeIsPosition = false;
@@ -102,6 +103,15 @@ struct Settings
     std::string renderPath = ".";
     std::string renderFormat = "{}.png";
     std::string ffmpegPath{};
+    bool fileIsCache = false;
+    bool fileIsLazy = false;
+    bool fileIsCompact = false;
+    bool fileIsSaveBackground = true;
+    bool fileIsAutosave = false;
+    s32 fileAutosaveTime = 60; // seconds
+    s32 historyMemoryBudget = 256; // MB
+    s32 historyCompressedBudget = 256; // MB
+    bool historyIsJournal = true;
 }; 
 
 const SettingsEntry SETTINGS_ENTRIES[] =
@@ -110,6 +120,7 @@ const SettingsEntry SETTINGS_ENTRIES[] =
     {"isVsync", TYPE_BOOL, offsetof(Settings, isVsync)},
     {"playbackIsLoop", TYPE_BOOL, offsetof(Settings, playbackIsLoop)},
     {"playbackIsClampPlayhead", TYPE_BOOL, offsetof(Settings, playbackIsClampPlayhead)},
+    {"playbackIsPoseCache", TYPE_BOOL, offsetof(Settings, playbackIsPoseCache)},
     {"changeIsCrop", TYPE_BOOL, offsetof(Settings, changeIsCrop)},
     {"changeIsSize", TYPE_BOOL, offsetof(Settings, changeIsSize)},
     {"changeIsPosition", TYPE_BOOL, offsetof(Settings, changeIsPosition)},
@@ -176,7 +187,16 @@ const SettingsEntry SETTINGS_ENTRIES[] =
     {"renderType", TYPE_INT, offsetof(Settings, renderType)},
     {"renderPath", TYPE_STRING, offsetof(Settings, renderPath)},
     {"renderFormat", TYPE_STRING, offsetof(Settings, renderFormat)},
-    {"ffmpegPath", TYPE_STRING, offsetof(Settings, ffmpegPath)}
+    {"ffmpegPath", TYPE_STRING, offsetof(Settings, ffmpegPath)},
+    {"fileIsCache", TYPE_BOOL, offsetof(Settings, fileIsCache)},
+    {"fileIsLazy", TYPE_BOOL, offsetof(Settings, fileIsLazy)},
+    {"fileIsCompact", TYPE_BOOL, offsetof(Settings, fileIsCompact)},
+    {"fileIsSaveBackground", TYPE_BOOL, offsetof(Settings, fileIsSaveBackground)},
+    {"fileIsAutosave", TYPE_BOOL, offsetof(Settings, fileIsAutosave)},
+    {"fileAutosaveTime", TYPE_INT, offsetof(Settings, fileAutosaveTime)},
+    {"historyMemoryBudget", TYPE_INT, offsetof(Settings, historyMemoryBudget)},
+    {"historyCompressedBudget", TYPE_INT, offsetof(Settings, historyCompressedBudget)},
+    {"historyIsJournal", TYPE_BOOL, offsetof(Settings, historyIsJournal)}
 };
 constexpr s32 SETTINGS_COUNT = (s32)std::size(SETTINGS_ENTRIES);
 
@@ -187,6 +207,7 @@ windowY=1080
 isVsync=true
 playbackIsLoop=true
 playbackIsClampPlayhead=false
+playbackIsPoseCache=true
 changeIsCrop=false
 changeIsSize=false
 changeIsPosition=false
@@ -291,6 +312,15 @@ renderType=0
 renderPath=.
 renderFormat={}.png
 ffmpegPath=/usr/bin/ffmpeg
+fileIsCache=false
+fileIsLazy=false
+fileIsCompact=false
+fileIsSaveBackground=true
+fileIsAutosave=false
+fileAutosaveTime=60
+historyMemoryBudget=256
+historyCompressedBudget=256
+historyIsJournal=true
 
 # Dear ImGui
 [Window][## Window]
@@ -369,4 +399,5 @@ DockSpace         ID=0xFC02A410 Window=0x0E46F4F7 Pos=8,40 Size=1902,1016 Split=
 
 void settings_save(Settings* self);
 void settings_init(Settings* self);
-std::string settings_path_get(void);
\ No newline at end of file
+std::string settings_path_get(void);
+Anm2ReadType settings_anm2_read_type_get(Settings* self);
\ No newline at end of file
@@ -1,70 +1,751 @@
 #include "snapshots.h"
 
-static void _snapshot_stack_push(SnapshotStack* stack, const Snapshot* snapshot)
+#include "instance.h"
+
+#include <stb_image.h>
+
+// stb_image_write's zlib encoder; defined with the rest of it in stb.cpp, but not declared in its header
+extern "C" unsigned char* stbi_zlib_compress(unsigned char* data, int dataLength, int* outLength, int quality);
+
+static_assert(std::is_trivially_copyable_v<Anm2Frame>, "compressed entries store frames as raw bytes");
+
+static bool _snapshot_stack_pop(SnapshotStack* stack, Snapshot* snapshot)
 {
-    if (stack->top >= SNAPSHOT_STACK_MAX)
+    if (stack->is_empty()) return false;
+
+    *snapshot = std::move(stack->snapshots.back());
+    stack->snapshots.pop_back();
+    return true;
+}
+
+static bool _snapshot_header_is_equal(const Anm2& a, const Anm2& b)
+{
+    return a.path == b.path && a.createdBy == b.createdBy && a.createdOn == b.createdOn &&
+        a.spritesheets == b.spritesheets && a.layers == b.layers && a.nulls == b.nulls && a.events == b.events &&
+        a.layerMap == b.layerMap && a.defaultAnimationID == b.defaultAnimationID && a.fps == b.fps && a.version == b.version;
+}
+
+static void _snapshot_header_copy(Anm2* destination, const Anm2& source)
+{
+    destination->path = source.path;
+    destination->createdBy = source.createdBy;
+    destination->createdOn = source.createdOn;
+    destination->spritesheets = source.spritesheets;
+    destination->layers = source.layers;
+    destination->nulls = source.nulls;
+    destination->events = source.events;
+    destination->layerMap = source.layerMap;
+    destination->defaultAnimationID = source.defaultAnimationID;
+    destination->fps = source.fps;
+    destination->version = source.version;
+}
+
+static void _snapshot_header_swap(Anm2* a, Anm2* b)
+{
+    std::swap(a->path, b->path);
+    std::swap(a->createdBy, b->createdBy);
+    std::swap(a->createdOn, b->createdOn);
+    std::swap(a->spritesheets, b->spritesheets);
+    std::swap(a->layers, b->layers);
+    std::swap(a->nulls, b->nulls);
+    std::swap(a->events, b->events);
+    std::swap(a->layerMap, b->layerMap);
+    std::swap(a->defaultAnimationID, b->defaultAnimationID);
+    std::swap(a->fps, b->fps);
+    std::swap(a->version, b->version);
+}
+
+static bool _snapshot_item_is_same(const Anm2Item& a, const Anm2Item& b)
+{
+    return a.isVisible == b.isVisible && (a.frames.id_get() == b.frames.id_get() || a.frames.read() == b.frames.read());
+}
+
+static bool _snapshot_items_is_same(const IdMap<Anm2Item>& a, const IdMap<Anm2Item>& b)
+{
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](const auto& itemA, const auto& itemB)
+        { return itemA.first == itemB.first && _snapshot_item_is_same(itemA.second, itemB.second); });
+}
+
+// Packed children are compared as their encoding and unread ones by their span; materialized ones mostly still
+// share buffers, so few frames are looked at. Where only one side is encoded (base compacts, the document doesn't),
+// it's compared decoded, as the writer does
+static bool _snapshot_children_is_same(const Anm2Animation& a, const Anm2Animation& b)
+{
+    if (a.packed && b.packed) return a.packed == b.packed || *a.packed == *b.packed;
+    if (a.source && b.source && a.body.data() == b.body.data() && a.body.size() == b.body.size()) return true;
+
+    if (a.packed || a.source)
     {
-        for (s32 i = 0; i < SNAPSHOT_STACK_MAX - 1; i++)
-            stack->snapshots[i] = stack->snapshots[i + 1];
-        stack->top = SNAPSHOT_STACK_MAX - 1;
+        Anm2Animation decoded = a;
+        anm2_animation_materialize(&decoded);
+        return _snapshot_children_is_same(decoded, b);
     }
-    stack->snapshots[stack->top++] = *snapshot;
+
+    if (b.packed || b.source) return _snapshot_children_is_same(b, a);
+
+    return _snapshot_item_is_same(a.rootAnimation, b.rootAnimation) && _snapshot_item_is_same(a.triggers, b.triggers) &&
+        _snapshot_items_is_same(a.layerAnimations, b.layerAnimations) && _snapshot_items_is_same(a.nullAnimations, b.nullAnimations);
 }
 
-static bool _snapshot_stack_pop(SnapshotStack* stack, Snapshot* snapshot)
+// Every write to an item's frames takes a new revision (widgets dirty the item they changed), so equal revisions
+// mean equal children; name, length and looping are set by widgets directly, so they're compared too. A revision
+// can move while the children end up as they were (a drag returned to its start), so differing ones fall back to
+// the children; when those match, target takes source's revision, and the next comparison stops there
+static bool _snapshot_animation_is_equal(const Anm2Animation& source, Anm2Animation* target)
 {
-    if (stack->top == 0) return false;
+    if (source.name != target->name || source.frameNum != target->frameNum || source.isLoop != target->isLoop) return false;
+    if (source.revision == target->revision) return true;
+    if (!_snapshot_children_is_same(source, *target)) return false;
 
-    *snapshot = stack->snapshots[--stack->top];
+    target->revision = source.revision;
     return true;
 }
 
-static void _snapshot_set(Snapshots* self, const Snapshot& snapshot)
+// Ids of the animations target would have to add, remove or replace to equal source
+static std::vector<s32> _snapshot_animations_diff(const Anm2& source, Anm2* target)
 {
-    *self->anm2 = snapshot.anm2;
-    *self->reference = snapshot.reference;
-    self->preview->time = snapshot.time;
-    self->action = snapshot.action;
+    std::vector<s32> ids;
+
+    // Both are in id order, so one merged pass finds every added, removed or changed animation
+    auto sourceIt = source.animations.begin();
+    auto targetIt = target->animations.begin();
+
+    while (sourceIt != source.animations.end() || targetIt != target->animations.end())
+    {
+        if (targetIt == target->animations.end() || (sourceIt != source.animations.end() && sourceIt->first < targetIt->first))
+            ids.push_back((sourceIt++)->first);
+        else if (sourceIt == source.animations.end() || targetIt->first < sourceIt->first)
+            ids.push_back((targetIt++)->first);
+        else
+        {
+            if (!_snapshot_animation_is_equal(sourceIt->second, &targetIt->second))
+                ids.push_back(sourceIt->first);
+            sourceIt++;
+            targetIt++;
+        }
+    }
+
+    return ids;
+}
+
+static bool _snapshot_is_equal(const Anm2& source, Anm2* target)
+{
+    return _snapshot_header_is_equal(source, *target) && _snapshot_animations_diff(source, target).empty();
+}
+
+// Makes target equal to source, returning the parts of target it replaced; applying that puts target back
+static SnapshotDelta _snapshot_delta_sync(const Anm2& source, Anm2* target)
+{
+    SnapshotDelta delta;
+
+    if (!_snapshot_header_is_equal(source, *target))
+    {
+        delta.header.emplace();
+        _snapshot_header_swap(&*delta.header, target);
+        _snapshot_header_copy(target, source);
+    }
+
+    std::vector<s32> ids = _snapshot_animations_diff(source, target);
+
+    for (s32 id : ids)
+    {
+        auto it = target->animations.find(id);
+        auto sourceAnimation = source.animations.find(id);
+
+        if (it != target->animations.end())
+            delta.animations.push_back({id, std::move(it->second)});
+        else
+            delta.animations.push_back({id, std::nullopt});
+
+        if (sourceAnimation != source.animations.end())
+            target->animations[id] = sourceAnimation->second;
+        else
+            target->animations.erase(id);
+    }
+
+    return delta;
+}
+
+static void _snapshot_delta_apply(Anm2* target, SnapshotDelta* delta)
+{
+    if (delta->header)
+        _snapshot_header_swap(target, &*delta->header);
+
+    for (auto& [id, animation] : delta->animations)
+    {
+        if (animation)
+            target->animations[id] = std::move(*animation);
+        else
+            target->animations.erase(id);
+    }
+}
+
+// Packs the animations a delta holds, and their counterparts now in base
+static void _snapshots_compact(Snapshots* self, SnapshotDelta* delta)
+{
+    if (!self->isCompact) return;
+
+    for (auto& [id, animation] : delta->animations)
+    {
+        if (animation) anm2_animation_compact(&*animation);
+        if (Anm2Animation* baseAnimation = map_find(self->base.animations, id))
+            anm2_animation_compact(baseAnimation);
+    }
+}
+
+// Visits every frame buffer a delta's animations hold, always in the same order: each animation's packed buffer
+// (as a null item), then its root, layer, null and trigger items
+template <typename Function>
+static void _snapshot_delta_buffers_each(SnapshotDelta* delta, Function function)
+{
+    for (auto& [id, animation] : delta->animations)
+    {
+        if (!animation) continue;
+
+        function(id, &*animation, ANM2_NONE, ID_NONE, nullptr);
+        function(id, &*animation, ANM2_ROOT, ID_NONE, &animation->rootAnimation);
+
+        for (auto& [itemID, item] : animation->layerAnimations)
+            function(id, &*animation, ANM2_LAYER, itemID, &item);
+        for (auto& [itemID, item] : animation->nullAnimations)
+            function(id, &*animation, ANM2_NULL, itemID, &item);
+
+        function(id, &*animation, ANM2_TRIGGERS, ID_NONE, &animation->triggers);
+    }
 }
 
-void snapshots_init(Snapshots* self, Anm2* anm2, Anm2Reference* reference, Preview* preview)
+static Anm2Item* _snapshot_item_get(Anm2Animation* animation, Anm2Type type, s32 itemID)
+{
+    switch (type)
+    {
+        case ANM2_ROOT: return &animation->rootAnimation;
+        case ANM2_LAYER: return map_find(animation->layerAnimations, itemID);
+        case ANM2_NULL: return map_find(animation->nullAnimations, itemID);
+        case ANM2_TRIGGERS: return &animation->triggers;
+        default: return nullptr;
+    }
+}
+
+// The state above a buried entry is the one base holds, with the entry on top of it applied
+static Anm2Animation* _snapshots_animation_above_get(Snapshots* self, Snapshot* above, s32 id)
+{
+    for (auto& [animationID, animation] : above->delta.animations)
+        if (animationID == id) return animation ? &*animation : nullptr;
+
+    return map_find(self->base.animations, id);
+}
+
+static void _snapshots_bury(Snapshots* self, Snapshot* snapshot, Snapshot* above)
+{
+    Anm2Animation* aboveAnimation = nullptr;
+
+    if (snapshot->isBuried) return;
+
+    _snapshot_delta_buffers_each(&snapshot->delta, [&](s32 animationID, Anm2Animation* animation, Anm2Type type, s32 itemID, Anm2Item* item)
+    {
+        if (!item)
+        {
+            aboveAnimation = _snapshots_animation_above_get(self, above, animationID);
+            snapshot->frameCounts.push_back(0);
+            if (animation->packed) snapshot->bytes += animation->packed->size();
+            return;
+        }
+
+        Anm2Item* aboveItem = aboveAnimation ? _snapshot_item_get(aboveAnimation, type, itemID) : nullptr;
+
+        if (item->frames.id_get() && aboveItem && aboveItem->frames.id_get() == item->frames.id_get())
+        {
+            item->frames.clear();
+            snapshot->frameCounts.push_back(SNAPSHOT_FRAMES_INHERITED);
+        }
+        else
+        {
+            snapshot->frameCounts.push_back(0);
+            snapshot->bytes += item->frames.size() * sizeof(Anm2Frame);
+        }
+    });
+
+    snapshot->isBuried = true;
+    self->undoStack.memoryBytes += snapshot->bytes;
+}
+
+// Moves a buried entry's frames (and packed buffers) into one compressed payload; tracks are dropped with them
+static void _snapshot_compress(Snapshot* snapshot)
+{
+    std::vector<u8> data;
+    size_t index = 0;
+
+    data.reserve(snapshot->bytes);
+
+    _snapshot_delta_buffers_each(&snapshot->delta, [&](s32, Anm2Animation* animation, Anm2Type, s32, Anm2Item* item)
+    {
+        s32& count = snapshot->frameCounts[index++];
+
+        if (count == SNAPSHOT_FRAMES_INHERITED) return;
+
+        if (!item)
+        {
+            if (!animation->packed) return;
+            count = (s32)animation->packed->size();
+            data.insert(data.end(), animation->packed->begin(), animation->packed->end());
+            animation->packed.reset();
+            return;
+        }
+
+        const u8* frames = (const u8*)item->frames.read().data();
+
+        count = (s32)item->frames.size();
+        data.insert(data.end(), frames, frames + count * sizeof(Anm2Frame));
+        item->frames.clear();
+        item->track.reset();
+        item->triggerTrack.reset();
+    });
+
+    if (data.empty()) return;
+
+    s32 size = 0;
+    u8* compressed = stbi_zlib_compress(data.data(), (s32)data.size(), &size, SNAPSHOT_COMPRESS_QUALITY);
+
+    snapshot->payload.assign(compressed, compressed + size);
+    snapshot->payloadSize = size;
+    free(compressed);
+}
+
+// Puts a buried entry's frames back: its own from the payload, inherited ones from base, which holds the state above it
+static bool _snapshots_restore(Snapshots* self, Snapshot* snapshot)
+{
+    u8* data = nullptr;
+    s32 size = 0;
+    s64 offset = 0;
+    size_t index = 0;
+    Anm2Animation* baseAnimation = nullptr;
+
+    if (snapshot->payloadSize > 0)
+    {
+        data = (u8*)stbi_zlib_decode_malloc_guesssize((const char*)snapshot->payload.data(), snapshot->payloadSize, (s32)snapshot->bytes, &size);
+        if (!data) return false;
+    }
+
+    _snapshot_delta_buffers_each(&snapshot->delta, [&](s32 animationID, Anm2Animation* animation, Anm2Type type, s32 itemID, Anm2Item* item)
+    {
+        s32 count = snapshot->frameCounts[index++];
+
+        if (!item)
+        {
+            baseAnimation = map_find(self->base.animations, animationID);
+
+            if (count > 0)
+            {
+                animation->packed = std::make_shared<const std::vector<u8>>(data + offset, data + offset + count);
+                offset += count;
+            }
+            return;
+        }
+
+        if (count == SNAPSHOT_FRAMES_INHERITED)
+        {
+            if (!baseAnimation) return;
+
+            anm2_animation_materialize(baseAnimation);
+
+            if (Anm2Item* baseItem = _snapshot_item_get(baseAnimation, type, itemID))
+                item->frames = baseItem->frames;
+        }
+        else if (count > 0)
+        {
+            std::vector<Anm2Frame>& frames = item->frames.write();
+
+            frames.resize(count);
+            memcpy(frames.data(), data + offset, count * sizeof(Anm2Frame));
+            offset += count * sizeof(Anm2Frame);
+        }
+    });
+
+    free(data);
+
+    snapshot->isBuried = false;
+    snapshot->frameCounts.clear();
+    snapshot->bytes = 0;
+    snapshot->payload = std::vector<u8>{};
+    snapshot->payloadSize = 0;
+    return offset == size;
+}
+
+static bool _snapshot_stack_spill_write(SnapshotStack* stack, Snapshot* snapshot)
+{
+    if (stack->spillPath.empty()) stack->spillPath = instance_path_get(SNAPSHOT_SPILL_DIRECTORY, SNAPSHOT_SPILL_EXTENSION);
+
+    std::ios::openmode mode = std::ios::binary | std::ios::in | std::ios::out;
+    std::fstream file(stack->spillPath, stack->spillSize == 0 ? mode | std::ios::trunc : mode);
+
+    if (file)
+    {
+        file.seekp(stack->spillSize);
+        file.write((const char*)snapshot->payload.data(), snapshot->payloadSize);
+    }
+
+    if (!file)
+    {
+        log_error(std::format(SNAPSHOT_SPILL_WRITE_ERROR, stack->spillPath));
+        stack->isSpillFailed = true;
+        return false;
+    }
+
+    snapshot->payloadOffset = stack->spillSize;
+    snapshot->payload = std::vector<u8>{};
+    stack->spillSize += snapshot->payloadSize;
+    return true;
+}
+
+static bool _snapshot_stack_spill_read(SnapshotStack* stack, Snapshot* snapshot)
+{
+    std::ifstream file(stack->spillPath, std::ios::binary);
+
+    snapshot->payload.resize(snapshot->payloadSize);
+
+    if (file)
+    {
+        file.seekg(snapshot->payloadOffset);
+        file.read((char*)snapshot->payload.data(), snapshot->payloadSize);
+    }
+
+    return (bool)file;
+}
+
+// Compresses the oldest entries still in memory until they fit the budget, then spills the oldest compressed ones
+// likewise; the top entry is never buried, so undoing the latest edit never waits on either
+static void _snapshots_budget_apply(Snapshots* self)
+{
+    SnapshotStack* stack = &self->undoStack;
+    s32 buriedCount = (s32)stack->snapshots.size() - 1;
+
+    while (stack->memoryBytes > self->memoryBudget && stack->compressedCount < buriedCount)
+    {
+        Snapshot* snapshot = &stack->snapshots[stack->compressedCount++];
+
+        _snapshot_compress(snapshot);
+        stack->memoryBytes -= snapshot->bytes;
+        stack->compressedBytes += snapshot->payloadSize;
+    }
+
+    while (stack->compressedBytes > self->compressedBudget && stack->spilledCount < stack->compressedCount && !stack->isSpillFailed)
+    {
+        Snapshot* snapshot = &stack->snapshots[stack->spilledCount];
+
+        if (!_snapshot_stack_spill_write(stack, snapshot)) break;
+
+        stack->spilledCount++;
+        stack->compressedBytes -= snapshot->payloadSize;
+    }
+}
+
+// The bottom entry's delta would lead past the oldest state, so it's always left empty
+static void _snapshots_undo_stack_push(Snapshots* self, Snapshot&& snapshot)
+{
+    SnapshotStack* stack = &self->undoStack;
+
+    if (stack->is_empty())
+        snapshot.delta = SnapshotDelta{};
+    else
+        _snapshots_bury(self, &stack->snapshots.back(), &snapshot);
+
+    stack->snapshots.push_back(std::move(snapshot));
+    _snapshots_budget_apply(self);
+}
+
+// An entry that can't be brought back leaves the ones under it unreachable, so the history ends there
+static bool _snapshots_undo_stack_pop(Snapshots* self, Snapshot* snapshot)
+{
+    SnapshotStack* stack = &self->undoStack;
+    s32 index = (s32)stack->snapshots.size() - 1;
+    bool isRestored = true;
+
+    if (!_snapshot_stack_pop(stack, snapshot)) return false;
+
+    if (index < stack->spilledCount)
+    {
+        if (!_snapshot_stack_spill_read(stack, snapshot))
+        {
+            log_error(std::format(SNAPSHOT_SPILL_READ_ERROR, stack->spillPath));
+            isRestored = false;
+        }
+
+        stack->spilledCount = index;
+        stack->spillSize = snapshot->payloadOffset;
+    }
+    else if (index < stack->compressedCount)
+        stack->compressedBytes -= snapshot->payloadSize;
+    else if (snapshot->isBuried)
+        stack->memoryBytes -= snapshot->bytes;
+
+    stack->compressedCount = std::min(stack->compressedCount, index);
+
+    if (snapshot->isBuried && isRestored) isRestored = _snapshots_restore(self, snapshot);
+
+    if (!isRestored) snapshot_stack_free(stack);
+
+    return isRestored;
+}
+
+void snapshots_init(Snapshots* self, Anm2* anm2, Anm2Reference* reference, f32* time)
 {
     self->anm2 = anm2;
     self->reference = reference;
-    self->preview = preview;
+    self->time = time;
 }
 
+// base starts as a copy of the document, so the first push only records what the edit touched
 void snapshots_reset(Snapshots* self)
 {
-    self->undoStack = SnapshotStack{};
-    self->redoStack = SnapshotStack{};
+    snapshot_stack_free(&self->undoStack);
+    snapshot_stack_free(&self->redoStack);
+    self->transaction = SnapshotTransaction{};
     self->action.clear();
+    self->isChanged = false;
+    self->base = *self->anm2;
+    journal_reset(&self->journal, *self->anm2);
 }
 
-void snapshots_undo_push(Snapshots* self, const Snapshot* snapshot)
+void snapshots_free(Snapshots* self)
 {
-    _snapshot_stack_push(&self->undoStack, snapshot);
-    self->redoStack.top = 0;
+    snapshot_stack_free(&self->undoStack);
+    snapshot_stack_free(&self->redoStack);
+    journal_free(&self->journal);
 }
 
-void snapshots_undo(Snapshots* self)
+// Also removes its spill file; stacks of documents that get closed have to go through here
+void snapshot_stack_free(SnapshotStack* self)
+{
+    std::error_code errorCode;
+
+    if (!self->spillPath.empty())
+        std::filesystem::remove(self->spillPath, errorCode);
+
+    *self = SnapshotStack{};
+}
+
+// Takes the top undo entry back off, with base returning to the state under it; the document is left as it is
+static void _snapshots_checkpoint_drop(Snapshots* self)
 {
     Snapshot snapshot;
-    if (_snapshot_stack_pop(&self->undoStack, &snapshot))
+
+    if (!_snapshots_undo_stack_pop(self, &snapshot)) return;
+
+    _snapshot_delta_apply(&self->base, &snapshot.delta);
+}
+
+// Gives a copy of the document the referenced item's frames to itself. A packed animation shares no frames, so it's
+// left packed
+static void _snapshots_reference_detach(Snapshots* self, Anm2* anm2)
+{
+    Anm2Animation* animation = map_find(anm2->animations, self->reference->animationID);
+
+    if (animation && !animation->packed && !animation->source)
+        if (Anm2Item* item = anm2_item_from_reference(anm2, self->reference))
+            item->frames.write();
+}
+
+// Begins a transaction: base takes the document's current state, as the checkpoint undoing it returns to.
+// A push like the last one (same action and reference, soon enough after it) joins it instead, checkpoint and all
+void snapshots_undo_push(Snapshots* self, const std::string& action)
+{
+    SnapshotTransaction* transaction = &self->transaction;
+    auto now = std::chrono::steady_clock::now();
+
+    if (transaction->isCoalescable && transaction->action == action && transaction->reference == *self->reference &&
+        std::chrono::duration<f64>(now - transaction->time).count() < SNAPSHOT_COALESCE_TIME)
     {
-        Snapshot current = {*self->anm2, *self->reference, self->preview->time, self->action};
-        _snapshot_stack_push(&self->redoStack, &current);
-        _snapshot_set(self, snapshot);
+        transaction->isOpen = true;
+        transaction->time = now;
+        _snapshots_reference_detach(self, &self->journal.state); // shares the document's frames since the last commit
+        return;
     }
+
+    snapshots_undo_commit(self);
+
+    Snapshot snapshot = {_snapshot_delta_sync(*self->anm2, &self->base), *self->reference, *self->time, action};
+
+    _snapshots_compact(self, &snapshot.delta);
+    _snapshots_undo_stack_push(self, std::move(snapshot));
+
+    // Widgets write the referenced item's frames through pointers taken before the push; base and the journal's
+    // state take their own copies of that one, so those writes stay the document's
+    _snapshots_reference_detach(self, &self->base);
+    _snapshots_reference_detach(self, &self->journal.state);
+
+    *transaction = {true, true, action, *self->reference, now};
+}
+
+// A commit, undo or redo changed the document: it's marked unsaved, and what changed since the journal last saw it
+// is appended there; with journaling off, the journal is removed instead
+static void _snapshots_changed(Snapshots* self)
+{
+    self->isChanged = true;
+
+    if (!self->isJournal)
+    {
+        if (!self->journal.path.empty()) journal_reset(&self->journal, *self->anm2);
+        return;
+    }
+
+    SnapshotDelta delta = _snapshot_delta_sync(*self->anm2, &self->journal.state);
+
+    if (delta.header || !delta.animations.empty())
+        journal_edit_append(&self->journal, delta.header.has_value(), delta.animations);
+}
+
+// The redo stack outlives a transaction's push, and is only cleared once it turns out to have changed something
+void snapshots_undo_commit(Snapshots* self)
+{
+    SnapshotTransaction* transaction = &self->transaction;
+
+    if (!transaction->isOpen) return;
+
+    transaction->isOpen = false;
+    transaction->time = std::chrono::steady_clock::now();
+
+    if (!self->undoStack.is_empty() && self->undoStack.snapshots.back().time == *self->time &&
+        _snapshot_is_equal(*self->anm2, &self->base))
+    {
+        _snapshots_checkpoint_drop(self);
+        transaction->isCoalescable = false;
+    }
+    else
+    {
+        snapshot_stack_free(&self->redoStack);
+        _snapshots_changed(self);
+    }
+}
+
+// Puts the document, reference and playhead back to the open transaction's checkpoint, and drops it
+void snapshots_undo_discard(Snapshots* self)
+{
+    if (!self->transaction.isOpen || self->undoStack.is_empty()) return;
+
+    Snapshot* snapshot = &self->undoStack.snapshots.back();
+
+    _snapshot_delta_sync(self->base, self->anm2);
+    *self->reference = snapshot->reference;
+    *self->time = snapshot->time;
+
+    _snapshots_checkpoint_drop(self);
+    self->transaction = SnapshotTransaction{};
+}
+
+void snapshots_undo(Snapshots* self)
+{
+    Snapshot snapshot;
+
+    snapshots_undo_commit(self);
+    self->transaction = SnapshotTransaction{};
+
+    if (!_snapshots_undo_stack_pop(self, &snapshot)) return;
+
+    // The document takes base's state, and what it had goes to the redo stack
+    Snapshot current = {_snapshot_delta_sync(self->base, self->anm2), *self->reference, *self->time, self->action};
+    _snapshots_compact(self, &current.delta);
+    self->redoStack.snapshots.push_back(std::move(current));
+
+    _snapshot_delta_apply(&self->base, &snapshot.delta);
+
+    *self->reference = snapshot.reference;
+    *self->time = snapshot.time;
+    self->action = snapshot.action;
+
+    _snapshots_changed(self);
 }
 
 void snapshots_redo(Snapshots* self)
 {
     Snapshot snapshot;
-    if (_snapshot_stack_pop(&self->redoStack, &snapshot))
+
+    snapshots_undo_commit(self);
+    self->transaction = SnapshotTransaction{};
+
+    if (!_snapshot_stack_pop(&self->redoStack, &snapshot)) return;
+
+    Snapshot current = {_snapshot_delta_sync(*self->anm2, &self->base), *self->reference, *self->time, self->action};
+    _snapshots_compact(self, &current.delta);
+    _snapshots_undo_stack_push(self, std::move(current));
+
+    _snapshot_delta_apply(self->anm2, &snapshot.delta);
+
+    *self->reference = snapshot.reference;
+    *self->time = snapshot.time;
+    self->action = snapshot.action;
+
+    _snapshots_changed(self);
+}
+
+// Counts each frame or packed buffer an animation refers to, by address
+static void _snapshots_memory_animation_add(std::unordered_map<const void*, std::pair<s64, s32>>& buffers, const Anm2Animation& animation)
+{
+    auto buffer_add = [&](const void* id, s64 bytes)
+    {
+        if (!id) return;
+        auto& [size, count] = buffers[id];
+        size = bytes;
+        count++;
+    };
+
+    auto item_add = [&](const Anm2Item& item) { buffer_add(item.frames.id_get(), item.frames.size() * sizeof(Anm2Frame)); };
+
+    if (animation.packed) buffer_add(animation.packed.get(), animation.packed->size());
+
+    item_add(animation.rootAnimation);
+    item_add(animation.triggers);
+
+    for (auto& [_, item] : animation.layerAnimations)
+        item_add(item);
+    for (auto& [_, item] : animation.nullAnimations)
+        item_add(item);
+}
+
+// Spill files are only read back by the history that wrote them, so any whose instance is gone are left over from a
+// crash; meant for startup. Those of instances still running are theirs
+void snapshots_spills_clear(void)
+{
+    std::error_code errorCode;
+
+    for (auto& entry : std::filesystem::directory_iterator(preferences_path_get() + SNAPSHOT_SPILL_DIRECTORY, errorCode))
+        if (entry.path().extension() == SNAPSHOT_SPILL_EXTENSION && !instance_path_is_live(entry.path().string()))
+            std::filesystem::remove(entry.path(), errorCode);
+}
+
+SnapshotsMemory snapshots_memory_get(Snapshots* self)
+{
+    std::unordered_map<const void*, std::pair<s64, s32>> buffers;
+    SnapshotsMemory memory;
+
+    auto stack_add = [&](SnapshotStack* stack)
+    {
+        for (auto& snapshot : stack->snapshots)
+            for (auto& [_, animation] : snapshot.delta.animations)
+                if (animation) _snapshots_memory_animation_add(buffers, *animation);
+    };
+
+    for (auto& [_, animation] : self->anm2->animations)
+        _snapshots_memory_animation_add(buffers, animation);
+    for (auto& [_, animation] : self->base.animations)
+        _snapshots_memory_animation_add(buffers, animation);
+
+    stack_add(&self->undoStack);
+    stack_add(&self->redoStack);
+
+    for (auto& [_, buffer] : buffers)
     {
-        Snapshot current = {*self->anm2, *self->reference, self->preview->time, self->action};
-        _snapshot_stack_push(&self->undoStack, &current);
-        _snapshot_set(self, snapshot);
+        auto& [size, count] = buffer;
+
+        if (count > 1)
+            memory.sharedBytes += size;
+        else
+            memory.uniqueBytes += size;
+
+        memory.copiedBytes += size * count;
     }
-}
\ No newline at end of file
+
+    memory.compressedBytes = self->undoStack.compressedBytes;
+    memory.spilledBytes = self->undoStack.spillSize;
+
+    return memory;
+}
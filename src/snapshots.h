@@ -1,40 +1,108 @@
 #pragma once
 
 #include "anm2.h"
-#include "preview.h"
-#include "texture.h"
+#include "journal.h"
 
-#define SNAPSHOT_STACK_MAX 1000
 #define SNAPSHOT_ACTION "Action"
+#define SNAPSHOT_MEMORY_BUDGET_DEFAULT (256ll << 20)
+#define SNAPSHOT_COMPRESSED_BUDGET_DEFAULT (256ll << 20)
+#define SNAPSHOT_COMPRESS_QUALITY 5 // stb's zlib level; lower is faster
+#define SNAPSHOT_SPILL_DIRECTORY "history"
+#define SNAPSHOT_SPILL_EXTENSION ".bin"
+#define SNAPSHOT_FRAMES_INHERITED -1
+#define SNAPSHOT_COALESCE_TIME 1.0 // seconds; pushes of one action on one reference closer together than this share an entry
+#define SNAPSHOT_SPILL_WRITE_ERROR "Unable to write undo history to {}; older entries stay in memory"
+#define SNAPSHOT_SPILL_READ_ERROR "Unable to read undo history from {}; older entries were dropped"
 
+// The parts of a document that differ from another state of it; applied over that state, it gives this one.
+// Animations are compared by revision (plus the few fields widgets set directly), so finding them costs
+// a pass over the animation list rather than their frames
+struct SnapshotDelta
+{
+    std::optional<Anm2> header{}; // everything but the animations, when any of it differs
+    std::vector<std::pair<s32, std::optional<Anm2Animation>>> animations; // by id; nullopt where it doesn't exist
+};
+
+// An undo entry is buried once another lands on it; from then on, items the state above it shares are dropped
+// (SNAPSHOT_FRAMES_INHERITED) and taken back from base when it's popped, so what's left is what it alone holds
 struct Snapshot
 {
-    Anm2 anm2;
+    SnapshotDelta delta;
     Anm2Reference reference;
     f32 time = 0.0f;
     std::string action = SNAPSHOT_ACTION;
+    bool isBuried = false;
+    std::vector<s32> frameCounts{}; // once buried, per frame buffer of the delta: frames (or packed bytes) in the payload
+    s64 bytes{}; // frame bytes it holds, once buried
+    std::vector<u8> payload{}; // the frames, zlib compressed, while compressed
+    s32 payloadSize{};
+    s64 payloadOffset{}; // in the stack's spill file, while spilled
 };
 
+// Oldest entries first: those in the spill file, then the compressed ones, then the ones in memory
 struct SnapshotStack
 {
-    Snapshot snapshots[SNAPSHOT_STACK_MAX];
-    s32 top = 0;
+    std::vector<Snapshot> snapshots;
+    s32 spilledCount{};
+    s32 compressedCount{}; // including the spilled ones
+    s64 memoryBytes{}; // of the buried entries still in memory
+    s64 compressedBytes{}; // of the compressed entries' payloads
+    std::string spillPath{}; // chosen on the first spill
+    s64 spillSize{}; // in use; popped entries' space is written over by the next spill
+    bool isSpillFailed = false; // once set, the rest stay compressed in memory
 
-    bool is_empty() const { return top == 0; }
+    bool is_empty() const { return snapshots.empty(); }
 };
 
+// An undo push begins one; it's committed by the next push, an undo or redo, or once input goes idle (see imgui_update).
+// One that changed neither the document nor the playhead is dropped then, as if it had never been pushed
+struct SnapshotTransaction
+{
+    bool isOpen = false; // the top undo entry is its checkpoint, and what's changed since hasn't been checked
+    bool isCoalescable = false; // the top undo entry is still its checkpoint, so a like push can join it
+    std::string action{};
+    Anm2Reference reference{};
+    std::chrono::steady_clock::time_point time{}; // of its last push or commit
+};
+
+// Undo entries hold deltas from the state above them, down from base, a full copy of the state the top one restores.
+// Redo entries hold deltas over the state their undo left behind
 struct Snapshots
 {
     Anm2* anm2 = nullptr;
-    Preview* preview = nullptr;
     Anm2Reference* reference = nullptr;
+    f32* time = nullptr;
     std::string action = SNAPSHOT_ACTION;
+    bool isCompact = false; // stacked animations are packed (see anm2_animations_compact)
+    s64 memoryBudget = SNAPSHOT_MEMORY_BUDGET_DEFAULT; // undo entries past it are compressed, oldest first
+    s64 compressedBudget = SNAPSHOT_COMPRESSED_BUDGET_DEFAULT; // compressed entries past it are spilled to a file
+    bool isJournal = true; // committed edits are appended to the crash-recovery journal
+    bool isChanged = false; // since it was opened or last saved
+    Anm2 base{};
+    Journal journal;
+    SnapshotTransaction transaction;
     SnapshotStack undoStack;
     SnapshotStack redoStack;
 };
 
-void snapshots_undo_push(Snapshots* self, const Snapshot* snapshot);
-void snapshots_init(Snapshots* self, Anm2* anm2, Anm2Reference* reference, Preview* preview);
+// Frame data the document and its history hold between them; a buffer reachable from several places is counted once
+struct SnapshotsMemory
+{
+    s64 sharedBytes{}; // in buffers more than one place refers to
+    s64 uniqueBytes{}; // in buffers only one place refers to
+    s64 copiedBytes{}; // what it'd all take with every place holding its own copy
+    s64 compressedBytes{}; // of undo entries moved out of memory
+    s64 spilledBytes{};
+};
+
+void snapshots_undo_push(Snapshots* self, const std::string& action = SNAPSHOT_ACTION);
+void snapshots_undo_commit(Snapshots* self);
+void snapshots_undo_discard(Snapshots* self);
+void snapshots_init(Snapshots* self, Anm2* anm2, Anm2Reference* reference, f32* time);
 void snapshots_undo(Snapshots* self);
 void snapshots_redo(Snapshots* self);
-void snapshots_reset(Snapshots* self);
\ No newline at end of file
+void snapshots_reset(Snapshots* self);
+void snapshots_free(Snapshots* self);
+void snapshot_stack_free(SnapshotStack* self);
+void snapshots_spills_clear(void);
+SnapshotsMemory snapshots_memory_get(Snapshots* self);
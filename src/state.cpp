@@ -8,6 +8,8 @@ static void _tick(State* self)
 static void _update(State* self)
 {
 	SDL_GetWindowSize(self->window, &self->settings.windowSize.x, &self->settings.windowSize.y);
+
+	resources_textures_update(&self->resources);
 	
 	imgui_update(&self->imgui);
 
@@ -102,10 +104,12 @@ void init(State* self)
 	resources_init(&self->resources);
 	dialog_init(&self->dialog, self->window);
 	clipboard_init(&self->clipboard, &self->anm2);
-	snapshots_init(&self->snapshots, &self->anm2, &self->reference, &self->preview);
+	snapshots_init(&self->snapshots, &self->anm2, &self->reference, &self->preview.time);
 	preview_init(&self->preview, &self->anm2, &self->reference, &self->resources, &self->settings);
 	generate_preview_init(&self->generatePreview, &self->anm2, &self->reference, &self->resources, &self->settings);
 	editor_init(&self->editor, &self->anm2, &self->reference, &self->resources, &self->settings);
+	documents_init(&self->documents, &self->anm2, &self->reference, &self->snapshots, &self->resources, &self->preview, &self->editor);
+	saves_init(&self->saves);
 	
 	imgui_init
 	(
@@ -119,6 +123,8 @@ void init(State* self)
 		&self->generatePreview,
 		&self->settings,
 		&self->snapshots,
+		&self->documents,
+		&self->saves,
 		&self->clipboard,
 		self->window,
 		&self->glContext
@@ -126,11 +132,18 @@ void init(State* self)
 
 	if (!self->argument.empty())
 	{
-		anm2_deserialize(&self->anm2, &self->resources, self->argument);
+		if (anm2_deserialize(&self->anm2, &self->resources, self->argument, settings_anm2_read_type_get(&self->settings)) && self->settings.fileIsCompact)
+			anm2_animations_compact(&self->anm2);
 		window_title_from_path_set(self->window, self->argument);
 	}
 	else
 		anm2_new(&self->anm2);
+
+	// Journals and spilled history only outlive their documents when the program didn't get to close them
+	self->snapshots.isJournal = self->settings.historyIsJournal;
+	documents_recover(&self->documents);
+	snapshots_spills_clear();
+	window_title_from_path_set(self->window, self->anm2.path);
 }
 
 void loop(State* self)
@@ -176,11 +189,14 @@ void loop(State* self)
 
 void quit(State* self)
 {
+	saves_free(&self->saves); // saves still being written are finished first
 	imgui_free();
 	generate_preview_free(&self->generatePreview);
 	preview_free(&self->preview);
 	editor_free(&self->editor);
 	resources_free(&self->resources);
+	documents_free(&self->documents);
+	snapshots_free(&self->snapshots);
 
 	/*
     Mix_CloseAudio();
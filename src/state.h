@@ -37,6 +37,8 @@ struct State
 	Resources resources;
 	Settings settings;
 	Snapshots snapshots;
+	Documents documents;
+	Saves saves;
 	Clipboard clipboard;
 	std::string argument{};
 	std::string lastAction{};
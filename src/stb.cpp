@@ -0,0 +1,21 @@
+// stb_image and stb_image_write, compiled once here; texture.cpp loads and writes PNGs with them, and the undo history
+// compresses old entries with stb_image_write's zlib encoder, so they build without OpenGL
+
+#if defined(__clang__) || defined(__GNUC__)
+  #pragma GCC diagnostic push
+  #pragma GCC diagnostic ignored "-Wmissing-field-initializers"
+  #pragma GCC diagnostic ignored "-Wunused-function"
+  #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+#define STBI_ONLY_PNG  
+#define STBI_NO_FAILURE_STRINGS   
+#define STBI_NO_HDR
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+#if defined(__clang__) || defined(__GNUC__)
+  #pragma GCC diagnostic pop
+#endif
@@ -7,12 +7,7 @@
 
 #include "texture.h"
 
-#define STBI_ONLY_PNG  
-#define STBI_NO_FAILURE_STRINGS   
-#define STBI_NO_HDR
-#define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
-#define STB_IMAGE_WRITE_IMPLEMENTATION
 #include <stb_image_write.h>
 
 static void _texture_gl_set(Texture* self, const u8* data)
@@ -38,29 +33,68 @@ std::vector<u8> texture_download(const Texture* self)
 	return pixels;
 }
 
-bool texture_from_path_init(Texture* self, const std::string& path)
+// No GL calls; safe to run on a worker thread
+bool texture_decode(TextureDecode* self)
 {
-	*self = Texture{};
-	u8* data = stbi_load(path.c_str(), &self->size.x, &self->size.y, &self->channels, TEXTURE_CHANNELS);
-	
-	if (!data)
+	std::filesystem::path filePath = self->path;
+
+	if (filePath.is_relative() && !self->basePath.empty())
+		filePath = std::filesystem::path(self->basePath) / filePath;
+
+	self->data = stbi_load(filePath.string().c_str(), &self->size.x, &self->size.y, &self->channels, TEXTURE_CHANNELS);
+
+	if (!self->data)
 	{
-		data = stbi_load(path_canonical_resolve(path).c_str(), &self->size.x, &self->size.y, &self->channels, TEXTURE_CHANNELS);
-		if (!data)
+		std::string basePath = self->basePath.empty() ? std::filesystem::current_path().string() : self->basePath;
+		self->data = stbi_load(path_canonical_resolve(self->path, basePath).c_str(), &self->size.x, &self->size.y, &self->channels, TEXTURE_CHANNELS);
+
+		if (!self->data)
 		{
-			log_error(std::format(TEXTURE_INIT_ERROR, path));
-			self->isInvalid = true;
+			log_error(std::format(TEXTURE_INIT_ERROR, self->path));
 			return false;
 		}
 	}
 
-	log_info(std::format(TEXTURE_INIT_INFO, path));
+	return true;
+}
+
+void texture_decode_free(TextureDecode* self)
+{
+	if (self->data) stbi_image_free(self->data);
+	self->data = nullptr;
+}
 
-	_texture_gl_set(self, data);
+// Uploads the decoded pixels, then frees them
+bool texture_from_decode_init(Texture* self, TextureDecode* decode)
+{
+	*self = Texture{};
+
+	if (!decode->data)
+	{
+		self->isInvalid = true;
+		return false;
+	}
+
+	self->size = decode->size;
+	self->channels = decode->channels;
+
+	log_info(std::format(TEXTURE_INIT_INFO, decode->path));
+
+	_texture_gl_set(self, decode->data);
+	texture_decode_free(decode);
 
 	return true;
 }
 
+bool texture_from_path_init(Texture* self, const std::string& path)
+{
+	TextureDecode decode = {.path = path};
+
+	texture_decode(&decode);
+
+	return texture_from_decode_init(self, &decode);
+}
+
 bool texture_from_encoded_data_init(Texture* self, ivec2 size, s32 channels, const u8* data, u32 length)
 {
 	*self = Texture{};
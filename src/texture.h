@@ -14,8 +14,23 @@ struct Texture
     ivec2 size = {0, 0};
     s32 channels = -1;
     bool isInvalid = false;
+    u64 decodeID = 0; // asynchronous decode this placeholder waits on; invalid until it's uploaded
 };
 
+// Pixels decoded off the main thread; only the upload needs the GL context
+struct TextureDecode
+{
+    u64 id = 0;
+    std::string path{};
+    std::string basePath{}; // relative paths resolve against this rather than the working directory at decode time
+    ivec2 size = {0, 0};
+    s32 channels = -1;
+    u8* data = nullptr;
+};
+
+bool texture_decode(TextureDecode* self);
+void texture_decode_free(TextureDecode* self);
+bool texture_from_decode_init(Texture* self, TextureDecode* decode);
 bool texture_from_encoded_data_init(Texture* self, ivec2 size, s32 channels, const u8* data, u32 length);
 bool texture_from_gl_write(Texture* self, const std::string& path);
 bool texture_from_path_init(Texture* self, const std::string& path);
@@ -0,0 +1,74 @@
+#include "thread_pool.h"
+
+static void _thread_pool_worker(ThreadPool* self)
+{
+	while (true)
+	{
+		std::function<void()> job;
+
+		{
+			std::unique_lock lock(self->mutex);
+			self->jobCondition.wait(lock, [self] { return self->isExit || !self->jobs.empty(); });
+
+			if (self->jobs.empty()) return;
+
+			job = std::move(self->jobs.front());
+			self->jobs.pop_front();
+			self->busyCount++;
+		}
+
+		job();
+
+		{
+			std::lock_guard lock(self->mutex);
+			self->busyCount--;
+
+			if (self->busyCount == 0 && self->jobs.empty())
+				self->idleCondition.notify_all();
+		}
+	}
+}
+
+// A count of 0 uses one thread per core
+void thread_pool_init(ThreadPool* self, s32 count)
+{
+	if (count <= 0) count = std::max(1, (s32)std::thread::hardware_concurrency());
+
+	self->isExit = false;
+
+	for (s32 i = 0; i < count; i++)
+		self->threads.emplace_back(_thread_pool_worker, self);
+}
+
+void thread_pool_submit(ThreadPool* self, std::function<void()> job)
+{
+	{
+		std::lock_guard lock(self->mutex);
+		self->jobs.push_back(std::move(job));
+	}
+
+	self->jobCondition.notify_one();
+}
+
+// Blocks until every submitted job has finished
+void thread_pool_wait(ThreadPool* self)
+{
+	std::unique_lock lock(self->mutex);
+	self->idleCondition.wait(lock, [self] { return self->busyCount == 0 && self->jobs.empty(); });
+}
+
+// Jobs still queued are run before the workers exit
+void thread_pool_free(ThreadPool* self)
+{
+	{
+		std::lock_guard lock(self->mutex);
+		self->isExit = true;
+	}
+
+	self->jobCondition.notify_all();
+
+	for (auto& thread : self->threads)
+		thread.join();
+
+	self->threads.clear();
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "COMMON.h"
+
+struct ThreadPool
+{
+    std::vector<std::thread> threads;
+    std::deque<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable jobCondition;
+    std::condition_variable idleCondition;
+    s32 busyCount = 0;
+    bool isExit = false;
+};
+
+void thread_pool_init(ThreadPool* self, s32 count = 0);
+void thread_pool_submit(ThreadPool* self, std::function<void()> job);
+void thread_pool_wait(ThreadPool* self);
+void thread_pool_free(ThreadPool* self);